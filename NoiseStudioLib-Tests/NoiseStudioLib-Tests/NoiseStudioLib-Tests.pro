@@ -2,6 +2,7 @@ TEMPLATE = app
 CONFIG += console
 CONFIG -= app_bundle
 CONFIG -= qt
+CONFIG += thread
 
 SOURCES += main.cpp \
     connection_data_type_tests.cpp \
@@ -13,7 +14,21 @@ SOURCES += main.cpp \
     math_node_tests.cpp \
     blank_grid_mapping_tests.cpp \
     perlin_noise_tests.cpp \
-    type_conversion_node_tests.cpp
+    type_conversion_node_tests.cpp \
+    domain_warp_tests.cpp \
+    expression_tests.cpp \
+    graph_executor_tests.cpp \
+    fast_math_tests.cpp \
+    reduction_tests.cpp \
+    blur_tests.cpp \
+    normal_map_tests.cpp \
+    erosion_tests.cpp \
+    sample_tests.cpp \
+    mip_chain_tests.cpp \
+    progressive_preview_tests.cpp \
+    graph_snapshot_tests.cpp \
+    batch_execution_tests.cpp \
+    result_cache_tests.cpp
 
 include(deployment.pri)
 qtcAddDeployment()
@@ -42,11 +57,3 @@ win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../../NoiseStu
 else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../../NoiseStudioLib/build/debug/libNoiseStudioLib.a
 else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$PWD/../../NoiseStudioLib/build/release/NoiseStudioLib.lib
 else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$PWD/../../NoiseStudioLib/build/debug/NoiseStudioLib.lib
-
-win32: LIBS += -L$$PWD/../../NoiseStudioLib/boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static/ -lboost_regex-mgw48-d-1_57
-
-INCLUDEPATH += $$PWD/../../NoiseStudioLib/boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static
-DEPENDPATH += $$PWD/../../NoiseStudioLib/boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static
-
-win32:!win32-g++: PRE_TARGETDEPS += $$PWD/../../NoiseStudioLib/boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static/boost_regex-mgw48-d-1_57.lib
-else:win32-g++: PRE_TARGETDEPS += $$PWD/../../NoiseStudioLib/boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static/libboost_regex-mgw48-d-1_57.a
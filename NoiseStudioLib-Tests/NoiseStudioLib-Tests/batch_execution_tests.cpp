@@ -0,0 +1,280 @@
+#include "catch.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <input_uniform_set.h>
+#include <parallel.h>
+#include <nodes/blank_grid.h>
+#include <nodes/blur.h>
+#include <nodes/constant_value.h>
+#include <nodes/math.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/mappings/unit_square_mapping.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+namespace
+{
+    std::vector<InputUniformSet> make_seeds(int count)
+    {
+        std::vector<InputUniformSet> items(count);
+        for(int i = 0; i < count; i++)
+        {
+            float seed = static_cast<float>(i) * 0.7f;
+            items[i].set_uniform<float, 1>("Seed", &seed);
+        }
+        return items;
+    }
+
+    // What each item gives when its seed is set on the graph and it's executed on its own
+    std::vector<std::vector<float>> execute_one_at_a_time(Graph& graph, int count)
+    {
+        std::vector<std::vector<float>> out;
+        for(int i = 0; i < count; i++)
+        {
+            float seed = static_cast<float>(i) * 0.7f;
+            graph.set_input_uniform<float, 1>("Seed", &seed);
+
+            GraphExecutor executor(graph);
+            out.push_back(executor.execute().get_attribute_all_vector<float>("Output"));
+        }
+
+        float seed = 0.0f;
+        graph.set_input_uniform<float, 1>("Seed", &seed);
+        return out;
+    }
+}
+
+TEST_CASE("A batch gives the same outputs as executing each item on its own", "")
+{
+    const int count = 9;
+
+    // Small enough that the items run side by side, and big enough that each one runs its chunks in parallel
+    for(int width : { 16, 256 })
+    {
+        // Output = blur(noise(p + Seed*2) + Offset), with Seed*2 worked out by a Math node that would normally be folded
+        Graph graph;
+
+        BlankGrid& grid = graph.add_node<BlankGrid>();
+        grid.set_size(width, 64);
+
+        UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+        graph.connect(grid, mapping);
+
+        GraphNode& seed = graph.add_uniform_input("Seed");
+        float seed_value = 0.0f;
+        graph.set_input_uniform<float, 1>("Seed", &seed_value);
+
+        GraphNode& offset = graph.add_uniform_input("Offset");
+        float offset_value = 0.5f;
+        graph.set_input_uniform<float, 1>("Offset", &offset_value);
+
+        ConstantValue& two = graph.add_node<ConstantValue>();
+        two.set_value_single(2.0f);
+
+        int multiply_operation = static_cast<int>(MathOperation::multiply);
+        int add_operation = static_cast<int>(MathOperation::add);
+
+        Math& double_seed = graph.add_node<Math>();
+        double_seed.property("Operation").set_value<int, 1>(&multiply_operation);
+        graph.connect(seed.output("Output"), double_seed.input("A"));
+        graph.connect(two.output("Value"), double_seed.input("B"));
+
+        Math& shift = graph.add_node<Math>();
+        shift.property("Operation").set_value<int, 1>(&add_operation);
+        graph.connect(mapping.output("Mapped"), shift.input("A"));
+        graph.connect(double_seed.output("Output"), shift.input("B"));
+
+        ConstantValue& noise_seed = graph.add_node<ConstantValue>();
+        noise_seed.set_value_single(5l);
+
+        PerlinNoise& noise = graph.add_node<PerlinNoise>();
+        graph.connect(noise_seed, noise, "Seed");
+        graph.connect(shift.output("Output"), noise.input("Points"));
+
+        Math& add_offset = graph.add_node<Math>();
+        add_offset.property("Operation").set_value<int, 1>(&add_operation);
+        graph.connect(noise.output("Output"), add_offset.input("A"));
+        graph.connect(offset.output("Output"), add_offset.input("B"));
+
+        Blur& blur = graph.add_node<Blur>();
+        blur.set_kernel(BlurKernel::custom);
+        blur.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+        graph.connect(add_offset.output("Output"), blur.input("Input"));
+
+        GraphNode& output = graph.add_attribute_output("Output");
+        graph.connect(blur.output("Output"), output.input("Input"));
+
+        std::vector<std::vector<float>> expected = execute_one_at_a_time(graph, count);
+        REQUIRE(expected[0] != expected[1]);
+
+        for(unsigned int threads : { 1u, 4u })
+        {
+            set_parallel_thread_count(threads);
+
+            GraphExecutor executor(graph);
+            std::vector<GraphOutputs> outputs = executor.execute_batch(make_seeds(count));
+
+            // Again with the buffers and cached constants left from the first batch
+            std::vector<GraphOutputs> again = executor.execute_batch(make_seeds(count));
+
+            REQUIRE(outputs.size() == static_cast<std::size_t>(count));
+            for(int i = 0; i < count; i++)
+            {
+                REQUIRE(outputs[i].get_attribute_all_vector<float>("Output") == expected[i]);
+                REQUIRE(again[i].get_attribute_all_vector<float>("Output") == expected[i]);
+            }
+        }
+
+        set_parallel_thread_count(0);
+    }
+}
+
+TEST_CASE("Inputs a batch item doesn't set keep the graph's values, which the batch leaves alone", "")
+{
+    // Output = blur(noise(p + Seed*2) + Offset), with Seed*2 worked out by a Math node that would normally be folded
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(16, 16);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    GraphNode& seed = graph.add_uniform_input("Seed");
+    float seed_value = 0.0f;
+    graph.set_input_uniform<float, 1>("Seed", &seed_value);
+
+    GraphNode& offset = graph.add_uniform_input("Offset");
+    float offset_value = 0.5f;
+    graph.set_input_uniform<float, 1>("Offset", &offset_value);
+
+    ConstantValue& two = graph.add_node<ConstantValue>();
+    two.set_value_single(2.0f);
+
+    int multiply_operation = static_cast<int>(MathOperation::multiply);
+    int add_operation = static_cast<int>(MathOperation::add);
+
+    Math& double_seed = graph.add_node<Math>();
+    double_seed.property("Operation").set_value<int, 1>(&multiply_operation);
+    graph.connect(seed.output("Output"), double_seed.input("A"));
+    graph.connect(two.output("Value"), double_seed.input("B"));
+
+    Math& shift = graph.add_node<Math>();
+    shift.property("Operation").set_value<int, 1>(&add_operation);
+    graph.connect(mapping.output("Mapped"), shift.input("A"));
+    graph.connect(double_seed.output("Output"), shift.input("B"));
+
+    ConstantValue& noise_seed = graph.add_node<ConstantValue>();
+    noise_seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(noise_seed, noise, "Seed");
+    graph.connect(shift.output("Output"), noise.input("Points"));
+
+    Math& add_offset = graph.add_node<Math>();
+    add_offset.property("Operation").set_value<int, 1>(&add_operation);
+    graph.connect(noise.output("Output"), add_offset.input("A"));
+    graph.connect(offset.output("Output"), add_offset.input("B"));
+
+    Blur& blur = graph.add_node<Blur>();
+    blur.set_kernel(BlurKernel::custom);
+    blur.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+    graph.connect(add_offset.output("Output"), blur.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(blur.output("Output"), output.input("Input"));
+
+    std::vector<float> before = graph.execute().get_attribute_all_vector<float>("Output");
+
+    std::vector<InputUniformSet> items(2);
+    items[0].set_uniform<float, 1>("Offset", &offset_value);
+    float other_seed = 1.5f;
+    items[1].set_uniform<float, 1>("Seed", &other_seed);
+
+    std::vector<GraphOutputs> outputs = graph.execute_batch(items);
+    REQUIRE(outputs[0].get_attribute_all_vector<float>("Output") == before);
+    REQUIRE(outputs[1].get_attribute_all_vector<float>("Output") != before);
+
+    REQUIRE(graph.execute().get_attribute_all_vector<float>("Output") == before);
+}
+
+TEST_CASE("Batch items have to set uniform inputs the graph has, with the graph's types", "")
+{
+    // Output = blur(noise(p + Seed*2) + Offset), with Seed*2 worked out by a Math node that would normally be folded
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(16, 16);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    GraphNode& seed = graph.add_uniform_input("Seed");
+    float seed_value = 0.0f;
+    graph.set_input_uniform<float, 1>("Seed", &seed_value);
+
+    GraphNode& offset = graph.add_uniform_input("Offset");
+    float offset_value = 0.5f;
+    graph.set_input_uniform<float, 1>("Offset", &offset_value);
+
+    ConstantValue& two = graph.add_node<ConstantValue>();
+    two.set_value_single(2.0f);
+
+    int multiply_operation = static_cast<int>(MathOperation::multiply);
+    int add_operation = static_cast<int>(MathOperation::add);
+
+    Math& double_seed = graph.add_node<Math>();
+    double_seed.property("Operation").set_value<int, 1>(&multiply_operation);
+    graph.connect(seed.output("Output"), double_seed.input("A"));
+    graph.connect(two.output("Value"), double_seed.input("B"));
+
+    Math& shift = graph.add_node<Math>();
+    shift.property("Operation").set_value<int, 1>(&add_operation);
+    graph.connect(mapping.output("Mapped"), shift.input("A"));
+    graph.connect(double_seed.output("Output"), shift.input("B"));
+
+    ConstantValue& noise_seed = graph.add_node<ConstantValue>();
+    noise_seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(noise_seed, noise, "Seed");
+    graph.connect(shift.output("Output"), noise.input("Points"));
+
+    Math& add_offset = graph.add_node<Math>();
+    add_offset.property("Operation").set_value<int, 1>(&add_operation);
+    graph.connect(noise.output("Output"), add_offset.input("A"));
+    graph.connect(offset.output("Output"), add_offset.input("B"));
+
+    Blur& blur = graph.add_node<Blur>();
+    blur.set_kernel(BlurKernel::custom);
+    blur.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+    graph.connect(add_offset.output("Output"), blur.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(blur.output("Output"), output.input("Input"));
+
+    std::vector<InputUniformSet> items(1);
+
+    SECTION("Unknown input")
+    {
+        float value = 1.0f;
+        items[0].set_uniform<float, 1>("Scale", &value);
+        REQUIRE_THROWS_AS(graph.execute_batch(items), const std::invalid_argument&);
+    }
+
+    SECTION("Different type")
+    {
+        double value = 1.0;
+        items[0].set_uniform<double, 1>("Seed", &value);
+        REQUIRE_THROWS_AS(graph.execute_batch(items), const std::invalid_argument&);
+    }
+
+    REQUIRE(graph.execute_batch(std::vector<InputUniformSet>()).empty());
+}
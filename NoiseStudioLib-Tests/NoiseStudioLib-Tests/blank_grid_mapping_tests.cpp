@@ -2,9 +2,17 @@
 
 #include <graph.h>
 #include <nodes/mappings/pixel_mapping.h>
+#include <nodes/mappings/unit_square_mapping.h>
+#include <nodes/mappings/voxel_mapping.h>
+#include <nodes/mappings/unit_cube_mapping.h>
 #include <nodes/blank_grid.h>
 #include <nodes/constant_value.h>
+#include <nodes/expression.h>
 #include <graph_outputs.h>
+#include <graph_executor.h>
+#include <parallel.h>
+#include <data_buffer.h>
+#include <composite_data_buffer.h>
 
 using namespace noises;
 using namespace noises::nodes;
@@ -58,3 +66,185 @@ TEST_CASE("Can make pixel mapping", "")
         }
     }
 }
+
+TEST_CASE("A blank grid's dimensions go along with the attributes made from it", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(7, 3);
+
+    PixelMapping& mapping = graph.add_node<PixelMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    GraphNode& output_node = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output_node.input("Input"));
+
+    GraphOutputs outputs = graph.execute();
+    GridInfo grid_info = outputs.attribute_info("Output").grid();
+
+    REQUIRE(grid_info.rank() == 2);
+    REQUIRE(grid_info.extent(0) == 7);
+    REQUIRE(grid_info.extent(1) == 3);
+    REQUIRE(grid_info.origin() == 0);
+    REQUIRE(grid_info.covers(21));
+}
+
+TEST_CASE("Unit square mapping goes from -1 at the first pixel towards 1", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(6, 5);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    GraphNode& output_node = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output_node.input("Input"));
+
+    std::vector<float> output_data = graph.execute().get_attribute_all_vector<float>("Output");
+    REQUIRE(output_data.size() == 6 * 5 * 2);
+
+    for(int y = 0; y < 5; y++)
+    {
+        for(int x = 0; x < 6; x++)
+        {
+            int index = (y * 6 + x) * 2;
+
+            REQUIRE(output_data.at(index) == (static_cast<float>(x) / 6.0f) * 2 - 1);
+            REQUIRE(output_data.at(index + 1) == (static_cast<float>(y) / 5.0f) * 2 - 1);
+        }
+    }
+}
+
+TEST_CASE("Mappings work out the position of a range that starts part way through a row", "")
+{
+    PixelMapping mapping;
+
+    CompositeDataBuffer input;
+    DataBuffer output(AttributeInfo(12, "", GridInfo({ 5, 4 }, 6)));
+    output.add(mapping.outputs());
+
+    mapping.execute_uniforms(input, output);
+    mapping.execute_attribute_range(input, output, 2, 12);
+    mapping.execute_attributes(input, output, 0);
+
+    const int* mapped = reinterpret_cast<const int*>(output.get_attribute_all_raw(mapping.output("Mapped"), ConnectionDataType::value<int, 2>()));
+
+    // The buffer holds elements 6 to 17 of the 5x4 grid, element 1 is never written
+    REQUIRE(mapped[0] == 1);
+    REQUIRE(mapped[1] == 1);
+    for(int i = 2; i < 12; i++)
+    {
+        REQUIRE(mapped[i * 2] == (6 + i) % 5);
+        REQUIRE(mapped[i * 2 + 1] == (6 + i) / 5);
+    }
+}
+
+TEST_CASE("Mappings need a grid", "")
+{
+    Graph graph;
+
+    GraphNode& points = graph.add_attribute_input("Points");
+    std::vector<float> values { 1.0f, 2.0f, 3.0f };
+    graph.set_input_attribute<float, 1>("Points", values.data(), values.size());
+
+    PixelMapping& mapping = graph.add_node<PixelMapping>();
+    graph.connect(points.output("Output"), mapping.input("Grid"));
+
+    GraphNode& output_node = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output_node.input("Input"));
+
+    REQUIRE_THROWS_AS(graph.execute(), const std::logic_error&);
+}
+
+TEST_CASE("Can make a voxel mapping of a 3D grid", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(4, 3, 5);
+
+    VoxelMapping& mapping = graph.add_node<VoxelMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    GraphNode& output_node = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output_node.input("Input"));
+
+    GraphOutputs outputs = graph.execute();
+
+    GridInfo grid_info = outputs.attribute_info("Output").grid();
+    REQUIRE(grid_info.rank() == 3);
+    REQUIRE(grid_info.extent(2) == 5);
+
+    std::vector<int> output_data = outputs.get_attribute_all_vector<int>("Output");
+    REQUIRE(output_data.size() == 4 * 3 * 5 * 3);
+
+    for(int z = 0; z < 5; z++)
+    {
+        for(int y = 0; y < 3; y++)
+        {
+            for(int x = 0; x < 4; x++)
+            {
+                int index = ((z * 3 + y) * 4 + x) * 3;
+
+                REQUIRE(output_data.at(index) == x);
+                REQUIRE(output_data.at(index + 1) == y);
+                REQUIRE(output_data.at(index + 2) == z);
+            }
+        }
+    }
+}
+
+TEST_CASE("Volumes are mapped a slab at a time when fused, whatever the thread count", "")
+{
+    // More than one chunk, and slices that don't divide the chunk size
+    const int width = 40, height = 30, depth = 9;
+
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height, depth);
+
+    UnitCubeMapping& mapping = graph.add_node<UnitCubeMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    Expression& expression = graph.add_node<Expression>();
+    expression.set_expression("p.x + p.y*10 + p.z*100");
+    graph.connect(mapping.output("Mapped"), expression.input("p"));
+
+    GraphNode& output_node = graph.add_attribute_output("Output");
+    graph.connect(expression.output("Output"), output_node.input("Input"));
+
+    GraphExecutor fused(graph);
+    set_parallel_thread_count(4);
+    std::vector<float> several = fused.execute().get_attribute_all_vector<float>("Output");
+    set_parallel_thread_count(1);
+    std::vector<float> single = fused.execute().get_attribute_all_vector<float>("Output");
+    set_parallel_thread_count(0);
+
+    REQUIRE(fused.fused_groups().size() == 1);
+    REQUIRE(fused.fused_groups()[0].front() == mapping.id());
+
+    GraphExecutor unfused(graph);
+    unfused.set_fusion_enabled(false);
+    std::vector<float> separate = unfused.execute().get_attribute_all_vector<float>("Output");
+
+    REQUIRE(several.size() == static_cast<std::size_t>(width * height * depth));
+    REQUIRE(several == single);
+    REQUIRE(several == separate);
+
+    for(int z = 0; z < depth; z++)
+    {
+        for(int y = 0; y < height; y++)
+        {
+            for(int x = 0; x < width; x++)
+            {
+                float expected = ((static_cast<float>(x) / width) * 2 - 1) + ((static_cast<float>(y) / height) * 2 - 1) * 10 +
+                                 ((static_cast<float>(z) / depth) * 2 - 1) * 100;
+                REQUIRE(several[(z * height + y) * width + x] == Approx(expected));
+            }
+        }
+    }
+}
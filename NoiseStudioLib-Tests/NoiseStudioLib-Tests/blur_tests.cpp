@@ -0,0 +1,157 @@
+#include "catch.h"
+
+#include <cmath>
+
+#include <nodes/blur.h>
+#include <nodes/blank_grid.h>
+#include <nodes/constant_value.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/mappings/unit_square_mapping.h>
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+namespace
+{
+    const int width = 37;
+    const int height = 23;
+
+    // Direct 2D convolution with the outer product of the weights, repeating the edge pixels
+    std::vector<double> reference_blur(const std::vector<float>& source, const std::vector<double>& weights)
+    {
+        int radius = static_cast<int>(weights.size() / 2);
+        std::vector<double> out(source.size(), 0.0);
+
+        for(int y = 0; y < height; y++)
+        {
+            for(int x = 0; x < width; x++)
+            {
+                double sum = 0.0;
+                for(int ky = -radius; ky <= radius; ky++)
+                {
+                    for(int kx = -radius; kx <= radius; kx++)
+                    {
+                        int sx = std::min(std::max(x + kx, 0), width - 1);
+                        int sy = std::min(std::max(y + ky, 0), height - 1);
+                        sum += weights[ky + radius] * weights[kx + radius] * source[sy * width + sx];
+                    }
+                }
+                out[y * width + x] = sum;
+            }
+        }
+
+        return out;
+    }
+
+    void check_blur(Graph& graph, const Blur& blur)
+    {
+        GraphExecutor executor(graph);
+        GraphOutputs outputs = executor.execute();
+
+        std::vector<float> source = outputs.get_attribute_all_vector<float>("Source");
+        std::vector<float> blurred = outputs.get_attribute_all_vector<float>("Blurred");
+        std::vector<double> expected = reference_blur(source, blur.weights());
+
+        REQUIRE(blurred.size() == static_cast<std::size_t>(width * height));
+        for(std::size_t i = 0; i < blurred.size(); i++)
+        {
+            REQUIRE(std::abs(blurred[i] - expected[i]) < 1e-5);
+        }
+    }
+}
+
+TEST_CASE("Box blur matches a direct convolution", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    // Isn't linear, so edges and the interior both matter
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    Blur& blur = graph.add_node<Blur>();
+    graph.connect(noise.output("Output"), blur.input("Input"));
+
+    GraphNode& source_output = graph.add_attribute_output("Source");
+    graph.connect(noise.output("Output"), source_output.input("Input"));
+
+    GraphNode& blurred_output = graph.add_attribute_output("Blurred");
+    graph.connect(blur.output("Output"), blurred_output.input("Input"));
+    blur.set_radius(3);
+
+    std::vector<double> weights = blur.weights();
+    REQUIRE(weights.size() == 7);
+    REQUIRE(weights[0] == Approx(1.0 / 7.0));
+
+    check_blur(graph, blur);
+
+    // Wider than the grid, so every window is mostly repeated edge pixels
+    blur.set_radius(40);
+    check_blur(graph, blur);
+}
+
+TEST_CASE("Gaussian and custom kernels match a direct convolution", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    // Isn't linear, so edges and the interior both matter
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    Blur& blur = graph.add_node<Blur>();
+    graph.connect(noise.output("Output"), blur.input("Input"));
+
+    GraphNode& source_output = graph.add_attribute_output("Source");
+    graph.connect(noise.output("Output"), source_output.input("Input"));
+
+    GraphNode& blurred_output = graph.add_attribute_output("Blurred");
+    graph.connect(blur.output("Output"), blurred_output.input("Input"));
+
+    blur.set_kernel(BlurKernel::gaussian);
+    blur.set_radius(4);
+    blur.set_sigma(1.5f);
+
+    std::vector<double> weights = blur.weights();
+    double total = 0.0;
+    for(double weight : weights)
+    {
+        total += weight;
+    }
+    REQUIRE(total == Approx(1.0));
+    REQUIRE(weights[4] > weights[3]);
+    REQUIRE(weights[3] == Approx(weights[5]));
+
+    check_blur(graph, blur);
+
+    blur.set_kernel(BlurKernel::custom);
+    blur.set_custom_kernel({ 0.25f, 0.5f, 0.25f });
+    check_blur(graph, blur);
+
+    // An even number of weights has no middle
+    blur.set_custom_kernel({ 0.5f, 0.5f });
+    GraphExecutor executor(graph);
+    REQUIRE_THROWS(executor.execute());
+}
@@ -0,0 +1,111 @@
+#include "catch.h"
+
+#include <nodes/domain_warp.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/constant_value.h>
+#include <graph.h>
+#include <graph_outputs.h>
+
+using namespace noises;
+using namespace noises::nodes;
+
+namespace
+{
+    std::vector<std::array<float, 2>> make_points()
+    {
+        std::vector<std::array<float, 2>> points;
+        for(int y = 0; y < 8; y++)
+        {
+            for(int x = 0; x < 8; x++)
+            {
+                points.push_back(std::array<float, 2> { x * 0.37f - 1.2f, y * 0.41f + 0.3f });
+            }
+        }
+        return points;
+    }
+}
+
+TEST_CASE("Domain warp with zero strength doesn't move points", "")
+{
+    Graph graph;
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(3l);
+
+    DomainWarp& warp = graph.add_node<DomainWarp>();
+    warp.set_strength(0.0f);
+
+    GraphNode& points_input = graph.add_attribute_input("Points");
+    GraphNode& output_node = graph.add_attribute_output("Output");
+
+    graph.connect(seed, warp, "Seed");
+    graph.connect(points_input, warp, "Points");
+    graph.connect(warp, "Warped", output_node);
+
+    std::vector<std::array<float, 2>> points = make_points();
+    graph.set_input_attribute<float, 2>("Points", &points[0][0], points.size());
+
+    GraphOutputs outputs = graph.execute();
+
+    std::vector<float> out = outputs.get_attribute_all_vector<float>("Output");
+
+    REQUIRE(out.size() == points.size() * 2);
+    for(std::size_t i = 0; i < points.size(); i++)
+    {
+        REQUIRE(out[i * 2] == points[i][0]);
+        REQUIRE(out[i * 2 + 1] == points[i][1]);
+    }
+}
+
+TEST_CASE("Domain warp noise output matches perlin noise of the warped points", "")
+{
+    Graph graph;
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(3l);
+
+    DomainWarp& warp = graph.add_node<DomainWarp>();
+    warp.set_strength(0.8f);
+    warp.set_frequency(2.0f);
+    warp.set_output_noise(true);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+
+    GraphNode& points_input = graph.add_attribute_input("Points");
+    GraphNode& fused_output = graph.add_attribute_output("Fused");
+    GraphNode& separate_output = graph.add_attribute_output("Separate");
+    GraphNode& warped_output = graph.add_attribute_output("Warped");
+
+    graph.connect(seed, warp, "Seed");
+    graph.connect(points_input, warp, "Points");
+
+    graph.connect(seed, noise, "Seed");
+    graph.connect(warp, "Warped", noise, "Points");
+
+    graph.connect(warp, "Noise", fused_output);
+    graph.connect(noise, separate_output);
+    graph.connect(warp, "Warped", warped_output);
+
+    std::vector<std::array<float, 2>> points = make_points();
+    graph.set_input_attribute<float, 2>("Points", &points[0][0], points.size());
+
+    GraphOutputs outputs = graph.execute();
+
+    std::vector<float> fused = outputs.get_attribute_all_vector<float>("Fused");
+    std::vector<float> separate = outputs.get_attribute_all_vector<float>("Separate");
+    std::vector<float> warped = outputs.get_attribute_all_vector<float>("Warped");
+
+    REQUIRE(fused.size() == separate.size());
+    for(std::size_t i = 0; i < fused.size(); i++)
+    {
+        REQUIRE(fused[i] == separate[i]);
+    }
+
+    bool moved = false;
+    for(std::size_t i = 0; i < points.size(); i++)
+    {
+        if(warped[i * 2] != points[i][0] || warped[i * 2 + 1] != points[i][1])
+            moved = true;
+    }
+    REQUIRE(moved);
+}
@@ -0,0 +1,221 @@
+#include "catch.h"
+
+#include <cmath>
+
+#include <nodes/erosion.h>
+#include <nodes/blank_grid.h>
+#include <nodes/constant_value.h>
+#include <nodes/expression.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/mappings/unit_square_mapping.h>
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <parallel.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+namespace
+{
+    double total(const std::vector<float>& values)
+    {
+        double sum = 0.0;
+        for(float value : values)
+        {
+            sum += value;
+        }
+        return sum;
+    }
+}
+
+TEST_CASE("Erosion moves material around without creating or destroying any", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(48, 40);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    ConstantValue& noise_seed = graph.add_node<ConstantValue>();
+    noise_seed.set_value_single(3l);
+
+    PerlinNoise& hills = graph.add_node<PerlinNoise>();
+    graph.connect(noise_seed, hills, "Seed");
+    graph.connect(mapping.output("Mapped"), hills.input("Points"));
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(7l);
+
+    Erosion& erosion = graph.add_node<Erosion>();
+    graph.connect(seed, erosion, "Seed");
+    graph.connect(hills.output("Output"), erosion.input("Height"));
+
+    GraphNode& source_output = graph.add_attribute_output("Source");
+    graph.connect(hills.output("Output"), source_output.input("Input"));
+
+    GraphNode& eroded_output = graph.add_attribute_output("Eroded");
+    graph.connect(erosion.output("Eroded"), eroded_output.input("Input"));
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+
+    std::vector<float> source = outputs.get_attribute_all_vector<float>("Source");
+    std::vector<float> eroded = outputs.get_attribute_all_vector<float>("Eroded");
+
+    REQUIRE(eroded.size() == source.size());
+    REQUIRE(total(eroded) == Approx(total(source)).epsilon(0.0001));
+
+    float largest_change = 0.0f;
+    for(std::size_t i = 0; i < source.size(); i++)
+    {
+        largest_change = std::max(largest_change, std::abs(eroded[i] - source[i]));
+    }
+    REQUIRE(largest_change > 0.001f);
+}
+
+TEST_CASE("Erosion with no iterations leaves the heights alone", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(48, 40);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    ConstantValue& noise_seed = graph.add_node<ConstantValue>();
+    noise_seed.set_value_single(3l);
+
+    PerlinNoise& hills = graph.add_node<PerlinNoise>();
+    graph.connect(noise_seed, hills, "Seed");
+    graph.connect(mapping.output("Mapped"), hills.input("Points"));
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(7l);
+
+    Erosion& erosion = graph.add_node<Erosion>();
+    graph.connect(seed, erosion, "Seed");
+    graph.connect(hills.output("Output"), erosion.input("Height"));
+
+    GraphNode& source_output = graph.add_attribute_output("Source");
+    graph.connect(hills.output("Output"), source_output.input("Input"));
+
+    GraphNode& eroded_output = graph.add_attribute_output("Eroded");
+    graph.connect(erosion.output("Eroded"), eroded_output.input("Input"));
+
+    erosion.set_iterations(0);
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+
+    std::vector<float> source = outputs.get_attribute_all_vector<float>("Source");
+    std::vector<float> eroded = outputs.get_attribute_all_vector<float>("Eroded");
+    REQUIRE(eroded == source);
+}
+
+TEST_CASE("Erosion is the same for a seed whatever the thread count", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(48, 40);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    ConstantValue& noise_seed = graph.add_node<ConstantValue>();
+    noise_seed.set_value_single(3l);
+
+    PerlinNoise& hills = graph.add_node<PerlinNoise>();
+    graph.connect(noise_seed, hills, "Seed");
+    graph.connect(mapping.output("Mapped"), hills.input("Points"));
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(7l);
+
+    Erosion& erosion = graph.add_node<Erosion>();
+    graph.connect(seed, erosion, "Seed");
+    graph.connect(hills.output("Output"), erosion.input("Height"));
+
+    GraphNode& eroded_output = graph.add_attribute_output("Eroded");
+    graph.connect(erosion.output("Eroded"), eroded_output.input("Input"));
+
+    GraphExecutor executor(graph);
+
+    set_parallel_thread_count(1);
+    std::vector<float> single = executor.execute().get_attribute_all_vector<float>("Eroded");
+
+    set_parallel_thread_count(4);
+    std::vector<float> several = executor.execute().get_attribute_all_vector<float>("Eroded");
+
+    set_parallel_thread_count(0);
+
+    REQUIRE(single == several);
+
+    seed.set_value_single(8l);
+    std::vector<float> other_seed = executor.execute().get_attribute_all_vector<float>("Eroded");
+    REQUIRE(other_seed != single);
+}
+
+TEST_CASE("Thermal erosion slides steep slopes down towards the talus", "")
+{
+    const int width = 48, height = 40;
+
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    Expression& bowl = graph.add_node<Expression>();
+    bowl.set_expression("p.x*p.x*2");
+    graph.connect(mapping.output("Mapped"), bowl.input("p"));
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(7l);
+
+    Erosion& erosion = graph.add_node<Erosion>();
+    graph.connect(seed, erosion, "Seed");
+    graph.connect(bowl.output("Output"), erosion.input("Height"));
+
+    GraphNode& source_output = graph.add_attribute_output("Source");
+    graph.connect(bowl.output("Output"), source_output.input("Input"));
+
+    GraphNode& eroded_output = graph.add_attribute_output("Eroded");
+    graph.connect(erosion.output("Eroded"), eroded_output.input("Input"));
+
+    erosion.set_rainfall(0.0f);
+    erosion.set_thermal_rate(1.0f);
+    erosion.set_talus(0.02f);
+    erosion.set_iterations(400);
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+
+    std::vector<float> source = outputs.get_attribute_all_vector<float>("Source");
+    std::vector<float> eroded = outputs.get_attribute_all_vector<float>("Eroded");
+
+    auto steepest = [width, height](const std::vector<float>& heights)
+    {
+        float largest = 0.0f;
+        for(int y = 0; y < height; y++)
+        {
+            for(int x = 0; x + 1 < width; x++)
+            {
+                largest = std::max(largest, std::abs(heights[y * width + x + 1] - heights[y * width + x]));
+            }
+        }
+        return largest;
+    };
+
+    // The sides of the bowl start out about 4 times steeper than the talus
+    REQUIRE(steepest(source) > 0.08f);
+    REQUIRE(steepest(eroded) < 0.025f);
+    REQUIRE(total(eroded) == Approx(total(source)).epsilon(0.0001));
+}
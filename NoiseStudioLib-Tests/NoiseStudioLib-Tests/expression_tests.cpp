@@ -0,0 +1,120 @@
+#include "catch.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include <nodes/expression.h>
+#include <nodes/constant_value.h>
+#include <graph.h>
+#include <graph_outputs.h>
+#include <graph_validator.h>
+
+using namespace noises;
+using namespace noises::nodes;
+
+TEST_CASE("Expression programs fold constants and reject malformed input", "")
+{
+    ExpressionProgram folded = ExpressionProgram::compile("2 * (3 + 1) - max(1, 2) ^ 2");
+    REQUIRE(folded.instructions().size() == 1);
+    REQUIRE(folded.instructions()[0].opcode == ExpressionOpcode::load_constant);
+    REQUIRE(folded.instructions()[0].constant == 4.0f);
+
+    ExpressionProgram variables = ExpressionProgram::compile("a*0.5 + sin(b.y)*a");
+    REQUIRE(variables.variables().size() == 2);
+    REQUIRE(variables.variables()[0].name == "a");
+    REQUIRE(variables.variables()[1].name == "b");
+    REQUIRE(variables.variables()[1].max_component == 1);
+
+    REQUIRE_THROWS_AS(ExpressionProgram::compile(""), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(ExpressionProgram::compile("a +"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(ExpressionProgram::compile("(a"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(ExpressionProgram::compile("nope(a)"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(ExpressionProgram::compile("min(a)"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(ExpressionProgram::compile("a.q"), const std::invalid_argument&);
+}
+
+TEST_CASE("Expression node evaluates attributes and uniforms", "")
+{
+    Graph graph;
+
+    Expression& expression = graph.add_node<Expression>();
+    expression.set_expression("a*0.5 + sin(b.y)*c - clamp(b.x, 0, 1)");
+
+    REQUIRE(expression.inputs().get_by_name("a"));
+    REQUIRE(expression.inputs().get_by_name("b"));
+    REQUIRE(expression.inputs().get_by_name("c"));
+
+    ConstantValue& c_value = graph.add_node<ConstantValue>();
+    c_value.set_value_single(3.0f);
+
+    GraphNode& a_input = graph.add_attribute_input("A");
+    GraphNode& b_input = graph.add_attribute_input("B");
+    GraphNode& output_node = graph.add_attribute_output("Output");
+
+    graph.connect(a_input.output("Output"), expression.input("a"));
+    graph.connect(b_input.output("Output"), expression.input("b"));
+    graph.connect(c_value.output("Value"), expression.input("c"));
+    graph.connect(expression.output("Output"), output_node.input("Input"));
+
+    REQUIRE(expression.output("Output").type() == SocketType::attribute);
+
+    // More than one chunk, and not a multiple of the chunk size
+    std::vector<float> a_values;
+    std::vector<std::array<float, 2>> b_values;
+    for(int i = 0; i < 1000; i++)
+    {
+        a_values.push_back(i * 0.25f);
+        b_values.push_back(std::array<float, 2> { i * 0.01f - 2.0f, i * 0.1f });
+    }
+
+    graph.set_input_attribute<float, 1>("A", &a_values[0], a_values.size());
+    graph.set_input_attribute<float, 2>("B", &b_values[0][0], b_values.size());
+
+    GraphValidator validator(graph);
+    bool is_valid = validator.validate();
+    REQUIRE(is_valid);
+
+    GraphOutputs outputs = graph.execute();
+    std::vector<float> out = outputs.get_attribute_all_vector<float>("Output");
+
+    REQUIRE(out.size() == a_values.size());
+    for(std::size_t i = 0; i < a_values.size(); i++)
+    {
+        float clamped = std::min(std::max(b_values[i][0], 0.0f), 1.0f);
+        float expected = a_values[i] * 0.5f + std::sin(b_values[i][1]) * 3.0f - clamped;
+        REQUIRE(std::abs(out[i] - expected) < 1e-4f);
+    }
+}
+
+TEST_CASE("Expression node drops sockets for names it no longer uses", "")
+{
+    Graph graph;
+
+    Expression& expression = graph.add_node<Expression>();
+    expression.set_expression("x + y");
+
+    ConstantValue& value = graph.add_node<ConstantValue>();
+    value.set_value_single(2.0f);
+
+    graph.connect(value.output("Value"), expression.input("x"));
+    graph.connect(value.output("Value"), expression.input("y"));
+
+    expression.set_expression("x * x / 4");
+
+    REQUIRE(expression.inputs().get_by_name("x"));
+    REQUIRE_FALSE(expression.inputs().get_by_name("y"));
+    REQUIRE(expression.output("Output").type() == SocketType::uniform);
+
+    auto& output_node = graph.add_uniform_output("Output");
+    graph.connect(expression.output("Output"), output_node.input("Input"));
+
+    GraphOutputs outputs = graph.execute();
+    float output = outputs.get_uniform<float, 1>("Output");
+    REQUIRE(output == 1.0f);
+
+    expression.set_expression("x +");
+
+    GraphValidator validator(graph);
+    bool is_valid = validator.validate();
+    REQUIRE_FALSE(is_valid);
+}
@@ -0,0 +1,171 @@
+#include "catch.h"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+#include <fast_math.h>
+
+using namespace noises;
+
+namespace
+{
+    std::vector<float> make_range(float from, float to, std::size_t count)
+    {
+        std::vector<float> values;
+        for(std::size_t i = 0; i < count; i++)
+        {
+            values.push_back(from + (to - from) * static_cast<float>(i) / static_cast<float>(count - 1));
+        }
+        return values;
+    }
+
+    // Largest error of {approximate} against {exact} (computed in double) over {values}. Relative unless {absolute} is set.
+    double max_error(const std::vector<float>& values, std::function<float(float)> approximate, std::function<double(double)> exact, bool absolute)
+    {
+        double worst = 0.0;
+        for(float value : values)
+        {
+            double expected = exact(value);
+            double error = std::abs(static_cast<double>(approximate(value)) - expected);
+            if(!absolute && expected != 0.0)
+                error /= std::abs(expected);
+            worst = std::max(worst, error);
+        }
+        return worst;
+    }
+
+    // Seconds per element of running {function} over {values}
+    double time_per_element(const std::vector<float>& values, std::function<void(const float*, float*, std::size_t)> function)
+    {
+        std::vector<float> out(values.size());
+        const int repeats = 20;
+
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < repeats; i++)
+        {
+            function(values.data(), out.data(), values.size());
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        volatile float sink = out[values.size() / 2];
+        (void)sink;
+
+        return elapsed / (repeats * values.size());
+    }
+}
+
+TEST_CASE("Fast math approximations stay within 1e-4 of the standard library", "")
+{
+    std::vector<float> angles = make_range(-100.0f, 100.0f, 200001);
+    std::vector<float> exponents = make_range(-80.0f, 80.0f, 200001);
+    std::vector<float> positives = make_range(1e-6f, 1e6f, 200001);
+    std::vector<float> near_one = make_range(0.5f, 2.0f, 200001);
+
+    double sin_error = max_error(angles, fast_math::sin<float>, [](double x) { return std::sin(x); }, true);
+    double cos_error = max_error(angles, fast_math::cos<float>, [](double x) { return std::cos(x); }, true);
+    double exp_error = max_error(exponents, fast_math::exp<float>, [](double x) { return std::exp(x); }, false);
+    double log_error = std::max(max_error(positives, fast_math::log<float>, [](double x) { return std::log(x); }, false),
+                                max_error(near_one, fast_math::log<float>, [](double x) { return std::log(x); }, false));
+    double log2_error = max_error(positives, fast_math::log2<float>, [](double x) { return std::log2(x); }, false);
+    double log10_error = max_error(positives, fast_math::log10<float>, [](double x) { return std::log10(x); }, false);
+    double pow_error = max_error(near_one, [](float x) { return fast_math::pow(x, 7.5f); }, [](double x) { return std::pow(x, 7.5); }, false);
+    double atan2_error = 0.0;
+    for(float angle : make_range(-3.14f, 3.14f, 20001))
+    {
+        for(float radius : { 1e-3f, 1.0f, 1e3f })
+        {
+            float y = radius * std::sin(angle);
+            float x = radius * std::cos(angle);
+            double expected = std::atan2(static_cast<double>(y), static_cast<double>(x));
+            atan2_error = std::max(atan2_error, std::abs(fast_math::atan2(y, x) - expected) / std::max(std::abs(expected), 1e-3));
+        }
+    }
+
+    std::ostringstream report;
+    report << "Max error of the fast approximations (float)" << std::endl
+           << "  sin (absolute)  " << sin_error << std::endl
+           << "  cos (absolute)  " << cos_error << std::endl
+           << "  exp (relative)  " << exp_error << std::endl
+           << "  log (relative)  " << log_error << std::endl
+           << "  log2 (relative) " << log2_error << std::endl
+           << "  log10 (relative)" << log10_error << std::endl
+           << "  pow (relative)  " << pow_error << std::endl
+           << "  atan2 (relative)" << atan2_error << std::endl;
+    INFO(report.str());
+
+    REQUIRE(sin_error < 1e-4);
+    REQUIRE(cos_error < 1e-4);
+    REQUIRE(exp_error < 1e-4);
+    REQUIRE(log_error < 1e-4);
+    REQUIRE(log2_error < 1e-4);
+    REQUIRE(log10_error < 1e-4);
+    REQUIRE(pow_error < 1e-4);
+    REQUIRE(atan2_error < 1e-4);
+}
+
+TEST_CASE("Fast math handles the edges of the domain like the standard library", "")
+{
+    REQUIRE(fast_math::log(0.0f) == -std::numeric_limits<float>::infinity());
+    REQUIRE(std::isnan(fast_math::log(-1.0f)));
+    REQUIRE(fast_math::exp(1000.0f) == std::numeric_limits<float>::infinity());
+    REQUIRE(fast_math::exp(-1000.0f) == 0.0f);
+    REQUIRE(fast_math::pow(0.0f, 0.0f) == 1.0f);
+    REQUIRE(fast_math::pow(0.0f, 2.0f) == 0.0f);
+    REQUIRE(fast_math::pow(-2.0f, 3.0f) == Approx(-8.0f));
+    REQUIRE(std::isnan(fast_math::pow(-2.0f, 0.5f)));
+    REQUIRE(fast_math::atan2(0.0f, 0.0f) == 0.0f);
+    REQUIRE(fast_math::atan2(0.0f, -1.0f) == Approx(static_cast<float>(M_PI)));
+
+    REQUIRE(fast_math::sin(1.0) == Approx(std::sin(1.0)).epsilon(1e-5));
+    REQUIRE(fast_math::pow(0.0, 0.0) == 1.0);
+    REQUIRE(fast_math::log(12345.678) == Approx(std::log(12345.678)).epsilon(1e-5));
+}
+
+TEST_CASE("Fast sin and cos stay accurate up to the largest argument they support", "")
+{
+    float limit = fast_math::FloatBits<float>::max_trig_argument();
+    std::vector<float> angles = make_range(-limit, limit, 1 << 16);
+    angles.push_back(limit);
+    angles.push_back(std::nextafter(limit, 0.0f));
+
+    REQUIRE(max_error(angles, fast_math::sin<float>, [](double x) { return std::sin(x); }, true) < 1e-4);
+    REQUIRE(max_error(angles, fast_math::cos<float>, [](double x) { return std::cos(x); }, true) < 1e-4);
+
+    REQUIRE(fast_math::is_trig_argument_in_range(limit));
+    REQUIRE_FALSE(fast_math::is_trig_argument_in_range(std::nextafter(limit, 2.0f * limit)));
+    REQUIRE_FALSE(fast_math::is_trig_argument_in_range(-1e9f));
+    REQUIRE_FALSE(fast_math::is_trig_argument_in_range(1e9));
+}
+
+// Hidden, run with: NoiseStudioLib-Tests "[benchmark]"
+TEST_CASE("Fast math benchmark", "[.][benchmark]")
+{
+    std::vector<float> angles = make_range(-100.0f, 100.0f, 1 << 20);
+    std::vector<float> positives = make_range(1e-3f, 1e3f, 1 << 20);
+
+    auto report_line = [](const std::string& name, double exact, double fast)
+    {
+        std::ostringstream line;
+        line << name << ": exact " << exact * 1e9 << " ns, fast " << fast * 1e9 << " ns, " << exact / fast << "x";
+        WARN(line.str());
+    };
+
+    report_line("sin",
+                time_per_element(angles, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = std::sin(in[i]); }),
+                time_per_element(angles, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = fast_math::sin(in[i]); }));
+    report_line("exp",
+                time_per_element(angles, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = std::exp(in[i] * 0.5f); }),
+                time_per_element(angles, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = fast_math::exp(in[i] * 0.5f); }));
+    report_line("log",
+                time_per_element(positives, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = std::log(in[i]); }),
+                time_per_element(positives, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = fast_math::log(in[i]); }));
+    report_line("pow",
+                time_per_element(positives, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = std::pow(in[i], 1.7f); }),
+                time_per_element(positives, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = fast_math::pow(in[i], 1.7f); }));
+    report_line("atan2",
+                time_per_element(angles, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = std::atan2(in[i], 3.0f); }),
+                time_per_element(angles, [](const float* in, float* out, std::size_t n) { for(std::size_t i = 0; i < n; i++) out[i] = fast_math::atan2(in[i], 3.0f); }));
+}
@@ -0,0 +1,863 @@
+#include "catch.h"
+
+#include <nodes/math.h>
+#include <nodes/type_conversion.h>
+#include <nodes/constant_value.h>
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <composite_data_buffer.h>
+#include <active_elements.h>
+#include <cancellation_token.h>
+#include <parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+using namespace noises;
+using namespace noises::nodes;
+
+namespace
+{
+    // Squares a uniform float and counts how often it was executed
+    class CountingSquare : public GraphNode
+    {
+    public:
+        CountingSquare() : executions(0)
+        {
+            input_ = &inputs().add("Input", SocketType::uniform);
+            input_->set_accepts(ConnectionDataType::value<float, 1>());
+            output_ = &outputs().add("Output", ConnectionDataType::value<float, 1>(), SocketType::uniform);
+        }
+
+        std::string node_name() const { return "Counting Square"; }
+
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const
+        {
+            executions++;
+            float value = input.get_uniform<float, 1>(*input_)[0];
+            value *= value;
+            output.set_uniform<float, 1>(*output_, &value);
+        }
+
+        bool is_pure() const { return true; }
+
+        mutable int executions;
+
+    private:
+        InputSocket* input_;
+        OutputSocket* output_;
+    };
+
+    // Copies a float attribute and counts the elements it was executed for
+    class CountingCopy : public GraphNode
+    {
+    public:
+        CountingCopy() : elements(0)
+        {
+            input_ = &inputs().add("Input", SocketType::attribute);
+            input_->set_accepts(ConnectionDataType::value<float, 1>());
+            output_ = &outputs().add("Output", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+        }
+
+        std::string node_name() const { return "Counting Copy"; }
+
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+        {
+            elements += end - begin;
+            for(DataBuffer::size_type i = begin; i < end; i++)
+            {
+                output.set_attribute<float, 1>(*output_, i, input.get_attribute<float, 1>(*input_, i));
+            }
+        }
+
+        bool is_elementwise() const { return true; }
+
+        mutable std::atomic<std::size_t> elements;
+
+    private:
+        InputSocket* input_;
+        OutputSocket* output_;
+    };
+
+    // The threads ThreadRecordingCopy nodes were executed on. Not kept on the node since background executions run on copies of it
+    std::mutex recorded_threads_mutex;
+    std::set<std::thread::id> recorded_threads;
+
+    // Copies a float attribute and records the threads it was executed on
+    class ThreadRecordingCopy : public GraphNode
+    {
+    public:
+        ThreadRecordingCopy()
+        {
+            input_ = &inputs().add("Input", SocketType::attribute);
+            input_->set_accepts(ConnectionDataType::value<float, 1>());
+            output_ = &outputs().add("Output", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+        }
+
+        std::string node_name() const { return "Thread Recording Copy"; }
+
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+        {
+            {
+                std::lock_guard<std::mutex> lock(recorded_threads_mutex);
+                recorded_threads.insert(std::this_thread::get_id());
+            }
+
+            // Long enough that the other threads get some of the ranges
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            for(DataBuffer::size_type i = begin; i < end; i++)
+            {
+                output.set_attribute<float, 1>(*output_, i, input.get_attribute<float, 1>(*input_, i));
+            }
+        }
+
+        bool is_elementwise() const { return true; }
+
+    private:
+        InputSocket* input_;
+        OutputSocket* output_;
+    };
+
+    Math& add_math(Graph& graph, MathOperation operation)
+    {
+        Math& math = graph.add_node<Math>();
+        int value = static_cast<int>(operation);
+        math.property("Operation").set_value<int, 1>(&value);
+        return math;
+    }
+
+    std::vector<float> make_values()
+    {
+        // Not a multiple of the chunk size so the last chunk is partial
+        std::vector<float> values;
+        for(std::size_t i = 0; i < GraphExecutor::fusion_chunk_size * 2 + 123; i++)
+        {
+            values.push_back(static_cast<float>(i % 97) * 0.25f - 3.0f);
+        }
+        return values;
+    }
+}
+
+TEST_CASE("Fused element-wise chains match unfused execution", "")
+{
+    Graph graph;
+
+    // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    ConstantValue& one = graph.add_node<ConstantValue>();
+    one.set_value_single(1.0f);
+
+    ConstantValue& half = graph.add_node<ConstantValue>();
+    half.set_value_single(0.5f);
+
+    Math& square = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), square.input("A"));
+    graph.connect(a_input.output("Output"), square.input("B"));
+
+    Math& add_one = add_math(graph, MathOperation::add);
+    graph.connect(square.output("Output"), add_one.input("A"));
+    graph.connect(one.output("Value"), add_one.input("B"));
+
+    Math& halve = add_math(graph, MathOperation::multiply);
+    graph.connect(add_one.output("Output"), halve.input("A"));
+    graph.connect(half.output("Value"), halve.input("B"));
+
+    Math& add_a = add_math(graph, MathOperation::add);
+    graph.connect(halve.output("Output"), add_a.input("A"));
+    graph.connect(a_input.output("Output"), add_a.input("B"));
+
+    TypeConversion& to_double = graph.add_node<TypeConversion>();
+    to_double.set_type(TypeConversionTargetType::double_t);
+    graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(to_double.output("Output"), output.input("Input"));
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    GraphExecutor fused(graph);
+    GraphOutputs fused_outputs = fused.execute();
+
+    REQUIRE(fused.fused_groups().size() == 1);
+    REQUIRE(fused.fused_groups()[0].size() == 5);
+
+    GraphExecutor unfused(graph);
+    unfused.set_fusion_enabled(false);
+    GraphOutputs unfused_outputs = unfused.execute();
+
+    REQUIRE(unfused.fused_groups().empty());
+
+    std::vector<double> fused_values = fused_outputs.get_attribute_all_vector<double>("Output");
+    std::vector<double> unfused_values = unfused_outputs.get_attribute_all_vector<double>("Output");
+
+    REQUIRE(fused_values.size() == values.size());
+    REQUIRE(fused_values == unfused_values);
+
+    for(std::size_t i = 0; i < values.size(); i++)
+    {
+        float expected = (values[i] * values[i] + 1.0f) * 0.5f + values[i];
+        REQUIRE(fused_values[i] == static_cast<double>(expected));
+    }
+}
+
+TEST_CASE("Fusion keeps outputs that have more than one consumer", "")
+{
+    Graph graph;
+
+    // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output, with (A * A) also going to "Squared"
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    ConstantValue& one = graph.add_node<ConstantValue>();
+    one.set_value_single(1.0f);
+
+    ConstantValue& half = graph.add_node<ConstantValue>();
+    half.set_value_single(0.5f);
+
+    Math& square = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), square.input("A"));
+    graph.connect(a_input.output("Output"), square.input("B"));
+
+    Math& add_one = add_math(graph, MathOperation::add);
+    graph.connect(square.output("Output"), add_one.input("A"));
+    graph.connect(one.output("Value"), add_one.input("B"));
+
+    Math& halve = add_math(graph, MathOperation::multiply);
+    graph.connect(add_one.output("Output"), halve.input("A"));
+    graph.connect(half.output("Value"), halve.input("B"));
+
+    Math& add_a = add_math(graph, MathOperation::add);
+    graph.connect(halve.output("Output"), add_a.input("A"));
+    graph.connect(a_input.output("Output"), add_a.input("B"));
+
+    TypeConversion& to_double = graph.add_node<TypeConversion>();
+    to_double.set_type(TypeConversionTargetType::double_t);
+    graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(to_double.output("Output"), output.input("Input"));
+
+    GraphNode& squared_output = graph.add_attribute_output("Squared");
+    graph.connect(square.output("Output"), squared_output.input("Input"));
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+
+    // The square is needed by the Squared output, so only the nodes after it are fused
+    REQUIRE(executor.fused_groups().size() == 1);
+    REQUIRE(executor.fused_groups()[0].size() == 4);
+
+    std::vector<float> squared = outputs.get_attribute_all_vector<float>("Squared");
+    std::vector<double> out = outputs.get_attribute_all_vector<double>("Output");
+
+    REQUIRE(squared.size() == values.size());
+    for(std::size_t i = 0; i < values.size(); i++)
+    {
+        REQUIRE(squared[i] == values[i] * values[i]);
+        REQUIRE(out[i] == static_cast<double>((squared[i] + 1.0f) * 0.5f + values[i]));
+    }
+}
+
+TEST_CASE("Uniform-only subgraphs are folded and cached until an input changes", "")
+{
+    Graph graph;
+
+    GraphNode& a_input = graph.add_attribute_input("A");
+    GraphNode& scale_input = graph.add_uniform_input("Scale");
+
+    ConstantValue& offset = graph.add_node<ConstantValue>();
+    offset.set_value_single(2.0f);
+
+    CountingSquare& scale_squared = graph.add_node<CountingSquare>();
+    graph.connect(scale_input.output("Output"), scale_squared.input("Input"));
+
+    CountingSquare& offset_squared = graph.add_node<CountingSquare>();
+    graph.connect(offset.output("Value"), offset_squared.input("Input"));
+
+    Math& multiply = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), multiply.input("A"));
+    graph.connect(scale_squared.output("Output"), multiply.input("B"));
+
+    Math& add = add_math(graph, MathOperation::add);
+    graph.connect(multiply.output("Output"), add.input("A"));
+    graph.connect(offset_squared.output("Output"), add.input("B"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(add.output("Output"), output.input("Input"));
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+    float scale = 3.0f;
+    graph.set_input_uniform<float, 1>("Scale", &scale);
+
+    GraphExecutor executor(graph);
+
+    auto check = [&](float expected_scale, float offset_value)
+    {
+        std::vector<float> out = executor.execute().get_attribute_all_vector<float>("Output");
+        REQUIRE(out.size() == values.size());
+        for(std::size_t i = 0; i < values.size(); i++)
+        {
+            REQUIRE(out[i] == values[i] * (expected_scale * expected_scale) + offset_value * offset_value);
+        }
+    };
+
+    check(3.0f, 2.0f);
+    REQUIRE(scale_squared.executions == 1);
+    REQUIRE(offset_squared.executions == 1);
+
+    // Both squares and everything feeding them are folded, the attribute Math nodes aren't
+    std::vector<int> folded = executor.folded_nodes();
+    REQUIRE(std::count(folded.begin(), folded.end(), scale_squared.id()) == 1);
+    REQUIRE(std::count(folded.begin(), folded.end(), offset_squared.id()) == 1);
+    REQUIRE(std::count(folded.begin(), folded.end(), multiply.id()) == 0);
+
+    check(3.0f, 2.0f);
+    REQUIRE(scale_squared.executions == 1);
+    REQUIRE(offset_squared.executions == 1);
+
+    offset.set_value_single(5.0f);
+    check(3.0f, 5.0f);
+    REQUIRE(scale_squared.executions == 1);
+    REQUIRE(offset_squared.executions == 2);
+
+    scale = 0.5f;
+    graph.set_input_uniform<float, 1>("Scale", &scale);
+    check(0.5f, 5.0f);
+    REQUIRE(scale_squared.executions == 2);
+    REQUIRE(offset_squared.executions == 2);
+
+    executor.set_constant_folding_enabled(false);
+    check(0.5f, 5.0f);
+    REQUIRE(executor.folded_nodes().empty());
+    REQUIRE(scale_squared.executions == 3);
+    REQUIRE(offset_squared.executions == 3);
+}
+
+TEST_CASE("The same graph can be executed from several threads at once", "")
+{
+    Graph graph;
+
+    // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output, with (A * A) also going to "Squared"
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    ConstantValue& one = graph.add_node<ConstantValue>();
+    one.set_value_single(1.0f);
+
+    ConstantValue& half = graph.add_node<ConstantValue>();
+    half.set_value_single(0.5f);
+
+    Math& square = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), square.input("A"));
+    graph.connect(a_input.output("Output"), square.input("B"));
+
+    Math& add_one = add_math(graph, MathOperation::add);
+    graph.connect(square.output("Output"), add_one.input("A"));
+    graph.connect(one.output("Value"), add_one.input("B"));
+
+    Math& halve = add_math(graph, MathOperation::multiply);
+    graph.connect(add_one.output("Output"), halve.input("A"));
+    graph.connect(half.output("Value"), halve.input("B"));
+
+    Math& add_a = add_math(graph, MathOperation::add);
+    graph.connect(halve.output("Output"), add_a.input("A"));
+    graph.connect(a_input.output("Output"), add_a.input("B"));
+
+    TypeConversion& to_double = graph.add_node<TypeConversion>();
+    to_double.set_type(TypeConversionTargetType::double_t);
+    graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(to_double.output("Output"), output.input("Input"));
+
+    GraphNode& squared_output = graph.add_attribute_output("Squared");
+    graph.connect(square.output("Output"), squared_output.input("Input"));
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    GraphExecutor executor(graph);
+    std::vector<double> expected = executor.execute().get_attribute_all_vector<double>("Output");
+
+    std::vector<std::vector<double>> results(4);
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        threads.emplace_back([&graph, &results, i]()
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                results[i] = graph.execute().get_attribute_all_vector<double>("Output");
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for(std::vector<double>& result : results)
+    {
+        REQUIRE(result == expected);
+    }
+}
+
+TEST_CASE("Graphs keep working after being moved", "")
+{
+    std::vector<float> values = make_values();
+
+    std::unique_ptr<Graph> original(new Graph());
+    Graph& graph = *original;
+
+    // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    ConstantValue& one = graph.add_node<ConstantValue>();
+    one.set_value_single(1.0f);
+
+    ConstantValue& half = graph.add_node<ConstantValue>();
+    half.set_value_single(0.5f);
+
+    Math& square = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), square.input("A"));
+    graph.connect(a_input.output("Output"), square.input("B"));
+
+    Math& add_one = add_math(graph, MathOperation::add);
+    graph.connect(square.output("Output"), add_one.input("A"));
+    graph.connect(one.output("Value"), add_one.input("B"));
+
+    Math& halve = add_math(graph, MathOperation::multiply);
+    graph.connect(add_one.output("Output"), halve.input("A"));
+    graph.connect(half.output("Value"), halve.input("B"));
+
+    Math& add_a = add_math(graph, MathOperation::add);
+    graph.connect(halve.output("Output"), add_a.input("A"));
+    graph.connect(a_input.output("Output"), add_a.input("B"));
+
+    TypeConversion& to_double = graph.add_node<TypeConversion>();
+    to_double.set_type(TypeConversionTargetType::double_t);
+    graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(to_double.output("Output"), output.input("Input"));
+
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+    std::vector<double> expected = graph.execute().get_attribute_all_vector<double>("Output");
+
+    Graph moved(std::move(*original));
+    original.reset();
+    REQUIRE(moved.execute().get_attribute_all_vector<double>("Output") == expected);
+
+    // Changing a node's outputs refreshes the graph it was moved to
+    TypeConversion* conversion = nullptr;
+    for(GraphNode& node : moved.nodes())
+    {
+        REQUIRE(node.parent() == &moved);
+        if(dynamic_cast<TypeConversion*>(&node))
+            conversion = dynamic_cast<TypeConversion*>(&node);
+    }
+    REQUIRE(conversion != nullptr);
+    conversion->set_type(TypeConversionTargetType::float_t);
+    std::vector<float> as_float = moved.execute().get_attribute_all_vector<float>("Output");
+    REQUIRE(as_float.size() == expected.size());
+
+    Graph assigned;
+    assigned = std::move(moved);
+    REQUIRE(assigned.execute().get_attribute_all_vector<float>("Output") == as_float);
+}
+
+TEST_CASE("Active elements are runs of a mask's non-zero elements", "")
+{
+    std::vector<float> mask { 0.0f, 1.0f, 0.5f, 0.0f, 0.0f, -2.0f, 0.0f, 3.0f };
+    ActiveElements elements = ActiveElements::from_mask(mask.data(), mask.size());
+
+    REQUIRE(elements.length() == 8);
+    REQUIRE(elements.count() == 4);
+    REQUIRE(elements.ranges() == std::vector<ActiveElements::Range>({ { 1, 3 }, { 5, 6 }, { 7, 8 } }));
+
+    std::vector<ActiveElements::Range> clipped;
+    elements.for_each_range(2, 7, [&](std::size_t begin, std::size_t end) { clipped.emplace_back(begin, end); });
+    REQUIRE(clipped == std::vector<ActiveElements::Range>({ { 2, 3 }, { 5, 6 } }));
+
+    REQUIRE_THROWS_AS(elements.add(6, 8), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(elements.add(8, 9), const std::invalid_argument&);
+    REQUIRE(ActiveElements::all(5).count() == 5);
+}
+
+TEST_CASE("Element-wise nodes only calculate the active elements", "")
+{
+    Graph graph;
+
+    // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    ConstantValue& one = graph.add_node<ConstantValue>();
+    one.set_value_single(1.0f);
+
+    ConstantValue& half = graph.add_node<ConstantValue>();
+    half.set_value_single(0.5f);
+
+    Math& square = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), square.input("A"));
+    graph.connect(a_input.output("Output"), square.input("B"));
+
+    Math& add_one = add_math(graph, MathOperation::add);
+    graph.connect(square.output("Output"), add_one.input("A"));
+    graph.connect(one.output("Value"), add_one.input("B"));
+
+    Math& halve = add_math(graph, MathOperation::multiply);
+    graph.connect(add_one.output("Output"), halve.input("A"));
+    graph.connect(half.output("Value"), halve.input("B"));
+
+    Math& add_a = add_math(graph, MathOperation::add);
+    graph.connect(halve.output("Output"), add_a.input("A"));
+    graph.connect(a_input.output("Output"), add_a.input("B"));
+
+    TypeConversion& to_double = graph.add_node<TypeConversion>();
+    to_double.set_type(TypeConversionTargetType::double_t);
+    graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(to_double.output("Output"), output.input("Input"));
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    CountingCopy& copy = graph.add_node<CountingCopy>();
+    graph.connect(a_input.output("Output"), copy.input("Input"));
+    GraphNode& copied = graph.add_attribute_output("Copied");
+    graph.connect(copy.output("Output"), copied.input("Input"));
+
+    // A few runs, one of them across a chunk boundary, and a whole chunk with nothing active
+    std::vector<float> mask(values.size(), 0.0f);
+    for(std::size_t i = 0; i < mask.size(); i++)
+    {
+        if((i >= 10 && i < 20) || (i >= GraphExecutor::fusion_chunk_size - 5 && i < GraphExecutor::fusion_chunk_size + 5) || i == mask.size() - 1)
+            mask[i] = 1.0f;
+    }
+    ActiveElements active = ActiveElements::from_mask(mask.data(), mask.size());
+
+    GraphExecutor full(graph);
+    std::vector<double> expected = full.execute().get_attribute_all_vector<double>("Output");
+    copy.elements = 0;
+
+    for(bool fusion : { true, false })
+    {
+        GraphExecutor masked(graph);
+        masked.set_fusion_enabled(fusion);
+        masked.set_active_elements(active);
+        GraphOutputs outputs = masked.execute();
+
+        std::vector<double> output = outputs.get_attribute_all_vector<double>("Output");
+        std::vector<float> copied_values = outputs.get_attribute_all_vector<float>("Copied");
+
+        REQUIRE(copy.elements == active.count());
+        copy.elements = 0;
+
+        for(std::size_t i = 0; i < values.size(); i++)
+        {
+            REQUIRE(output[i] == (mask[i] != 0.0f ? expected[i] : 0.0));
+            REQUIRE(copied_values[i] == (mask[i] != 0.0f ? values[i] : 0.0f));
+        }
+    }
+}
+
+TEST_CASE("Progress is reported a chunk at a time and ends with every node done", "")
+{
+    Graph graph;
+
+    // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output, with (A * A) also going to "Squared"
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    ConstantValue& one = graph.add_node<ConstantValue>();
+    one.set_value_single(1.0f);
+
+    ConstantValue& half = graph.add_node<ConstantValue>();
+    half.set_value_single(0.5f);
+
+    Math& square = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), square.input("A"));
+    graph.connect(a_input.output("Output"), square.input("B"));
+
+    Math& add_one = add_math(graph, MathOperation::add);
+    graph.connect(square.output("Output"), add_one.input("A"));
+    graph.connect(one.output("Value"), add_one.input("B"));
+
+    Math& halve = add_math(graph, MathOperation::multiply);
+    graph.connect(add_one.output("Output"), halve.input("A"));
+    graph.connect(half.output("Value"), halve.input("B"));
+
+    Math& add_a = add_math(graph, MathOperation::add);
+    graph.connect(halve.output("Output"), add_a.input("A"));
+    graph.connect(a_input.output("Output"), add_a.input("B"));
+
+    TypeConversion& to_double = graph.add_node<TypeConversion>();
+    to_double.set_type(TypeConversionTargetType::double_t);
+    graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(to_double.output("Output"), output.input("Input"));
+
+    GraphNode& squared_output = graph.add_attribute_output("Squared");
+    graph.connect(square.output("Output"), squared_output.input("Input"));
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    for(bool fusion : { true, false })
+    {
+        GraphExecutor executor(graph);
+        executor.set_fusion_enabled(fusion);
+
+        std::vector<ExecutionProgress> reports;
+        executor.set_progress_callback([&](const ExecutionProgress& progress) { reports.push_back(progress); });
+        executor.execute();
+
+        REQUIRE_FALSE(reports.empty());
+        REQUIRE(reports.back().nodes_completed == reports.back().node_count);
+
+        std::size_t chunk_reports = 0;
+        for(std::size_t i = 0; i < reports.size(); i++)
+        {
+            REQUIRE(reports[i].elements_processed <= reports[i].element_count);
+            if(i > 0)
+                REQUIRE(reports[i].nodes_completed >= reports[i - 1].nodes_completed);
+
+            if(reports[i].element_count == values.size() && reports[i].elements_processed < values.size())
+                chunk_reports++;
+        }
+
+        // Every element-wise node, fused or not, got part way before it finished
+        REQUIRE(chunk_reports > 0);
+    }
+}
+
+TEST_CASE("Progress counts the chunks that have no active elements", "")
+{
+    Graph graph;
+
+    // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output, with (A * A) also going to "Squared"
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    ConstantValue& one = graph.add_node<ConstantValue>();
+    one.set_value_single(1.0f);
+
+    ConstantValue& half = graph.add_node<ConstantValue>();
+    half.set_value_single(0.5f);
+
+    Math& square = add_math(graph, MathOperation::multiply);
+    graph.connect(a_input.output("Output"), square.input("A"));
+    graph.connect(a_input.output("Output"), square.input("B"));
+
+    Math& add_one = add_math(graph, MathOperation::add);
+    graph.connect(square.output("Output"), add_one.input("A"));
+    graph.connect(one.output("Value"), add_one.input("B"));
+
+    Math& halve = add_math(graph, MathOperation::multiply);
+    graph.connect(add_one.output("Output"), halve.input("A"));
+    graph.connect(half.output("Value"), halve.input("B"));
+
+    Math& add_a = add_math(graph, MathOperation::add);
+    graph.connect(halve.output("Output"), add_a.input("A"));
+    graph.connect(a_input.output("Output"), add_a.input("B"));
+
+    TypeConversion& to_double = graph.add_node<TypeConversion>();
+    to_double.set_type(TypeConversionTargetType::double_t);
+    graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(to_double.output("Output"), output.input("Input"));
+
+    GraphNode& squared_output = graph.add_attribute_output("Squared");
+    graph.connect(square.output("Output"), squared_output.input("Input"));
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    // Only the first chunk has anything to calculate
+    std::vector<float> mask(values.size(), 0.0f);
+    std::fill(mask.begin(), mask.begin() + 10, 1.0f);
+    ActiveElements active = ActiveElements::from_mask(mask.data(), mask.size());
+
+    for(bool fusion : { true, false })
+    {
+        GraphExecutor executor(graph);
+        executor.set_fusion_enabled(fusion);
+        executor.set_active_elements(active);
+
+        // A node's chunks are reported before nodes_completed moves on, so they share a key
+        std::map<std::pair<int, std::size_t>, std::vector<std::size_t>> processed;
+        executor.set_progress_callback([&](const ExecutionProgress& progress)
+        {
+            if(progress.element_count == values.size())
+                processed[std::make_pair(progress.node_id, progress.nodes_completed)].push_back(progress.elements_processed);
+        });
+        executor.execute();
+
+        std::size_t chunked_nodes = 0;
+        for(const auto& node : processed)
+        {
+            const std::vector<std::size_t>& reports = node.second;
+            if(reports.size() > 1)
+                chunked_nodes++;
+
+            // Every element has been counted by the time the node is done, not just the active ones
+            REQUIRE(std::is_sorted(reports.begin(), reports.end()));
+            REQUIRE(reports.back() == values.size());
+        }
+
+        REQUIRE(chunked_nodes > 0);
+    }
+}
+
+TEST_CASE("Cancelling stops an element-wise node part way through its attribute", "")
+{
+    Graph graph;
+    GraphNode& a_input = graph.add_attribute_input("A");
+
+    std::vector<float> values = make_values();
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    CountingCopy& copy = graph.add_node<CountingCopy>();
+    graph.connect(a_input.output("Output"), copy.input("Input"));
+    GraphNode& copied = graph.add_attribute_output("Copied");
+    graph.connect(copy.output("Output"), copied.input("Input"));
+
+    GraphExecutor executor(graph);
+    CancellationToken token;
+    executor.set_cancellation_token(token);
+    executor.set_progress_callback([&](const ExecutionProgress& progress)
+    {
+        if(progress.node_id == copy.id() && progress.elements_processed > 0)
+            token.cancel();
+    });
+
+    set_parallel_thread_count(1);
+    REQUIRE_THROWS_AS(executor.execute(), const ExecutionCancelled&);
+    set_parallel_thread_count(0);
+
+    REQUIRE(copy.elements == GraphExecutor::fusion_chunk_size);
+}
+
+TEST_CASE("Graphs can be executed in the background, several at once", "")
+{
+    std::vector<float> values = make_values();
+
+    std::vector<std::unique_ptr<Graph>> graphs;
+    std::vector<std::future<GraphOutputs>> futures;
+    for(int i = 0; i < 6; i++)
+    {
+        graphs.emplace_back(new Graph());
+        Graph& graph = *graphs.back();
+
+        // A -> (A * A) -> (+ 1) -> (* 0.5) -> (+ A) -> double -> Output
+        GraphNode& a_input = graph.add_attribute_input("A");
+
+        ConstantValue& one = graph.add_node<ConstantValue>();
+        one.set_value_single(1.0f);
+
+        ConstantValue& half = graph.add_node<ConstantValue>();
+        half.set_value_single(0.5f);
+
+        Math& square = add_math(graph, MathOperation::multiply);
+        graph.connect(a_input.output("Output"), square.input("A"));
+        graph.connect(a_input.output("Output"), square.input("B"));
+
+        Math& add_one = add_math(graph, MathOperation::add);
+        graph.connect(square.output("Output"), add_one.input("A"));
+        graph.connect(one.output("Value"), add_one.input("B"));
+
+        Math& halve = add_math(graph, MathOperation::multiply);
+        graph.connect(add_one.output("Output"), halve.input("A"));
+        graph.connect(half.output("Value"), halve.input("B"));
+
+        Math& add_a = add_math(graph, MathOperation::add);
+        graph.connect(halve.output("Output"), add_a.input("A"));
+        graph.connect(a_input.output("Output"), add_a.input("B"));
+
+        TypeConversion& to_double = graph.add_node<TypeConversion>();
+        to_double.set_type(TypeConversionTargetType::double_t);
+        graph.connect(add_a.output("Output"), to_double.input("Input"));
+
+        GraphNode& output = graph.add_attribute_output("Output");
+        graph.connect(to_double.output("Output"), output.input("Input"));
+
+        graphs.back()->set_input_attribute<float, 1>("A", &values[0], values.size());
+        futures.push_back(graphs.back()->execute_async());
+    }
+
+    std::vector<double> expected = graphs[0]->execute().get_attribute_all_vector<double>("Output");
+    for(std::future<GraphOutputs>& future : futures)
+    {
+        REQUIRE(future.get().get_attribute_all_vector<double>("Output") == expected);
+    }
+
+    GraphExecutor executor(*graphs[0]);
+    REQUIRE(executor.execute_async().get().get_attribute_all_vector<double>("Output") == expected);
+}
+
+TEST_CASE("Background executions share the background threads for their parallel work", "")
+{
+    std::vector<float> values;
+    for(std::size_t i = 0; i < GraphExecutor::fusion_chunk_size * 8; i++)
+    {
+        values.push_back(static_cast<float>(i));
+    }
+
+    set_parallel_thread_count(4);
+
+    recorded_threads.clear();
+
+    std::vector<std::unique_ptr<Graph>> graphs;
+    std::vector<std::future<GraphOutputs>> futures;
+    for(int i = 0; i < 8; i++)
+    {
+        graphs.emplace_back(new Graph());
+        Graph& graph = *graphs.back();
+        GraphNode& input = graph.add_attribute_input("A");
+        ThreadRecordingCopy& copy = graph.add_node<ThreadRecordingCopy>();
+        GraphNode& output = graph.add_attribute_output("Output");
+        graph.connect(input.output("Output"), copy.input("Input"));
+        graph.connect(copy.output("Output"), output.input("Input"));
+        graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+    }
+    for(std::unique_ptr<Graph>& graph : graphs)
+    {
+        futures.push_back(graph->execute_async());
+    }
+    for(std::future<GraphOutputs>& future : futures)
+    {
+        REQUIRE(future.get().get_attribute_all_vector<float>("Output") == values);
+    }
+
+    set_parallel_thread_count(0);
+
+    // Each execution's ranges ran on the background threads, none were made for them
+    REQUIRE_FALSE(recorded_threads.empty());
+    REQUIRE(recorded_threads.count(std::this_thread::get_id()) == 0);
+    REQUIRE(recorded_threads.size() <= std::max(std::thread::hardware_concurrency(), 1u));
+}
+
+TEST_CASE("Errors from a background execution come out of the future", "")
+{
+    Graph graph;
+    GraphNode& output = graph.add_attribute_output("Output");
+    Math& math = add_math(graph, MathOperation::add);
+    graph.connect(math.output("Output"), output.input("Input"));
+
+    std::future<GraphOutputs> future = graph.execute_async();
+    REQUIRE_THROWS_AS(future.get(), const std::logic_error&);
+}
@@ -0,0 +1,266 @@
+#include "catch.h"
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <nodes/blank_grid.h>
+#include <nodes/blur.h>
+#include <nodes/constant_value.h>
+#include <nodes/math.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/mappings/unit_square_mapping.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+TEST_CASE("A snapshot executes the same as the graph it was taken of, with the same node ids", "")
+{
+    // Output = blur((noise(p) + offset) * scale), with the offset a graph input
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(32, 24);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    GraphNode& offset = graph.add_uniform_input("Offset");
+    float offset_value = 0.25f;
+    graph.set_input_uniform<float, 1>("Offset", &offset_value);
+
+    Math& add = graph.add_node<Math>();
+    int add_operation = static_cast<int>(MathOperation::add);
+    add.property("Operation").set_value<int, 1>(&add_operation);
+    graph.connect(noise.output("Output"), add.input("A"));
+    graph.connect(offset.output("Output"), add.input("B"));
+
+    ConstantValue& scale = graph.add_node<ConstantValue>();
+    scale.set_value_single(2.0f);
+
+    Math& multiply = graph.add_node<Math>();
+    int multiply_operation = static_cast<int>(MathOperation::multiply);
+    multiply.property("Operation").set_value<int, 1>(&multiply_operation);
+    graph.connect(add.output("Output"), multiply.input("A"));
+    graph.connect(scale.output("Value"), multiply.input("B"));
+
+    Blur& blur = graph.add_node<Blur>();
+    blur.set_kernel(BlurKernel::custom);
+    blur.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+    graph.connect(multiply.output("Output"), blur.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(blur.output("Output"), output.input("Input"));
+
+    std::shared_ptr<const Graph> snapshot = graph.snapshot();
+
+    REQUIRE(snapshot->nodes().size() == graph.nodes().size());
+    REQUIRE(snapshot->connections().size() == graph.connections().size());
+    for(const GraphNode& node : graph.nodes())
+    {
+        const GraphNode& copy = *snapshot->get_node_by_id(node.id());
+        REQUIRE(&copy != &node);
+        REQUIRE(copy.node_name() == node.node_name());
+    }
+
+    std::vector<float> expected = graph.execute().get_attribute_all_vector<float>("Output");
+
+    GraphExecutor executor(*snapshot);
+    REQUIRE(executor.execute().get_attribute_all_vector<float>("Output") == expected);
+}
+
+TEST_CASE("Editing a graph doesn't change its snapshots", "")
+{
+    // Output = blur((noise(p) + offset) * scale), with the offset a graph input
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(32, 24);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    GraphNode& offset = graph.add_uniform_input("Offset");
+    float offset_value = 0.25f;
+    graph.set_input_uniform<float, 1>("Offset", &offset_value);
+
+    Math& add = graph.add_node<Math>();
+    int add_operation = static_cast<int>(MathOperation::add);
+    add.property("Operation").set_value<int, 1>(&add_operation);
+    graph.connect(noise.output("Output"), add.input("A"));
+    graph.connect(offset.output("Output"), add.input("B"));
+
+    ConstantValue& scale = graph.add_node<ConstantValue>();
+    scale.set_value_single(2.0f);
+
+    Math& multiply = graph.add_node<Math>();
+    int multiply_operation = static_cast<int>(MathOperation::multiply);
+    multiply.property("Operation").set_value<int, 1>(&multiply_operation);
+    graph.connect(add.output("Output"), multiply.input("A"));
+    graph.connect(scale.output("Value"), multiply.input("B"));
+
+    Blur& blur = graph.add_node<Blur>();
+    blur.set_kernel(BlurKernel::custom);
+    blur.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+    graph.connect(multiply.output("Output"), blur.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(blur.output("Output"), output.input("Input"));
+
+    std::vector<float> expected = graph.execute().get_attribute_all_vector<float>("Output");
+    std::shared_ptr<const Graph> snapshot = graph.snapshot();
+
+    // Properties, state that isn't a property, graph inputs and connections
+    grid.set_size(16, 16);
+    seed.set_value_single(9l);
+    scale.set_value_single(-1.0f);
+    blur.set_custom_kernel({ 1.0f });
+    offset_value = 10.0f;
+    graph.set_input_uniform<float, 1>("Offset", &offset_value);
+    graph.disconnect(blur.input("Input"));
+    graph.connect(noise.output("Output"), blur.input("Input"));
+
+    std::vector<float> edited = graph.execute().get_attribute_all_vector<float>("Output");
+    REQUIRE(edited.size() == 16 * 16);
+
+    GraphExecutor executor(*snapshot);
+    REQUIRE(executor.execute().get_attribute_all_vector<float>("Output") == expected);
+}
+
+TEST_CASE("A snapshot can be executed on another thread while the graph is edited", "")
+{
+    // Output = blur((noise(p) + offset) * scale), with the offset a graph input
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(32, 24);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    GraphNode& offset = graph.add_uniform_input("Offset");
+    float offset_value = 0.25f;
+    graph.set_input_uniform<float, 1>("Offset", &offset_value);
+
+    Math& add = graph.add_node<Math>();
+    int add_operation = static_cast<int>(MathOperation::add);
+    add.property("Operation").set_value<int, 1>(&add_operation);
+    graph.connect(noise.output("Output"), add.input("A"));
+    graph.connect(offset.output("Output"), add.input("B"));
+
+    ConstantValue& scale = graph.add_node<ConstantValue>();
+    scale.set_value_single(2.0f);
+
+    Math& multiply = graph.add_node<Math>();
+    int multiply_operation = static_cast<int>(MathOperation::multiply);
+    multiply.property("Operation").set_value<int, 1>(&multiply_operation);
+    graph.connect(add.output("Output"), multiply.input("A"));
+    graph.connect(scale.output("Value"), multiply.input("B"));
+
+    Blur& blur = graph.add_node<Blur>();
+    blur.set_kernel(BlurKernel::custom);
+    blur.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+    graph.connect(multiply.output("Output"), blur.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(blur.output("Output"), output.input("Input"));
+
+    std::vector<float> expected = graph.execute().get_attribute_all_vector<float>("Output");
+
+    std::shared_ptr<const Graph> snapshot = graph.snapshot();
+    std::vector<float> rendered;
+    std::thread render([snapshot, &rendered]()
+    {
+        for(int i = 0; i < 5; i++)
+        {
+            GraphExecutor executor(*snapshot);
+            rendered = executor.execute().get_attribute_all_vector<float>("Output");
+        }
+    });
+
+    std::future<GraphOutputs> background = graph.execute_async();
+
+    for(int i = 0; i < 100; i++)
+    {
+        scale.set_value_single(static_cast<float>(i));
+        seed.set_value_single(static_cast<long>(i));
+    }
+
+    render.join();
+    REQUIRE(rendered == expected);
+    REQUIRE(background.get().get_attribute_all_vector<float>("Output") == expected);
+}
+
+TEST_CASE("Nodes added by a pointer to their own type can be snapshotted", "")
+{
+    Graph graph;
+
+    std::unique_ptr<BlankGrid> grid(new BlankGrid());
+    grid->set_size(8, 6);
+    BlankGrid& grid_ref = *grid;
+    graph.add_node(std::move(grid));
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid_ref, mapping);
+
+    GraphNode& output = graph.add_attribute_output("Mapped");
+    graph.connect(mapping.output("Mapped"), output.input("Input"));
+
+    std::vector<float> expected = graph.execute().get_attribute_all_vector<float>("Mapped");
+    REQUIRE(graph.snapshot()->execute().get_attribute_all_vector<float>("Mapped") == expected);
+    REQUIRE(graph.execute_async().get().get_attribute_all_vector<float>("Mapped") == expected);
+}
+
+TEST_CASE("Nodes added as a plain GraphNode can't be snapshotted or executed in the background", "")
+{
+    Graph graph;
+    graph.add_node(std::unique_ptr<GraphNode>(new BlankGrid()));
+
+    REQUIRE_THROWS_AS(graph.snapshot(), const NodeNotCopyable&);
+
+    std::future<GraphOutputs> result = graph.execute_async();
+    REQUIRE_THROWS_AS(result.get(), const NodeNotCopyable&);
+}
+
+TEST_CASE("A snapshot has the graph's properties", "")
+{
+    Graph graph;
+    int value = 12;
+    graph.add_property<int, 1>("Octaves").set_value<int>(&value);
+
+    std::shared_ptr<const Graph> snapshot = graph.snapshot();
+
+    value = 3;
+    graph.get_property_by_name("Octaves")->get().set_value<int>(&value);
+
+    auto copy = snapshot->get_property_by_name("Octaves");
+    REQUIRE(copy);
+    int copied_value = copy->get().value<int, 1>()[0];
+    REQUIRE(copied_value == 12);
+}
@@ -304,3 +304,149 @@ TEST_CASE("Negation only takes one input.", "")
 
     REQUIRE(output == -1);
 }
+
+TEST_CASE("Uniform scalar minus an attribute array", "")
+{
+    Graph graph;
+
+    ConstantValue& value_node = graph.add_node<ConstantValue>();
+    value_node.set_value_single(10.0f);
+
+    Math& math_node = graph.add_node<Math>();
+
+    int operation = static_cast<int>(MathOperation::subtract);
+    math_node.property("Operation").set_value<int, 1>(&operation);
+
+    GraphNode& b_input = graph.add_attribute_input("B");
+    GraphNode& graph_output = graph.add_attribute_output("Output");
+
+    graph.connect(value_node.output("Value"), math_node.input("A"));
+    graph.connect(b_input.output("Output"), math_node.input("B"));
+    graph.connect(math_node.output("Output"), graph_output.input("Input"));
+
+    REQUIRE(math_node.output("Output").type() == SocketType::attribute);
+
+    std::vector<std::array<float, 2>> b_values;
+    for(int i = 0; i < 1000; i++)
+    {
+        b_values.push_back(std::array<float, 2> { static_cast<float>(i), static_cast<float>(i) * 0.5f });
+    }
+
+    graph.set_input_attribute<float, 2>("B", &b_values[0][0], b_values.size());
+
+    GraphOutputs outputs = graph.execute();
+
+    std::vector<float> out = outputs.get_attribute_all_vector<float>("Output");
+
+    REQUIRE(out.size() == 2000);
+    for(std::size_t i = 0; i < b_values.size(); i++)
+    {
+        REQUIRE(out[i * 2] == 10.0f - b_values[i][0]);
+        REQUIRE(out[i * 2 + 1] == 10.0f - b_values[i][1]);
+    }
+}
+
+TEST_CASE("Cross product of two vectors", "")
+{
+    Graph graph;
+
+    ConstantValue& value_1_node = graph.add_node<ConstantValue>();
+    ConstantValue& value_2_node = graph.add_node<ConstantValue>();
+
+    std::array<int, 3> value_1_value { 1, 0, 0 };
+    std::array<int, 3> value_2_value { 0, 1, 0 };
+    value_1_node.set_value(ptr_array<int, 3>(value_1_value));
+    value_2_node.set_value(ptr_array<int, 3>(value_2_value));
+
+    Math& math_node = graph.add_node<Math>();
+
+    int operation = static_cast<int>(MathOperation::cross);
+    math_node.property("Operation").set_value<int, 1>(&operation);
+
+    graph.connect(value_1_node.output("Value"), math_node.input("A"));
+    graph.connect(value_2_node.output("Value"), math_node.input("B"));
+
+    auto& graph_output_node = graph.add_uniform_output("Output");
+
+    graph.connect(math_node.output("Output"), graph_output_node.input("Input"));
+
+    GraphOutputs outputs = graph.execute();
+
+    const ptr_array<int, 3> out_value = outputs.get_uniform<int, 3>("Output");
+
+    REQUIRE(out_value[0] == 0);
+    REQUIRE(out_value[1] == 0);
+    REQUIRE(out_value[2] == 1);
+}
+
+TEST_CASE("Fast precision approximates sin on a float attribute", "")
+{
+    Graph graph;
+
+    GraphNode& a_input = graph.add_attribute_input("A");
+    GraphNode& graph_output = graph.add_attribute_output("Output");
+
+    Math& math_node = graph.add_node<Math>();
+    int operation = static_cast<int>(MathOperation::sin);
+    math_node.property("Operation").set_value<int, 1>(&operation);
+    int precision = static_cast<int>(MathPrecision::fast);
+    math_node.property("Precision").set_value<int, 1>(&precision);
+
+    graph.connect(a_input.output("Output"), math_node.input("A"));
+    graph.connect(math_node.output("Output"), graph_output.input("Input"));
+
+    std::vector<float> values;
+    for(int i = 0; i < 1000; i++)
+    {
+        values.push_back(static_cast<float>(i) * 0.05f - 25.0f);
+    }
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    GraphExecutor executor(graph);
+    std::vector<float> out = executor.execute().get_attribute_all_vector<float>("Output");
+
+    REQUIRE(out.size() == values.size());
+    for(std::size_t i = 0; i < values.size(); i++)
+    {
+        REQUIRE(std::abs(out[i] - std::sin(values[i])) < 1e-4f);
+    }
+}
+
+TEST_CASE("Fast precision falls back to the standard library for large sin and cos arguments", "")
+{
+    Graph graph;
+
+    GraphNode& a_input = graph.add_attribute_input("A");
+    GraphNode& sin_output = graph.add_attribute_output("Sin");
+    GraphNode& cos_output = graph.add_attribute_output("Cos");
+
+    int precision = static_cast<int>(MathPrecision::fast);
+
+    Math& sin_node = graph.add_node<Math>();
+    int sin_operation = static_cast<int>(MathOperation::sin);
+    sin_node.property("Operation").set_value<int, 1>(&sin_operation);
+    sin_node.property("Precision").set_value<int, 1>(&precision);
+
+    Math& cos_node = graph.add_node<Math>();
+    int cos_operation = static_cast<int>(MathOperation::cos);
+    cos_node.property("Operation").set_value<int, 1>(&cos_operation);
+    cos_node.property("Precision").set_value<int, 1>(&precision);
+
+    graph.connect(a_input.output("Output"), sin_node.input("A"));
+    graph.connect(a_input.output("Output"), cos_node.input("A"));
+    graph.connect(sin_node.output("Output"), sin_output.input("Input"));
+    graph.connect(cos_node.output("Output"), cos_output.input("Input"));
+
+    std::vector<float> values { 1.0f, 1e5f, -1e5f, 123456.7f, 1e6f, -1e6f, 1e7f, 1e9f, -1e9f, 3e38f };
+    graph.set_input_attribute<float, 1>("A", &values[0], values.size());
+
+    GraphOutputs outputs = graph.execute();
+    std::vector<float> sin_out = outputs.get_attribute_all_vector<float>("Sin");
+    std::vector<float> cos_out = outputs.get_attribute_all_vector<float>("Cos");
+
+    for(std::size_t i = 0; i < values.size(); i++)
+    {
+        REQUIRE(std::abs(sin_out[i] - std::sin(values[i])) < 1e-4f);
+        REQUIRE(std::abs(cos_out[i] - std::cos(values[i])) < 1e-4f);
+    }
+}
@@ -0,0 +1,245 @@
+#include "catch.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <nodes/blank_grid.h>
+#include <nodes/constant_value.h>
+#include <nodes/expression.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/mappings/pixel_mapping.h>
+#include <nodes/mappings/unit_square_mapping.h>
+#include <nodes/mappings/unit_cube_mapping.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+TEST_CASE("A box mip chain filters each level down to 1x1, centred on every other pixel", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(10, 7);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output.input("Input"));
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+    outputs.build_mip_chain("Output");
+
+    // 10x7, 5x4, 3x2, 2x1, 1x1
+    REQUIRE(outputs.mip_levels("Output") == 5);
+    REQUIRE(outputs.mip_attribute_info("Output", 1).grid().extent(0) == 5);
+    REQUIRE(outputs.mip_attribute_info("Output", 1).grid().extent(1) == 4);
+    REQUIRE(outputs.mip_attribute_info("Output", 1).grid().stride() == 2);
+    REQUIRE(outputs.mip_attribute_info("Output", 2).grid().extent(0) == 3);
+    REQUIRE(outputs.mip_attribute_info("Output", 2).grid().stride() == 4);
+    REQUIRE(outputs.mip_attribute_info("Output", 4).length() == 1);
+
+    std::vector<float> base = outputs.get_mip_vector<float>("Output", 0);
+    std::vector<float> level = outputs.get_mip_vector<float>("Output", 1);
+    REQUIRE(level.size() == 5 * 4 * 2);
+
+    // 1/4, 1/2, 1/4 along each axis around pixel (2x, 2y), repeating the edge pixels
+    const float weights[3] = { 0.25f, 0.5f, 0.25f };
+    for(int y = 0; y < 4; y++)
+    {
+        for(int x = 0; x < 5; x++)
+        {
+            for(int channel = 0; channel < 2; channel++)
+            {
+                float expected = 0.0f;
+                for(int dy = -1; dy <= 1; dy++)
+                {
+                    for(int dx = -1; dx <= 1; dx++)
+                    {
+                        int source_y = std::min(std::max(y * 2 + dy, 0), 6);
+                        int source_x = std::min(std::max(x * 2 + dx, 0), 9);
+                        expected += weights[dy + 1] * weights[dx + 1] * base[(source_y * 10 + source_x) * 2 + channel];
+                    }
+                }
+                REQUIRE(level[(y * 5 + x) * 2 + channel] == Approx(expected));
+            }
+        }
+    }
+
+    REQUIRE_THROWS_AS(outputs.get_mip_buffer("Output", 5), const std::out_of_range&);
+}
+
+TEST_CASE("A gaussian mip chain keeps a flat image flat", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(33, 17);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    Expression& flat = graph.add_node<Expression>();
+    flat.set_expression("p.x*0 + 2.5");
+    graph.connect(mapping.output("Mapped"), flat.input("p"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(flat.output("Output"), output.input("Input"));
+
+    GraphOutputs outputs = graph.execute();
+    outputs.build_mip_chain("Output", 3, MipFilter::gaussian);
+
+    REQUIRE(outputs.mip_levels("Output") == 3);
+
+    std::vector<float> level = outputs.get_mip_vector<float>("Output", 2);
+    REQUIRE(level.size() == 9 * 5);
+    for(float value : level)
+    {
+        REQUIRE(value == Approx(2.5f));
+    }
+}
+
+TEST_CASE("A gaussian mip level of a linear ramp is the ramp at the pixels a strided render has, in every channel", "")
+{
+    const int width = 24, height = 16;
+
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output.input("Input"));
+
+    GraphOutputs outputs = graph.execute();
+    outputs.build_mip_chain("Output", 2, MipFilter::gaussian);
+
+    std::vector<float> base = outputs.get_mip_vector<float>("Output", 0);
+    std::vector<float> level = outputs.get_mip_vector<float>("Output", 1);
+    REQUIRE(level.size() == (width / 2) * (height / 2) * 2);
+
+    // Away from the clamped edges
+    for(int y = 1; y < height / 2 - 1; y++)
+    {
+        for(int x = 1; x < width / 2 - 1; x++)
+        {
+            int index = (y * (width / 2) + x) * 2;
+            int base_index = (y * 2 * width + x * 2) * 2;
+            REQUIRE(level[index] == Approx(base[base_index]));
+            REQUIRE(level[index + 1] == Approx(base[base_index + 1]));
+        }
+    }
+}
+
+TEST_CASE("A strided grid renders every other pixel of the full size render", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(9, 6);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(noise.output("Output"), output.input("Input"));
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+    std::vector<float> full = outputs.get_attribute_all_vector<float>("Output");
+
+    grid.set_stride(2);
+    GraphExecutor level_executor(graph);
+    outputs.set_mip_level("Output", 1, level_executor.execute());
+
+    REQUIRE(outputs.mip_levels("Output") == 2);
+    REQUIRE(outputs.mip_attribute_info("Output", 1).grid().extent(0) == 5);
+    REQUIRE(outputs.mip_attribute_info("Output", 1).grid().extent(1) == 3);
+
+    std::vector<float> level = outputs.get_mip_vector<float>("Output", 1);
+    for(int y = 0; y < 3; y++)
+    {
+        for(int x = 0; x < 5; x++)
+        {
+            REQUIRE(level[y * 5 + x] == full[(y * 2) * 9 + x * 2]);
+        }
+    }
+
+    REQUIRE_THROWS_AS(outputs.set_mip_level("Output", 3, graph.execute()), const std::invalid_argument&);
+
+    // Level 2 of a 9x6 grid is 3x2
+    REQUIRE_THROWS_AS(outputs.set_mip_level("Output", 2, level_executor.execute()), const std::invalid_argument&);
+    REQUIRE(outputs.mip_levels("Output") == 2);
+}
+
+TEST_CASE("Pixel mapping of a strided grid gives the full grid's pixels", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(7, 5);
+    grid.set_stride(3);
+
+    PixelMapping& mapping = graph.add_node<PixelMapping>();
+    graph.connect(grid, mapping);
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output.input("Input"));
+
+    std::vector<int> mapped = graph.execute().get_attribute_all_vector<int>("Output");
+    REQUIRE(mapped.size() == 3 * 2 * 2);
+
+    for(int y = 0; y < 2; y++)
+    {
+        for(int x = 0; x < 3; x++)
+        {
+            REQUIRE(mapped[(y * 3 + x) * 2] == x * 3);
+            REQUIRE(mapped[(y * 3 + x) * 2 + 1] == y * 3);
+        }
+    }
+}
+
+TEST_CASE("Only whole 2D float grids have mip chains", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(4, 4);
+
+    PixelMapping& mapping = graph.add_node<PixelMapping>();
+    graph.connect(grid, mapping);
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(mapping.output("Mapped"), output.input("Input"));
+
+    GraphOutputs outputs = graph.execute();
+    REQUIRE_THROWS_AS(outputs.build_mip_chain("Output"), const std::invalid_argument&);
+
+    Graph volume_graph;
+    BlankGrid& volume = volume_graph.add_node<BlankGrid>();
+    volume.set_size(4, 4, 4);
+
+    UnitCubeMapping& volume_mapping = volume_graph.add_node<UnitCubeMapping>();
+    volume_graph.connect(volume, volume_mapping);
+
+    GraphNode& volume_output = volume_graph.add_attribute_output("Output");
+    volume_graph.connect(volume_mapping.output("Mapped"), volume_output.input("Input"));
+
+    GraphOutputs volume_outputs = volume_graph.execute();
+    REQUIRE_THROWS_AS(volume_outputs.build_mip_chain("Output"), const std::logic_error&);
+}
@@ -0,0 +1,141 @@
+#include "catch.h"
+
+#include <cmath>
+
+#include <nodes/normal_map.h>
+#include <nodes/blank_grid.h>
+#include <nodes/expression.h>
+#include <nodes/mappings/unit_square_mapping.h>
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+TEST_CASE("NormalMap adds and removes the optional outputs", "")
+{
+    NormalMap normal_map;
+    REQUIRE(normal_map.outputs().get_by_name("Normal"));
+    REQUIRE_FALSE(normal_map.outputs().get_by_name("Slope"));
+    REQUIRE_FALSE(normal_map.outputs().get_by_name("Curvature"));
+
+    normal_map.set_output_slope(true);
+    normal_map.set_output_curvature(true);
+    REQUIRE(normal_map.outputs().get_by_name("Slope"));
+    REQUIRE(normal_map.outputs().get_by_name("Curvature"));
+
+    normal_map.set_output_slope(false);
+    REQUIRE_FALSE(normal_map.outputs().get_by_name("Slope"));
+    REQUIRE(normal_map.outputs().get_by_name("Curvature"));
+}
+
+TEST_CASE("NormalMap gives a plane the same normal everywhere, edges included", "")
+{
+    const int width = 41, height = 27;
+
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    Expression& plane = graph.add_node<Expression>();
+    plane.set_expression("p.x*3 + p.y*2");
+    graph.connect(mapping.output("Mapped"), plane.input("p"));
+
+    NormalMap& normal_map = graph.add_node<NormalMap>();
+    normal_map.set_output_slope(true);
+    normal_map.set_output_curvature(true);
+    normal_map.set_strength(0.5f);
+    graph.connect(plane.output("Output"), normal_map.input("Height"));
+
+    GraphNode& normal_output = graph.add_attribute_output("Normal");
+    graph.connect(normal_map.output("Normal"), normal_output.input("Input"));
+
+    GraphNode& slope_output = graph.add_attribute_output("Slope");
+    graph.connect(normal_map.output("Slope"), slope_output.input("Input"));
+
+    GraphNode& curvature_output = graph.add_attribute_output("Curvature");
+    graph.connect(normal_map.output("Curvature"), curvature_output.input("Input"));
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+
+    std::vector<float> normals = outputs.get_attribute_all_vector<float>("Normal");
+    std::vector<float> slopes = outputs.get_attribute_all_vector<float>("Slope");
+    std::vector<float> curvatures = outputs.get_attribute_all_vector<float>("Curvature");
+
+    REQUIRE(normals.size() == static_cast<std::size_t>(width * height * 3));
+
+    // UnitSquareMapping steps p by 2/width along x and 2/height along y for each pixel
+    double dx = 0.5 * 3.0 * 2.0 / width;
+    double dy = 0.5 * 2.0 * 2.0 / height;
+    double length = std::sqrt(dx * dx + dy * dy + 1.0);
+
+    for(int i = 0; i < width * height; i++)
+    {
+        REQUIRE(normals[i * 3] == Approx(-dx / length).epsilon(0.0001));
+        REQUIRE(normals[i * 3 + 1] == Approx(-dy / length).epsilon(0.0001));
+        REQUIRE(normals[i * 3 + 2] == Approx(1.0 / length).epsilon(0.0001));
+        REQUIRE(slopes[i] == Approx(std::sqrt(dx * dx + dy * dy)).epsilon(0.0001));
+        REQUIRE(std::abs(curvatures[i]) < 0.0001);
+    }
+}
+
+TEST_CASE("NormalMap curvature is the laplacian and normals lean into a bowl", "")
+{
+    const int width = 41, height = 27;
+
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    Expression& bowl = graph.add_node<Expression>();
+    bowl.set_expression("p.x*p.x + p.y*p.y");
+    graph.connect(mapping.output("Mapped"), bowl.input("p"));
+
+    NormalMap& normal_map = graph.add_node<NormalMap>();
+    normal_map.set_output_curvature(true);
+    normal_map.set_spacing(2.0f);
+    graph.connect(bowl.output("Output"), normal_map.input("Height"));
+
+    GraphNode& normal_output = graph.add_attribute_output("Normal");
+    graph.connect(normal_map.output("Normal"), normal_output.input("Input"));
+
+    GraphNode& curvature_output = graph.add_attribute_output("Curvature");
+    graph.connect(normal_map.output("Curvature"), curvature_output.input("Input"));
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+
+    std::vector<float> normals = outputs.get_attribute_all_vector<float>("Normal");
+    std::vector<float> curvatures = outputs.get_attribute_all_vector<float>("Curvature");
+
+    // The second difference of p.x^2 is 2 * (2/width)^2 per pixel, over a spacing of 2
+    double expected = (2.0 * (2.0 / width) * (2.0 / width) + 2.0 * (2.0 / height) * (2.0 / height)) / 4.0;
+
+    for(int i = 0; i < width * height; i++)
+    {
+        REQUIRE(curvatures[i] == Approx(expected).epsilon(0.001));
+    }
+
+    // A bowl, so the normals lean towards the middle: +x on the left edge and -x on the right
+    std::size_t left = (height / 2) * width;
+    std::size_t right = left + width - 1;
+    REQUIRE(normals[left * 3] > 0.0f);
+    REQUIRE(normals[right * 3] < 0.0f);
+
+    for(int i = 0; i < width * height; i++)
+    {
+        double length = std::sqrt(normals[i * 3] * normals[i * 3] + normals[i * 3 + 1] * normals[i * 3 + 1] + normals[i * 3 + 2] * normals[i * 3 + 2]);
+        REQUIRE(length == Approx(1.0).epsilon(0.0001));
+    }
+}
@@ -27,6 +27,40 @@ TEST_CASE("Getting permutations of hypercube", "")
     REQUIRE(perm_5.size() == 80);
 }
 
+TEST_CASE("Hypercube tables are generated at compile time", "")
+{
+    static_assert(HypercubeEdges<3>::count == 12, "3d hypercube has 12 edges");
+    static_assert(HypercubeEdges<3>::value(0, 0) == 0, "First edges have 0 in the first component");
+    static_assert(HypercubeEdges<3>::value(0, 1) == -1, "Components count up from -1");
+    static_assert(HypercubeCorners<4>::count == 16, "4d hypercube has 16 vertices");
+    static_assert(HypercubeCorners<3>::value(1, 2) == 1, "Adjacent vertices differ in the last component");
+
+    std::vector<std::array<signed char, 4>> edges = HypercubeEdges<4>::edge_vectors();
+    for(std::size_t i = 0; i < edges.size(); i++)
+    {
+        int zeros = 0;
+        for(signed char component : edges[i])
+        {
+            REQUIRE((component == 0 || component == 1 || component == -1));
+            if(component == 0)
+                zeros++;
+        }
+        REQUIRE(zeros == 1);
+
+        for(std::size_t j = 0; j < i; j++)
+        {
+            REQUIRE(edges[i] != edges[j]);
+        }
+    }
+
+    const unsigned char* corners = HypercubeCorners<3>::flattened();
+    for(std::size_t i = 0; i < HypercubeCorners<3>::count; i++)
+    {
+        int decoded = corners[i * 3] * 4 + corners[i * 3 + 1] * 2 + corners[i * 3 + 2];
+        REQUIRE(decoded == static_cast<int>(i));
+    }
+}
+
 TEST_CASE("Basic 2-dimensional noise", "")
 {
     Graph graph;
@@ -72,3 +106,188 @@ TEST_CASE("Basic 2-dimensional noise", "")
 
     REQUIRE_FALSE(has_all_zeros);
 }
+
+TEST_CASE("Perlin noise gradient matches finite differences", "")
+{
+    Graph graph;
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    noise.set_output_gradient(true);
+
+    GraphNode& points_input = graph.add_attribute_input("Points");
+    GraphNode& output_node = graph.add_attribute_output("Output");
+    GraphNode& gradient_node = graph.add_attribute_output("Gradient");
+
+    graph.connect(seed, noise, "Seed");
+    graph.connect(points_input, noise, "Points");
+
+    graph.connect(noise, "Output", output_node);
+    graph.connect(noise, "Gradient", gradient_node);
+
+    const float h = 0.001f;
+    std::vector<std::array<float, 2>> samples { { 0.3f, 0.7f }, { 1.45f, -2.2f }, { -3.6f, 4.1f }, { 7.25f, 0.5f } };
+
+    // Each sample is followed by its x/y neighbours so the central difference can be taken from a single execution
+    std::vector<std::array<float, 2>> points;
+    for(auto& sample : samples)
+    {
+        points.push_back(sample);
+        points.push_back(std::array<float, 2> { sample[0] + h, sample[1] });
+        points.push_back(std::array<float, 2> { sample[0] - h, sample[1] });
+        points.push_back(std::array<float, 2> { sample[0], sample[1] + h });
+        points.push_back(std::array<float, 2> { sample[0], sample[1] - h });
+    }
+
+    graph.set_input_attribute<float, 2>("Points", &points[0][0], points.size());
+
+    GraphOutputs outputs = graph.execute();
+
+    std::vector<float> values = outputs.get_attribute_all_vector<float>("Output");
+    std::vector<float> gradients = outputs.get_attribute_all_vector<float>("Gradient");
+
+    REQUIRE(gradients.size() == points.size() * 2);
+
+    for(std::size_t i = 0; i < samples.size(); i++)
+    {
+        std::size_t base = i * 5;
+
+        float dx = (values[base + 1] - values[base + 2]) / (2 * h);
+        float dy = (values[base + 3] - values[base + 4]) / (2 * h);
+
+        REQUIRE(gradients[base * 2] == Approx(dx).epsilon(0.01));
+        REQUIRE(gradients[base * 2 + 1] == Approx(dy).epsilon(0.01));
+    }
+}
+
+TEST_CASE("Perlin noise gradient output can be turned off", "")
+{
+    PerlinNoise noise;
+
+    REQUIRE_FALSE(noise.outputs().get_by_name("Gradient"));
+
+    noise.set_output_gradient(true);
+    REQUIRE(noise.outputs().get_by_name("Gradient"));
+
+    noise.set_output_gradient(false);
+    REQUIRE_FALSE(noise.outputs().get_by_name("Gradient"));
+}
+
+TEST_CASE("Perlin noise with a period tiles", "")
+{
+    Graph graph;
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(11l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    noise.set_period(4);
+
+    GraphNode& points_input = graph.add_attribute_input("Points");
+    GraphNode& output_node = graph.add_attribute_output("Output");
+
+    graph.connect(seed, noise, "Seed");
+    graph.connect(points_input, noise, "Points");
+    graph.connect(noise, output_node);
+
+    std::vector<std::array<float, 2>> samples { { 0.3f, 0.7f }, { 1.45f, 2.2f }, { 3.6f, 0.1f }, { 2.25f, 3.5f } };
+
+    // Each sample, then shifted by one period in x, in y, and backwards in both
+    std::vector<std::array<float, 2>> points;
+    for(auto& sample : samples)
+    {
+        points.push_back(sample);
+        points.push_back(std::array<float, 2> { sample[0] + 4, sample[1] });
+        points.push_back(std::array<float, 2> { sample[0], sample[1] + 4 });
+        points.push_back(std::array<float, 2> { sample[0] - 8, sample[1] - 4 });
+    }
+
+    graph.set_input_attribute<float, 2>("Points", &points[0][0], points.size());
+
+    GraphOutputs outputs = graph.execute();
+
+    std::vector<float> values = outputs.get_attribute_all_vector<float>("Output");
+
+    for(std::size_t i = 0; i < samples.size(); i++)
+    {
+        std::size_t base = i * 4;
+
+        REQUIRE(values[base + 1] == Approx(values[base]).epsilon(0.0001));
+        REQUIRE(values[base + 2] == Approx(values[base]).epsilon(0.0001));
+        REQUIRE(values[base + 3] == Approx(values[base]).epsilon(0.0001));
+    }
+}
+
+TEST_CASE("Perlin noise keeps precision for large coordinates with double points or a lattice offset", "")
+{
+    const long long offset_x = 3000000000ll;
+    const long long offset_y = -7000000ll;
+
+    std::vector<std::array<float, 2>> local_points { { 0.3f, 0.7f }, { 0.45f, 0.2f }, { 0.6f, 0.1f }, { 0.25f, 0.5f } };
+
+    std::vector<std::array<double, 2>> world_points;
+    for(auto& point : local_points)
+    {
+        world_points.push_back(std::array<double, 2> { offset_x + static_cast<double>(point[0]), offset_y + static_cast<double>(point[1]) });
+    }
+
+    // Double precision world coordinates
+    Graph world_graph;
+    {
+        ConstantValue& seed = world_graph.add_node<ConstantValue>();
+        seed.set_value_single(9l);
+
+        PerlinNoise& noise = world_graph.add_node<PerlinNoise>();
+
+        GraphNode& points_input = world_graph.add_attribute_input("Points");
+        GraphNode& output_node = world_graph.add_attribute_output("Output");
+
+        world_graph.connect(seed, noise, "Seed");
+        world_graph.connect(points_input, noise, "Points");
+        world_graph.connect(noise, output_node);
+
+        world_graph.set_input_attribute<double, 2>("Points", &world_points[0][0], world_points.size());
+    }
+
+    // Float local coordinates plus an integer offset
+    Graph local_graph;
+    {
+        ConstantValue& seed = local_graph.add_node<ConstantValue>();
+        seed.set_value_single(9l);
+
+        std::array<long long, 2> offset_value { offset_x, offset_y };
+        ConstantValue& offset = local_graph.add_node<ConstantValue>();
+        offset.set_value<long long, 2>(offset_value);
+
+        PerlinNoise& noise = local_graph.add_node<PerlinNoise>();
+
+        GraphNode& points_input = local_graph.add_attribute_input("Points");
+        GraphNode& output_node = local_graph.add_attribute_output("Output");
+
+        local_graph.connect(seed, noise, "Seed");
+        local_graph.connect(offset, noise, "Offset");
+        local_graph.connect(points_input, noise, "Points");
+        local_graph.connect(noise, output_node);
+
+        local_graph.set_input_attribute<float, 2>("Points", &local_points[0][0], local_points.size());
+    }
+
+    std::vector<float> world_values = world_graph.execute().get_attribute_all_vector<float>("Output");
+    std::vector<float> local_values = local_graph.execute().get_attribute_all_vector<float>("Output");
+
+    REQUIRE(world_values.size() == local_points.size());
+
+    bool all_same = true;
+    for(std::size_t i = 0; i < local_points.size(); i++)
+    {
+        REQUIRE(world_values[i] == Approx(local_values[i]).epsilon(0.0001));
+
+        if(world_values[i] != world_values[0])
+            all_same = false;
+    }
+
+    // If the fractional part had collapsed every point would land on the same lattice vertex
+    REQUIRE_FALSE(all_same);
+}
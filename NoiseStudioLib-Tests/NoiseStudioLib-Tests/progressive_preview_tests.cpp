@@ -0,0 +1,281 @@
+#include "catch.h"
+
+#include <vector>
+
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <progressive_preview.h>
+#include <cancellation_token.h>
+#include <composite_data_buffer.h>
+#include <nodes/blank_grid.h>
+#include <nodes/constant_value.h>
+#include <nodes/math.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/mappings/unit_square_mapping.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+namespace
+{
+    // Squares a uniform float and counts how often it was executed, by any copy of it
+    class CountingSquare : public GraphNode
+    {
+    public:
+        CountingSquare()
+        {
+            input_ = &inputs().add("Input", SocketType::uniform);
+            input_->set_accepts(ConnectionDataType::value<float, 1>());
+            output_ = &outputs().add("Output", ConnectionDataType::value<float, 1>(), SocketType::uniform);
+        }
+
+        std::string node_name() const { return "Counting Square"; }
+
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const
+        {
+            executions++;
+            float value = input.get_uniform<float, 1>(*input_)[0];
+            value *= value;
+            output.set_uniform<float, 1>(*output_, &value);
+        }
+
+        bool is_pure() const { return true; }
+
+        static int executions;
+
+    private:
+        InputSocket* input_;
+        OutputSocket* output_;
+    };
+
+    int CountingSquare::executions = 0;
+}
+
+TEST_CASE("A progressive preview renders coarse to fine over the same area", "")
+{
+    const unsigned int width = 100, height = 60;
+
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(width, height);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    GraphNode& mapped_output = graph.add_attribute_output("Mapped");
+    graph.connect(mapping.output("Mapped"), mapped_output.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(noise.output("Output"), output.input("Input"));
+
+    GraphOutputs full = graph.execute();
+    std::vector<float> full_mapped = full.get_attribute_all_vector<float>("Mapped");
+    std::vector<float> full_output = full.get_attribute_all_vector<float>("Output");
+
+    ProgressivePreview preview(graph);
+    std::vector<unsigned int> passes;
+
+    bool finished = preview.render(CancellationToken(), [&](unsigned int stride, GraphOutputs& outputs)
+    {
+        passes.push_back(stride);
+
+        GridInfo grid = outputs.attribute_info("Output").grid();
+        unsigned int pass_width = (width + stride - 1) / stride;
+        unsigned int pass_height = (height + stride - 1) / stride;
+        REQUIRE(grid.extent(0) == pass_width);
+        REQUIRE(grid.extent(1) == pass_height);
+        REQUIRE(grid.stride() == stride);
+
+        std::vector<float> mapped = outputs.get_attribute_all_vector<float>("Mapped");
+        std::vector<float> output = outputs.get_attribute_all_vector<float>("Output");
+
+        for(unsigned int y = 0; y < pass_height; y++)
+        {
+            for(unsigned int x = 0; x < pass_width; x++)
+            {
+                std::size_t index = y * pass_width + x;
+                std::size_t full_index = (y * stride) * width + x * stride;
+
+                // The same coordinates exactly, not just close
+                REQUIRE(mapped[index * 2] == full_mapped[full_index * 2]);
+                REQUIRE(mapped[index * 2 + 1] == full_mapped[full_index * 2 + 1]);
+                REQUIRE(output[index] == Approx(full_output[full_index]));
+            }
+        }
+    });
+
+    REQUIRE(finished);
+    REQUIRE(passes == std::vector<unsigned int>({ 8, 4, 2, 1 }));
+
+    // The executor goes back to full size afterwards
+    REQUIRE(preview.executor().grid_stride() == 1);
+}
+
+TEST_CASE("Cancelling a progressive preview stops the finer passes", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(64, 64);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(noise.output("Output"), output.input("Input"));
+
+    ProgressivePreview preview(graph);
+    CancellationToken token;
+    std::vector<unsigned int> passes;
+
+    bool finished = preview.render(token, [&](unsigned int stride, GraphOutputs&)
+    {
+        passes.push_back(stride);
+
+        // e.g. the user dragged a slider again
+        token.cancel();
+    });
+
+    REQUIRE_FALSE(finished);
+    REQUIRE(passes == std::vector<unsigned int>({ 8 }));
+
+    // A new token starts a new render
+    passes.clear();
+    REQUIRE(preview.render(CancellationToken(), [&](unsigned int stride, GraphOutputs&) { passes.push_back(stride); }));
+    REQUIRE(passes.size() == 4);
+}
+
+TEST_CASE("An executor stops with ExecutionCancelled once its token is cancelled", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(64, 64);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(noise.output("Output"), output.input("Input"));
+
+    GraphExecutor executor(graph);
+    CancellationToken token;
+    executor.set_cancellation_token(token);
+
+    REQUIRE_NOTHROW(executor.execute());
+
+    token.cancel();
+    REQUIRE_THROWS_AS(executor.execute(), const ExecutionCancelled&);
+
+    executor.clear_cancellation_token();
+    REQUIRE(executor.execute().attribute_info("Output").length() == 64 * 64);
+}
+
+TEST_CASE("A progressive preview renders a snapshot, so the graph can be edited part way through", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(32, 32);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& scale = graph.add_node<ConstantValue>();
+    scale.set_value_single(2.0f);
+
+    Math& multiply = graph.add_node<Math>();
+    int operation = static_cast<int>(MathOperation::multiply);
+    multiply.property("Operation").set_value<int, 1>(&operation);
+    graph.connect(mapping.output("Mapped"), multiply.input("A"));
+    graph.connect(scale.output("Value"), multiply.input("B"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(multiply.output("Output"), output.input("Input"));
+
+    ProgressivePreview preview(graph);
+    std::vector<float> first_values;
+
+    // The first pixel is mapped to (-1, -1)
+    REQUIRE(preview.render(CancellationToken(), [&](unsigned int, GraphOutputs& outputs)
+    {
+        first_values.push_back(outputs.get_attribute_all_vector<float>("Output")[0]);
+        scale.set_value_single(4.0f);
+    }));
+    REQUIRE(first_values == std::vector<float>({ -2.0f, -2.0f, -2.0f, -2.0f }));
+
+    // The next render picks the change up
+    first_values.clear();
+    REQUIRE(preview.render(CancellationToken(), [&](unsigned int, GraphOutputs& outputs)
+    {
+        first_values.push_back(outputs.get_attribute_all_vector<float>("Output")[0]);
+    }));
+    REQUIRE(first_values == std::vector<float>({ -4.0f, -4.0f, -4.0f, -4.0f }));
+}
+
+TEST_CASE("Folded constants carry over from one progressive preview render to the next", "")
+{
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(16, 16);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& value = graph.add_node<ConstantValue>();
+    value.set_value_single(3.0f);
+
+    CountingSquare& square = graph.add_node<CountingSquare>();
+    graph.connect(value.output("Value"), square.input("Input"));
+
+    Math& multiply = graph.add_node<Math>();
+    int operation = static_cast<int>(MathOperation::multiply);
+    multiply.property("Operation").set_value<int, 1>(&operation);
+    graph.connect(mapping.output("Mapped"), multiply.input("A"));
+    graph.connect(square.output("Output"), multiply.input("B"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(multiply.output("Output"), output.input("Input"));
+
+    ProgressivePreview preview(graph);
+    CountingSquare::executions = 0;
+
+    // Each render has a snapshot of its own, but the square is only worked out once
+    REQUIRE(preview.render(CancellationToken(), [](unsigned int, GraphOutputs&) { }));
+    REQUIRE(preview.render(CancellationToken(), [](unsigned int, GraphOutputs&) { }));
+    REQUIRE(CountingSquare::executions == 1);
+
+    value.set_value_single(5.0f);
+    float first_value = 0.0f;
+    REQUIRE(preview.render(CancellationToken(), [&](unsigned int, GraphOutputs& outputs)
+    {
+        first_value = outputs.get_attribute_all_vector<float>("Output")[0];
+    }));
+    REQUIRE(CountingSquare::executions == 2);
+    REQUIRE(first_value == -25.0f);
+}
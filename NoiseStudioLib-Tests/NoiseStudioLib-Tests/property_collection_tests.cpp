@@ -2,6 +2,8 @@
 
 #include <property_collection.h>
 
+#include <memory>
+
 using namespace noises;
 
 TEST_CASE("Can instantiate property collection", "")
@@ -65,3 +67,24 @@ TEST_CASE("Can add multiple properties of different types from property collecti
         REQUIRE(float_prop->get().name() == "float3");
     }
 }
+
+TEST_CASE("Moved property collections still report their properties' changes", "")
+{
+    std::unique_ptr<PropertyCollection> original(new PropertyCollection());
+    Property& prop = original->add<int, 1>("int");
+
+    PropertyCollection moved(std::move(*original));
+    original.reset();
+
+    int changes = 0;
+    moved.listen_changed([&changes](Property&) { changes++; });
+
+    int value = 4;
+    prop.set_value<int>(&value);
+    REQUIRE(changes == 1);
+
+    PropertyCollection assigned;
+    assigned = std::move(moved);
+    prop.set_value<int>(&value);
+    REQUIRE(changes == 2);
+}
@@ -0,0 +1,210 @@
+#include "catch.h"
+
+#include <cmath>
+
+#include <nodes/reduce.h>
+#include <nodes/histogram.h>
+#include <nodes/math.h>
+#include <nodes/constant_value.h>
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <parallel.h>
+
+using namespace noises;
+using namespace noises::nodes;
+
+namespace
+{
+    Math& add_math(Graph& graph, MathOperation operation)
+    {
+        Math& math = graph.add_node<Math>();
+        int value = static_cast<int>(operation);
+        math.property("Operation").set_value<int, 1>(&value);
+        return math;
+    }
+
+    // Several chunks worth of values, the last one partial
+    std::vector<float> make_heights()
+    {
+        std::vector<float> heights;
+        for(std::size_t i = 0; i < Reduce::chunk_size * 5 + 321; i++)
+        {
+            heights.push_back(std::sin(static_cast<float>(i) * 0.001f) * 40.0f + static_cast<float>(i % 13) - 7.0f);
+        }
+        return heights;
+    }
+}
+
+TEST_CASE("Reduce normalizes an attribute in one execution", "")
+{
+    Graph graph;
+
+    GraphNode& heights_input = graph.add_attribute_input("Heights");
+
+    Reduce& reduce = graph.add_node<Reduce>();
+    graph.connect(heights_input.output("Output"), reduce.input("Input"));
+
+    // (height - min) / (max - min)
+    Math& minus_min = add_math(graph, MathOperation::subtract);
+    graph.connect(heights_input.output("Output"), minus_min.input("A"));
+    graph.connect(reduce.output("Min"), minus_min.input("B"));
+
+    Math& range = add_math(graph, MathOperation::subtract);
+    graph.connect(reduce.output("Max"), range.input("A"));
+    graph.connect(reduce.output("Min"), range.input("B"));
+
+    Math& normalize = add_math(graph, MathOperation::divide);
+    graph.connect(minus_min.output("Output"), normalize.input("A"));
+    graph.connect(range.output("Output"), normalize.input("B"));
+
+    GraphNode& output = graph.add_attribute_output("Normalized");
+    graph.connect(normalize.output("Output"), output.input("Input"));
+
+    std::vector<float> heights = make_heights();
+    graph.set_input_attribute<float, 1>("Heights", &heights[0], heights.size());
+
+    float min = *std::min_element(heights.begin(), heights.end());
+    float max = *std::max_element(heights.begin(), heights.end());
+
+    GraphExecutor executor(graph);
+    std::vector<float> normalized = executor.execute().get_attribute_all_vector<float>("Normalized");
+
+    REQUIRE(normalized.size() == heights.size());
+    REQUIRE(*std::min_element(normalized.begin(), normalized.end()) == 0.0f);
+    REQUIRE(*std::max_element(normalized.begin(), normalized.end()) == 1.0f);
+
+    for(std::size_t i = 0; i < heights.size(); i++)
+    {
+        REQUIRE(normalized[i] == (heights[i] - min) / (max - min));
+    }
+}
+
+TEST_CASE("Reduce gives the same results for any number of threads", "")
+{
+    Graph graph;
+
+    GraphNode& points_input = graph.add_attribute_input("Points");
+
+    Reduce& reduce = graph.add_node<Reduce>();
+    graph.connect(points_input.output("Output"), reduce.input("Input"));
+
+    for(const char* name : { "Min", "Max", "Sum", "Mean" })
+    {
+        GraphNode& output = graph.add_uniform_output(name);
+        graph.connect(reduce.output(name), output.input("Input"));
+    }
+
+    std::vector<float> heights = make_heights();
+    std::vector<float> points;
+    for(float height : heights)
+    {
+        points.push_back(height);
+        points.push_back(height * 0.5f);
+        points.push_back(-height);
+    }
+    graph.set_input_attribute<float, 3>("Points", &points[0], heights.size());
+
+    set_parallel_thread_count(1);
+    GraphOutputs single = GraphExecutor(graph).execute();
+
+    set_parallel_thread_count(7);
+    GraphOutputs many = GraphExecutor(graph).execute();
+
+    set_parallel_thread_count(0);
+
+    double expected_sum = 0.0;
+    for(float height : heights)
+    {
+        expected_sum += height;
+    }
+
+    for(const char* name : { "Min", "Max", "Sum", "Mean" })
+    {
+        for(int component = 0; component < 3; component++)
+        {
+            float single_value = single.get_uniform<float, 3>(name)[component];
+            float many_value = many.get_uniform<float, 3>(name)[component];
+            REQUIRE(single_value == many_value);
+        }
+    }
+
+    float min = *std::min_element(heights.begin(), heights.end());
+    float max = *std::max_element(heights.begin(), heights.end());
+
+    auto result_min = single.get_uniform<float, 3>("Min");
+    auto result_max = single.get_uniform<float, 3>("Max");
+    REQUIRE(result_min[0] == min);
+    REQUIRE(result_max[0] == max);
+    REQUIRE(result_min[2] == -max);
+    REQUIRE(result_max[2] == -min);
+
+    auto sum = single.get_uniform<float, 3>("Sum");
+    auto mean = single.get_uniform<float, 3>("Mean");
+    REQUIRE(sum[0] == Approx(expected_sum));
+    REQUIRE(sum[1] == Approx(expected_sum * 0.5));
+    REQUIRE(mean[0] == Approx(expected_sum / heights.size()));
+}
+
+TEST_CASE("Histogram counts the values in each bin", "")
+{
+    Graph graph;
+
+    GraphNode& values_input = graph.add_attribute_input("Values");
+
+    Histogram& full_range = graph.add_node<Histogram>();
+    full_range.set_bins(10);
+    graph.connect(values_input.output("Output"), full_range.input("Input"));
+
+    // Only counts [0, 0.5]
+    ConstantValue& min = graph.add_node<ConstantValue>();
+    min.set_value_single(0.0f);
+    ConstantValue& max = graph.add_node<ConstantValue>();
+    max.set_value_single(0.5f);
+
+    Histogram& half_range = graph.add_node<Histogram>();
+    half_range.set_bins(4);
+    graph.connect(values_input.output("Output"), half_range.input("Input"));
+    graph.connect(min.output("Value"), half_range.input("Min"));
+    graph.connect(max.output("Value"), half_range.input("Max"));
+
+    GraphNode& full_output = graph.add_attribute_output("Full");
+    graph.connect(full_range.output("Histogram"), full_output.input("Input"));
+
+    GraphNode& half_output = graph.add_attribute_output("Half");
+    graph.connect(half_range.output("Histogram"), half_output.input("Input"));
+
+    // 0, 0.001, ..., 0.999 repeated, so there are several chunks
+    std::vector<float> values;
+    for(std::size_t i = 0; i < 100000; i++)
+    {
+        values.push_back(static_cast<float>(i % 1000) / 1000.0f);
+    }
+    graph.set_input_attribute<float, 1>("Values", &values[0], values.size());
+
+    GraphExecutor executor(graph);
+    GraphOutputs outputs = executor.execute();
+
+    std::vector<unsigned int> full = outputs.get_attribute_all_vector<unsigned int>("Full");
+    std::vector<unsigned int> half = outputs.get_attribute_all_vector<unsigned int>("Half");
+
+    REQUIRE(full.size() == 10);
+    REQUIRE(half.size() == 4);
+
+    unsigned int full_total = 0;
+    for(unsigned int count : full)
+    {
+        full_total += count;
+        REQUIRE(count >= 9800);
+        REQUIRE(count <= 10200);
+    }
+    REQUIRE(full_total == values.size());
+
+    // 0 to 0.5 inclusive is 501 of every 1000 values
+    unsigned int half_total = 0;
+    for(unsigned int count : half)
+    {
+        half_total += count;
+    }
+    REQUIRE(half_total == 501 * 100);
+}
@@ -0,0 +1,289 @@
+#include "catch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+#include <composite_data_buffer.h>
+#include <nodes/blank_grid.h>
+#include <nodes/blur.h>
+#include <nodes/constant_value.h>
+#include <nodes/math.h>
+#include <nodes/perlin_noise.h>
+#include <nodes/mappings/unit_square_mapping.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+namespace
+{
+    // Copies a float attribute and counts its executions
+    class CountingCopy : public GraphNode
+    {
+    public:
+        CountingCopy() : executions(0)
+        {
+            input_ = &inputs().add("Input", SocketType::attribute);
+            input_->set_accepts(ConnectionDataType::value<float, 1>());
+            output_ = &outputs().add("Output", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+        }
+
+        std::string node_name() const { return "Counting Copy"; }
+
+        void execute_uniforms(const CompositeDataBuffer&, DataBuffer&) const
+        {
+            executions++;
+        }
+
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+        {
+            for(DataBuffer::size_type i = begin; i < end; i++)
+            {
+                output.set_attribute<float, 1>(*output_, i, input.get_attribute<float, 1>(*input_, i));
+            }
+        }
+
+        bool is_elementwise() const { return true; }
+        bool is_pure() const { return true; }
+
+        mutable std::atomic<int> executions;
+
+    private:
+        InputSocket* input_;
+        OutputSocket* output_;
+    };
+
+    bool contains(const std::vector<int>& ids, int id)
+    {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+
+    // Checks {outputs} against executing the graph from scratch
+    void require_fresh(const Graph& graph, GraphOutputs& outputs)
+    {
+        GraphExecutor fresh(graph);
+        GraphOutputs expected = fresh.execute();
+
+        REQUIRE(outputs.get_attribute_all_vector<float>("Blurred") == expected.get_attribute_all_vector<float>("Blurred"));
+        REQUIRE(outputs.get_attribute_all_vector<float>("Smoothed") == expected.get_attribute_all_vector<float>("Smoothed"));
+    }
+}
+
+TEST_CASE("Kept results are used until something upstream of them changes", "")
+{
+    // Blurred = blur(noise(p)) * scale and Smoothed = smooth(p), sharing the mapping of a 48x32 grid
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(48, 32);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    Blur& blur = graph.add_node<Blur>();
+    blur.set_radius(2);
+    graph.connect(noise.output("Output"), blur.input("Input"));
+
+    ConstantValue& scale = graph.add_node<ConstantValue>();
+    scale.set_value_single(2.0f);
+
+    Math& multiply = graph.add_node<Math>();
+    int operation = static_cast<int>(MathOperation::multiply);
+    multiply.property("Operation").set_value<int, 1>(&operation);
+    graph.connect(blur.output("Output"), multiply.input("A"));
+    graph.connect(scale.output("Value"), multiply.input("B"));
+
+    Blur& smooth = graph.add_node<Blur>();
+    smooth.set_kernel(BlurKernel::custom);
+    smooth.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+    graph.connect(mapping.output("Mapped"), smooth.input("Input"));
+
+    GraphNode& blurred_output = graph.add_attribute_output("Blurred");
+    graph.connect(multiply.output("Output"), blurred_output.input("Input"));
+
+    GraphNode& smoothed_output = graph.add_attribute_output("Smoothed");
+    graph.connect(smooth.output("Output"), smoothed_output.input("Input"));
+
+    GraphExecutor executor(graph);
+    executor.set_result_caching_enabled(true);
+
+    GraphOutputs first = executor.execute();
+    REQUIRE(executor.reused_nodes().empty());
+    require_fresh(graph, first);
+
+    // Nothing changed, so only the output nodes run
+    GraphOutputs unchanged = executor.execute();
+    REQUIRE(contains(executor.reused_nodes(), multiply.id()));
+    REQUIRE(contains(executor.reused_nodes(), smooth.id()));
+    REQUIRE(executor.reused_nodes().size() == 2);
+    require_fresh(graph, unchanged);
+
+    // Only the blur and what's downstream of it run again
+    blur.set_radius(4);
+    GraphOutputs blurred_more = executor.execute();
+    REQUIRE(contains(executor.reused_nodes(), noise.id()));
+    REQUIRE(contains(executor.reused_nodes(), smooth.id()));
+    REQUIRE_FALSE(contains(executor.reused_nodes(), multiply.id()));
+    REQUIRE(blurred_more.get_attribute_all_vector<float>("Blurred") != first.get_attribute_all_vector<float>("Blurred"));
+    require_fresh(graph, blurred_more);
+
+    // State that isn't a property is marked changed by the node
+    smooth.set_custom_kernel({ 1.0f, 1.0f, 1.0f, 1.0f, 1.0f });
+    GraphOutputs smoothed_more = executor.execute();
+    REQUIRE(contains(executor.reused_nodes(), multiply.id()));
+    REQUIRE_FALSE(contains(executor.reused_nodes(), smooth.id()));
+    REQUIRE(smoothed_more.get_attribute_all_vector<float>("Smoothed") != first.get_attribute_all_vector<float>("Smoothed"));
+    require_fresh(graph, smoothed_more);
+}
+
+TEST_CASE("Connecting and disconnecting nodes invalidates the kept results downstream", "")
+{
+    // Blurred = blur(noise(p)) * scale and Smoothed = smooth(p), sharing the mapping of a 48x32 grid
+    Graph graph;
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(48, 32);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid, mapping);
+
+    ConstantValue& seed = graph.add_node<ConstantValue>();
+    seed.set_value_single(5l);
+
+    PerlinNoise& noise = graph.add_node<PerlinNoise>();
+    graph.connect(seed, noise, "Seed");
+    graph.connect(mapping.output("Mapped"), noise.input("Points"));
+
+    Blur& blur = graph.add_node<Blur>();
+    blur.set_radius(2);
+    graph.connect(noise.output("Output"), blur.input("Input"));
+
+    ConstantValue& scale = graph.add_node<ConstantValue>();
+    scale.set_value_single(2.0f);
+
+    Math& multiply = graph.add_node<Math>();
+    int operation = static_cast<int>(MathOperation::multiply);
+    multiply.property("Operation").set_value<int, 1>(&operation);
+    graph.connect(blur.output("Output"), multiply.input("A"));
+    graph.connect(scale.output("Value"), multiply.input("B"));
+
+    Blur& smooth = graph.add_node<Blur>();
+    smooth.set_kernel(BlurKernel::custom);
+    smooth.set_custom_kernel({ 1.0f, 2.0f, 1.0f });
+    graph.connect(mapping.output("Mapped"), smooth.input("Input"));
+
+    GraphNode& blurred_output = graph.add_attribute_output("Blurred");
+    graph.connect(multiply.output("Output"), blurred_output.input("Input"));
+
+    GraphNode& smoothed_output = graph.add_attribute_output("Smoothed");
+    graph.connect(smooth.output("Output"), smoothed_output.input("Input"));
+
+    GraphExecutor executor(graph);
+    executor.set_result_caching_enabled(true);
+    executor.execute();
+
+    ConstantValue& other_scale = graph.add_node<ConstantValue>();
+    other_scale.set_value_single(-3.0f);
+    graph.connect(other_scale.output("Value"), multiply.input("B"));
+
+    GraphOutputs reconnected = executor.execute();
+    REQUIRE(contains(executor.reused_nodes(), blur.id()));
+    REQUIRE_FALSE(contains(executor.reused_nodes(), multiply.id()));
+    require_fresh(graph, reconnected);
+
+    // Straight from the noise instead of the blur
+    graph.disconnect(multiply.input("A"));
+    graph.connect(noise.output("Output"), multiply.input("A"));
+
+    GraphOutputs unblurred = executor.execute();
+    require_fresh(graph, unblurred);
+}
+
+TEST_CASE("Graph inputs and executor settings invalidate the kept results", "")
+{
+    Graph graph;
+
+    GraphNode& heights = graph.add_attribute_input("Heights");
+    std::vector<float> values { 1.0f, 2.0f, 3.0f, 4.0f };
+    graph.set_input_attribute<float, 1>("Heights", values.data(), values.size());
+
+    Math& squared = graph.add_node<Math>();
+    int operation = static_cast<int>(MathOperation::multiply);
+    squared.property("Operation").set_value<int, 1>(&operation);
+    graph.connect(heights.output("Output"), squared.input("A"));
+    graph.connect(heights.output("Output"), squared.input("B"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(squared.output("Output"), output.input("Input"));
+
+    // Graph::execute keeps its results once it's asked to
+    graph.set_result_caching_enabled(true);
+    REQUIRE(graph.execute().get_attribute_all_vector<float>("Output") == std::vector<float>({ 1.0f, 4.0f, 9.0f, 16.0f }));
+
+    values = { 5.0f, 6.0f, 7.0f, 8.0f };
+    graph.set_input_attribute<float, 1>("Heights", values.data(), values.size());
+    REQUIRE(graph.execute().get_attribute_all_vector<float>("Output") == std::vector<float>({ 25.0f, 36.0f, 49.0f, 64.0f }));
+
+    GraphExecutor executor(graph);
+    executor.set_result_caching_enabled(true);
+    executor.execute();
+
+    ActiveElements active(4);
+    active.add(1, 3);
+    executor.set_active_elements(active);
+    REQUIRE(executor.execute().get_attribute_all_vector<float>("Output") == std::vector<float>({ 0.0f, 36.0f, 49.0f, 0.0f }));
+    REQUIRE(executor.reused_nodes().empty());
+
+    executor.clear_active_elements();
+    REQUIRE(executor.execute().get_attribute_all_vector<float>("Output") == std::vector<float>({ 25.0f, 36.0f, 49.0f, 64.0f }));
+
+    executor.set_result_caching_enabled(false);
+    executor.execute();
+    REQUIRE(executor.reused_nodes().empty());
+}
+
+TEST_CASE("Graph::execute only keeps results when asked to, until they're cleared", "")
+{
+    Graph graph;
+
+    GraphNode& heights = graph.add_attribute_input("Heights");
+    std::vector<float> values { 1.0f, 2.0f, 3.0f, 4.0f };
+    graph.set_input_attribute<float, 1>("Heights", values.data(), values.size());
+
+    CountingCopy& copy = graph.add_node<CountingCopy>();
+    graph.connect(heights.output("Output"), copy.input("Input"));
+
+    GraphNode& output = graph.add_attribute_output("Output");
+    graph.connect(copy.output("Output"), output.input("Input"));
+
+    REQUIRE_FALSE(graph.result_caching_enabled());
+    graph.execute();
+    graph.execute();
+    REQUIRE(copy.executions == 2);
+
+    graph.set_result_caching_enabled(true);
+    REQUIRE(graph.result_caching_enabled());
+    graph.execute();
+    REQUIRE(graph.execute().get_attribute_all_vector<float>("Output") == values);
+    REQUIRE(copy.executions == 3);
+
+    graph.clear_cached_results();
+    graph.execute();
+    graph.execute();
+    REQUIRE(copy.executions == 4);
+
+    graph.set_result_caching_enabled(false);
+    graph.execute();
+    REQUIRE(copy.executions == 5);
+}
@@ -0,0 +1,185 @@
+#include "catch.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <nodes/sample.h>
+#include <nodes/blank_grid.h>
+#include <nodes/expression.h>
+#include <nodes/mappings/unit_square_mapping.h>
+#include <graph.h>
+#include <graph_executor.h>
+#include <graph_outputs.h>
+
+using namespace noises;
+using namespace noises::nodes;
+using namespace noises::nodes::mappings;
+
+namespace
+{
+    // Runs the graph and checks its Sampled output against its Expected output, for the points of a {width}x{height} grid at least
+    // {margin} pixels in from its edges
+    void require_resampled(Graph& graph, int width, int height, int channels, int margin)
+    {
+        GraphExecutor executor(graph);
+        GraphOutputs outputs = executor.execute();
+
+        std::vector<float> sampled = outputs.get_attribute_all_vector<float>("Sampled");
+        std::vector<float> expected = outputs.get_attribute_all_vector<float>("Expected");
+        REQUIRE(sampled.size() == static_cast<std::size_t>(width * height * channels));
+
+        for(int y = margin; y < height - margin; y++)
+        {
+            for(int x = margin; x < width - margin; x++)
+            {
+                for(int channel = 0; channel < channels; channel++)
+                {
+                    int index = (y * width + x) * channels + channel;
+                    REQUIRE(sampled[index] == Approx(expected[index]).epsilon(0.0001));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Sample reads a grid back at its own pixels with every filter", "")
+{
+    for(SampleFilter filter : { SampleFilter::nearest, SampleFilter::bilinear, SampleFilter::bicubic })
+    {
+        Graph graph;
+
+        BlankGrid& grid = graph.add_node<BlankGrid>();
+        grid.set_size(24, 16);
+
+        UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+        graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+        Sample& sample = graph.add_node<Sample>();
+        sample.set_filter(filter);
+        graph.connect(mapping.output("Mapped"), sample.input("Grid"));
+        graph.connect(mapping.output("Mapped"), sample.input("Points"));
+
+        GraphNode& sampled = graph.add_attribute_output("Sampled");
+        graph.connect(sample.output("Output"), sampled.input("Input"));
+
+        GraphNode& expected = graph.add_attribute_output("Expected");
+        graph.connect(mapping.output("Mapped"), expected.input("Input"));
+
+        require_resampled(graph, 24, 16, 2, 0);
+    }
+}
+
+TEST_CASE("Bilinear sampling reproduces a linear function between the pixels", "")
+{
+    Graph graph;
+
+    // The unit square mapping of a coarse grid, sampled at the positions of a finer one
+    BlankGrid& source_grid = graph.add_node<BlankGrid>();
+    source_grid.set_size(8, 10);
+
+    UnitSquareMapping& source_mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(source_grid.output("Grid"), source_mapping.input("Grid"));
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(32, 40);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    Sample& sample = graph.add_node<Sample>();
+    graph.connect(source_mapping.output("Mapped"), sample.input("Grid"));
+    graph.connect(mapping.output("Mapped"), sample.input("Points"));
+
+    GraphNode& sampled = graph.add_attribute_output("Sampled");
+    graph.connect(sample.output("Output"), sampled.input("Input"));
+
+    GraphNode& expected = graph.add_attribute_output("Expected");
+    graph.connect(mapping.output("Mapped"), expected.input("Input"));
+
+    // Past the last pixel centre the edge pixel is repeated, so only the inside is linear
+    require_resampled(graph, 32, 40, 2, 4);
+}
+
+TEST_CASE("Bicubic sampling reproduces a quadratic function between the pixels", "")
+{
+    const std::string quadratic = "p.x*p.x*2 - p.x*p.y + p.y*p.y*0.5 + p.x";
+
+    Graph graph;
+
+    BlankGrid& source_grid = graph.add_node<BlankGrid>();
+    source_grid.set_size(16, 16);
+
+    UnitSquareMapping& source_mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(source_grid.output("Grid"), source_mapping.input("Grid"));
+
+    Expression& source = graph.add_node<Expression>();
+    source.set_expression(quadratic);
+    graph.connect(source_mapping.output("Mapped"), source.input("p"));
+
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(64, 64);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    Expression& direct = graph.add_node<Expression>();
+    direct.set_expression(quadratic);
+    graph.connect(mapping.output("Mapped"), direct.input("p"));
+
+    Sample& sample = graph.add_node<Sample>();
+    sample.set_filter(SampleFilter::bicubic);
+    graph.connect(source.output("Output"), sample.input("Grid"));
+    graph.connect(mapping.output("Mapped"), sample.input("Points"));
+
+    GraphNode& sampled = graph.add_attribute_output("Sampled");
+    graph.connect(sample.output("Output"), sampled.input("Input"));
+
+    GraphNode& expected = graph.add_attribute_output("Expected");
+    graph.connect(direct.output("Output"), expected.input("Input"));
+
+    // Catmull-Rom needs two pixels on each side to be exact
+    require_resampled(graph, 64, 64, 1, 8);
+}
+
+TEST_CASE("Sample takes points in pixels and clamps them to the edges", "")
+{
+    Graph graph;
+
+    // Pixel (x, y) is (x/4*2 - 1, y/3*2 - 1)
+    BlankGrid& grid = graph.add_node<BlankGrid>();
+    grid.set_size(4, 3);
+
+    UnitSquareMapping& mapping = graph.add_node<UnitSquareMapping>();
+    graph.connect(grid.output("Grid"), mapping.input("Grid"));
+
+    GraphNode& points = graph.add_attribute_input("Points");
+
+    Sample& sample = graph.add_node<Sample>();
+    sample.set_coordinates(SampleCoordinates::pixels);
+    graph.connect(mapping.output("Mapped"), sample.input("Grid"));
+    graph.connect(points.output("Output"), sample.input("Points"));
+
+    GraphNode& sampled_output = graph.add_attribute_output("Sampled");
+    graph.connect(sample.output("Output"), sampled_output.input("Input"));
+
+    std::vector<std::array<float, 2>> positions {
+        { { 1.0f, 2.0f } }, { { 2.5f, 0.5f } }, { { -5.0f, 1.0f } }, { { 1.0f, 100.0f } }, { { 1000.0f, -1000.0f } }
+    };
+    graph.set_input_attribute<float, 2>("Points", &positions[0][0], positions.size());
+
+    GraphExecutor executor(graph);
+    std::vector<float> sampled = executor.execute().get_attribute_all_vector<float>("Sampled");
+
+    REQUIRE(sampled.size() == positions.size() * 2);
+    REQUIRE(sampled[0] == Approx(-0.5f));
+    REQUIRE(sampled[1] == Approx(1.0f / 3.0f));
+    REQUIRE(sampled[2] == Approx(0.25f));
+    REQUIRE(sampled[3] == Approx(-2.0f / 3.0f));
+    REQUIRE(sampled[4] == Approx(-1.0f));
+    REQUIRE(sampled[5] == Approx(-1.0f / 3.0f));
+    REQUIRE(sampled[6] == Approx(-0.5f));
+    REQUIRE(sampled[7] == Approx(1.0f / 3.0f));
+    REQUIRE(sampled[8] == Approx(0.5f));
+    REQUIRE(sampled[9] == Approx(-1.0f));
+}
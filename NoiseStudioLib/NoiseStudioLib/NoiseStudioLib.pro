@@ -2,6 +2,12 @@ TEMPLATE = lib
 CONFIG -= app_bundle
 CONFIG -= qt
 CONFIG += staticlib
+CONFIG += thread
+
+# Nothing reads errno, and setting it from sqrt stops the loops calling it vectorizing
+*-g++*|*-clang* {
+    QMAKE_CXXFLAGS += -fno-math-errno
+}
 
 SOURCES += \
     graph.cpp \
@@ -28,7 +34,24 @@ SOURCES += \
     nodes/blank_grid.cpp \
     nodes/mappings/pixel_mapping.cpp \
     nodes/type_conversion.cpp \
-    nodes/mappings/unit_square_mapping.cpp
+    nodes/mappings/unit_square_mapping.cpp \
+    nodes/domain_warp.cpp \
+    nodes/expression_program.cpp \
+    nodes/expression.cpp \
+    parallel.cpp \
+    active_elements.cpp \
+    mip_chain.cpp \
+    cancellation_token.cpp \
+    progressive_preview.cpp \
+    input_uniform_set.cpp \
+    nodes/reduce.cpp \
+    nodes/histogram.cpp \
+    nodes/blur.cpp \
+    nodes/normal_map.cpp \
+    nodes/erosion.cpp \
+    nodes/sample.cpp \
+    nodes/mappings/voxel_mapping.cpp \
+    nodes/mappings/unit_cube_mapping.cpp
 
 include(deployment.pri)
 qtcAddDeployment()
@@ -51,6 +74,7 @@ HEADERS += \
     ptr_array.h \
     property_collection.h \
     utils.h \
+    fast_math.h \
     graph_executor.h \
     nodes/constant_value.h \
     ptr_array_common.hpart \
@@ -64,7 +88,26 @@ HEADERS += \
     attribute_info.h \
     nodes/mappings/pixel_mapping.h \
     nodes/type_conversion.h \
-    nodes/mappings/unit_square_mapping.h
+    nodes/mappings/unit_square_mapping.h \
+    nodes/domain_warp.h \
+    nodes/expression_program.h \
+    nodes/expression.h \
+    parallel.h \
+    active_elements.h \
+    mip_chain.h \
+    cancellation_token.h \
+    progressive_preview.h \
+    input_uniform_set.h \
+    nodes/reduce.h \
+    nodes/histogram.h \
+    nodes/blur.h \
+    nodes/normal_map.h \
+    nodes/erosion.h \
+    nodes/sample.h \
+    nodes/whole_grid.h \
+    nodes/mappings/grid_rows.h \
+    nodes/mappings/voxel_mapping.h \
+    nodes/mappings/unit_cube_mapping.h
 
 header_files.path = $$OUT_PWD/lib
 header_files.files = $$HEADERS
@@ -80,11 +123,3 @@ QMAKE_CXXFLAGS_DEBUG *= -O0
 QMAKE_CXXFLAGS_RELEASE -= -O1
 QMAKE_CXXFLAGS_RELEASE -= -O2
 QMAKE_CXXFLAGS_RELEASE *= -O3
-
-win32: LIBS += -L$$PWD/../boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static/ -lboost_regex-mgw48-d-1_57
-
-INCLUDEPATH += $$PWD/../boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static
-DEPENDPATH += $$PWD/../boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static
-
-win32:!win32-g++: PRE_TARGETDEPS += $$PWD/../boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static/boost_regex-mgw48-d-1_57.lib
-else:win32-g++: PRE_TARGETDEPS += $$PWD/../boost/build/boost/bin.v2/libs/regex/build/gcc-mingw-4.8.2/debug/link-static/libboost_regex-mgw48-d-1_57.a
@@ -0,0 +1,70 @@
+#include "active_elements.h"
+
+#include <stdexcept>
+
+namespace noises
+{
+    ActiveElements::ActiveElements(std::size_t length) : length_(length), count_(0) { }
+
+    ActiveElements ActiveElements::all(std::size_t length)
+    {
+        ActiveElements elements(length);
+        elements.add(0, length);
+        return elements;
+    }
+
+    ActiveElements ActiveElements::from_mask(const float* mask, std::size_t length)
+    {
+        ActiveElements elements(length);
+
+        std::size_t i = 0;
+        while(i < length)
+        {
+            // Skip the inactive run, then find where the active one ends
+            while(i < length && mask[i] == 0.0f)
+                i++;
+
+            std::size_t begin = i;
+            while(i < length && mask[i] != 0.0f)
+                i++;
+
+            elements.add(begin, i);
+        }
+
+        return elements;
+    }
+
+    void ActiveElements::add(std::size_t begin, std::size_t end)
+    {
+        if(begin > end || end > length_)
+            throw std::invalid_argument("Active range is outside the attribute.");
+
+        if(!ranges_.empty() && begin < ranges_.back().second)
+            throw std::invalid_argument("Active ranges have to be added in order without overlapping.");
+
+        if(begin == end)
+            return;
+
+        if(!ranges_.empty() && begin == ranges_.back().second)
+            ranges_.back().second = end;
+        else
+            ranges_.emplace_back(begin, end);
+
+        count_ += end - begin;
+    }
+
+    std::size_t ActiveElements::length() const
+    {
+        return length_;
+    }
+
+    std::size_t ActiveElements::count() const
+    {
+        return count_;
+    }
+
+    const std::vector<ActiveElements::Range>& ActiveElements::ranges() const
+    {
+        return ranges_;
+    }
+}
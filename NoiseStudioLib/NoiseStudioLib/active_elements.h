@@ -0,0 +1,58 @@
+#ifndef ACTIVE_ELEMENTS_H
+#define ACTIVE_ELEMENTS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace noises
+{
+    /** The elements of an attribute that need calculating, as a sorted run-length list of [begin, end) ranges, e.g. where a mask is
+     *  non-zero. See GraphExecutor::set_active_elements. **/
+    class ActiveElements
+    {
+    public:
+        typedef std::pair<std::size_t, std::size_t> Range;
+
+        /** None of the {length} elements are active until ranges are added. **/
+        explicit ActiveElements(std::size_t length);
+
+        /** All of the {length} elements are active. **/
+        static ActiveElements all(std::size_t length);
+
+        /** The elements where {mask} is non-zero. **/
+        static ActiveElements from_mask(const float* mask, std::size_t length);
+
+        /** Makes [begin, end) active. Ranges have to be added in order; one that touches the last is merged with it. **/
+        void add(std::size_t begin, std::size_t end);
+
+        /** Number of elements in the attribute, active or not. **/
+        std::size_t length() const;
+
+        /** Number of active elements. **/
+        std::size_t count() const;
+
+        const std::vector<Range>& ranges() const;
+
+        /** Calls {body}(range_begin, range_end) for the active parts of [begin, end), in order. **/
+        template<typename Body>
+        void for_each_range(std::size_t begin, std::size_t end, Body body) const
+        {
+            auto range = std::upper_bound(ranges_.begin(), ranges_.end(), begin,
+                                          [](std::size_t index, const Range& candidate) { return index < candidate.second; });
+
+            for(; range != ranges_.end() && range->first < end; ++range)
+            {
+                body(std::max(range->first, begin), std::min(range->second, end));
+            }
+        }
+
+    private:
+        std::size_t length_;
+        std::size_t count_;
+        std::vector<Range> ranges_;
+    };
+}
+
+#endif // ACTIVE_ELEMENTS_H
@@ -1,11 +1,94 @@
 #ifndef ATTRIBUTE_INFO_H
 #define ATTRIBUTE_INFO_H
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
 #include <string>
 
 namespace noises
 {
+    /** The shape of an attribute that is laid out as a grid, with the first axis varying fastest (e.g. a 2D grid is rows of width values,
+     *  top to bottom). Rank 0 means the attribute isn't a grid. **/
+    struct GridInfo
+    {
+    public:
+        static const std::size_t max_rank = 4;
+
+        GridInfo() : rank_(0), extents_(), full_extents_(), stride_(1), origin_(0) { }
+
+        GridInfo(std::initializer_list<std::size_t> extents, std::size_t origin = 0) :
+            rank_(extents.size()), extents_(), full_extents_(), stride_(1), origin_(origin)
+        {
+            if(extents.size() > max_rank)
+                throw std::invalid_argument("Grids can have at most 4 dimensions.");
+
+            std::copy(extents.begin(), extents.end(), extents_.begin());
+            full_extents_ = extents_;
+        }
+
+        std::size_t rank() const { return rank_; }
+
+        /** Number of elements along {axis}, 0 for the width. **/
+        std::size_t extent(std::size_t axis) const { return axis < rank_ ? extents_[axis] : 1; }
+
+        /** Number of elements in the whole grid. **/
+        std::size_t size() const
+        {
+            std::size_t size = rank_ == 0 ? 0 : 1;
+            for(std::size_t axis = 0; axis < rank_; axis++)
+            {
+                size *= extents_[axis];
+            }
+            return size;
+        }
+
+        /** Every stride-th element of the full grid along each axis is in this one, e.g. for a preview or a lower level of detail. The
+         *  mappings put element (x, y) where element (x * stride, y * stride) of the full grid would be. **/
+        std::size_t stride() const { return stride_; }
+
+        /** Number of elements along {axis} of the full grid, before the stride. **/
+        std::size_t full_extent(std::size_t axis) const { return axis < rank_ ? full_extents_[axis] : 1; }
+
+        /** This grid with only every {stride}-th element along each axis, rounding up so the last row and column are kept. **/
+        GridInfo strided(std::size_t stride) const
+        {
+            if(stride == 0)
+                throw std::invalid_argument("Grid stride can't be 0.");
+
+            GridInfo strided = *this;
+            strided.stride_ = stride_ * stride;
+            for(std::size_t axis = 0; axis < rank_; axis++)
+            {
+                strided.extents_[axis] = (extents_[axis] + stride - 1) / stride;
+            }
+            return strided;
+        }
+
+        /** Index in the whole grid of the attribute's first element, for an attribute that only holds part of the grid. **/
+        std::size_t origin() const { return origin_; }
+
+        /** The grid info for an attribute holding this one's elements from {offset} on. **/
+        GridInfo part(std::size_t offset) const
+        {
+            GridInfo part = *this;
+            part.origin_ += offset;
+            return part;
+        }
+
+        /** True if an attribute {length} long holds the whole grid. **/
+        bool covers(std::size_t length) const { return rank_ > 0 && origin_ == 0 && size() == length; }
+
+    private:
+        std::size_t rank_;
+        std::array<std::size_t, max_rank> extents_;
+        std::array<std::size_t, max_rank> full_extents_;
+        std::size_t stride_;
+        std::size_t origin_;
+    };
+
     struct AttributeInfo
     {
     public:
@@ -16,15 +99,22 @@ namespace noises
         AttributeInfo(std::size_t length, const std::string& tag) :
             length_(length), tag_(tag) { }
 
+        AttributeInfo(std::size_t length, const std::string& tag, const GridInfo& grid) :
+            length_(length), tag_(tag), grid_(grid) { }
+
         std::size_t length() const { return length_; }
 
         /** A tag will contain something like "image512x512" so that you can identify what the data contains **/
         const std::string& tag() const { return tag_; }
 
+        /** The grid's dimensions when the data is a grid (e.g. from BlankGrid), so nodes don't have to parse them out of the tag **/
+        const GridInfo& grid() const { return grid_; }
+
         static const AttributeInfo inherit() { return AttributeInfo(0, ""); }
     private:
         std::size_t length_;
         std::string tag_;
+        GridInfo grid_;
     };
 
     inline bool operator==(const AttributeInfo& l, const AttributeInfo& r)
@@ -0,0 +1,22 @@
+#include "cancellation_token.h"
+
+namespace noises
+{
+    CancellationToken::CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) { }
+
+    void CancellationToken::cancel()
+    {
+        cancelled_->store(true);
+    }
+
+    bool CancellationToken::is_cancelled() const
+    {
+        return cancelled_->load();
+    }
+
+    void CancellationToken::throw_if_cancelled() const
+    {
+        if(is_cancelled())
+            throw ExecutionCancelled();
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+namespace noises
+{
+    /** Thrown out of an execution that was cancelled through its CancellationToken. **/
+    class ExecutionCancelled : public std::runtime_error
+    {
+    public:
+        ExecutionCancelled() : std::runtime_error("Execution was cancelled.") { }
+    };
+
+    /** Lets another thread stop an execution part way through. Copies share the same state, so cancelling any of them cancels them all.
+     *  Executions only check it between nodes and between chunks, so they stop soon after, not straight away. **/
+    class CancellationToken
+    {
+    public:
+        CancellationToken();
+
+        void cancel();
+        bool is_cancelled() const;
+
+        /** Throws ExecutionCancelled if the token has been cancelled. **/
+        void throw_if_cancelled() const;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> cancelled_;
+    };
+}
+
+#endif // CANCELLATION_TOKEN_H
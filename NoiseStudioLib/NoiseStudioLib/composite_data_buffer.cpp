@@ -7,24 +7,43 @@
 
 namespace noises
 {
-    CompositeDataBuffer::CompositeDataBuffer() : attribute_info_(0, "") { }
+    CompositeDataBuffer::CompositeDataBuffer() : attribute_info_(0, ""), grid_stride_(1) { }
 
-    void CompositeDataBuffer::add_attribute(const ConnectionDataType& data_type, const std::vector<unsigned char>& buffer, AttributeInfo buffer_info)
+    std::size_t CompositeDataBuffer::grid_stride() const
     {
-        if(attribute_info_.length() == 0)
-        {
-            attribute_info_ = buffer_info;
-        }
-        else
+        return grid_stride_;
+    }
+
+    void CompositeDataBuffer::set_grid_stride(std::size_t stride)
+    {
+        grid_stride_ = stride;
+    }
+
+    void CompositeDataBuffer::add_attribute(const ConnectionDataType& data_type, const std::vector<unsigned char>& buffer, AttributeInfo buffer_info, bool independent_length)
+    {
+        add_attribute(data_type, buffer.data(), buffer.size(), buffer_info, independent_length);
+    }
+
+    void CompositeDataBuffer::add_attribute(const ConnectionDataType& data_type, const unsigned char* data, std::size_t size, AttributeInfo buffer_info, bool independent_length)
+    {
+        if(!independent_length)
         {
-            if(buffer_info.length() != attribute_info_.length())
+            if(attribute_info_.length() == 0)
+            {
+                attribute_info_ = buffer_info;
+            }
+            else
             {
-                throw std::invalid_argument("Attributes are not same length.");
+                if(buffer_info.length() != attribute_info_.length())
+                {
+                    throw std::invalid_argument("Attributes are not same length.");
+                }
             }
         }
 
         attribute_data_types_.push_back(std::ref(data_type));
-        attribute_refs_.push_back(std::ref(buffer));
+        attribute_refs_.push_back(std::make_tuple(data, size));
+        attribute_infos_.push_back(buffer_info);
     }
 
     void CompositeDataBuffer::add_uniform(const ConnectionDataType& data_type, const unsigned char* ptr)
@@ -49,10 +68,10 @@ namespace noises
         assert(socket.accepts(should_support));
         assert(should_support == attribute_data_types_[socket.index()]);
 
-        const std::reference_wrapper<const std::vector<unsigned char>>& buffer = attribute_refs_[socket.index()];
+        const unsigned char* buffer = std::get<0>(attribute_refs_[socket.index()]);
         size_type real_index(should_support.size_full() * index);
 
-        return &(buffer.get()[real_index]);
+        return buffer + real_index;
     }
 
     std::tuple<const unsigned char*, std::size_t> CompositeDataBuffer::get_attribute_all_raw(const InputSocket &socket, const ConnectionDataType &should_support) const
@@ -60,10 +79,7 @@ namespace noises
         assert(socket.accepts(should_support));
         assert(should_support == attribute_data_types_[socket.index()]);
 
-        const std::reference_wrapper<const std::vector<unsigned char>>& buffer = attribute_refs_[socket.index()];
-        const unsigned char* first = &(buffer.get()[0]);
-        const std::size_t size = buffer.get().size();
-        return std::make_tuple(first, size);
+        return attribute_refs_[socket.index()];
     }
 
     const unsigned char* CompositeDataBuffer::get_uniform_raw(const InputSocket &socket, const ConnectionDataType &should_support) const
@@ -91,6 +107,11 @@ namespace noises
         return attribute_info_;
     }
 
+    AttributeInfo CompositeDataBuffer::attribute_info(const InputSocket &socket) const
+    {
+        return attribute_infos_[socket.index()];
+    }
+
     CompositeDataBuffer::size_type CompositeDataBuffer::num_attributes() const
     {
         return attribute_data_types_.size();
@@ -21,7 +21,12 @@ namespace noises
         CompositeDataBuffer(const CompositeDataBuffer&) = delete;
         CompositeDataBuffer& operator=(const CompositeDataBuffer&) = delete;
 
-        void add_attribute(const ConnectionDataType& data_type, const std::vector<unsigned char>& buffer, AttributeInfo buffer_info);
+        /** Adds an attribute. Unless it has an {independent_length} (see InputSocket::independent_length), it must be the same length as
+         *  the other attributes. **/
+        void add_attribute(const ConnectionDataType& data_type, const std::vector<unsigned char>& buffer, AttributeInfo buffer_info, bool independent_length = false);
+
+        /** Adds an attribute from {size} bytes at {data}, e.g. a chunk of another buffer. {buffer_info} must describe just that chunk. **/
+        void add_attribute(const ConnectionDataType& data_type, const unsigned char* data, std::size_t size, AttributeInfo buffer_info, bool independent_length = false);
 
         void add_uniform(const ConnectionDataType& data_type, const unsigned char* ptr);
 
@@ -42,8 +47,16 @@ namespace noises
 
         const unsigned char* get_uniform_raw(const InputSocket& socket, const ConnectionDataType& should_support) const;
 
+        /** The length and tag shared by the attributes, not counting those with independent lengths. **/
         AttributeInfo attribute_info() const;
 
+        /** The length and tag of the attribute connected to {socket}. **/
+        AttributeInfo attribute_info(const InputSocket& socket) const;
+
+        /** Stride applied on top of their own to any grids the node makes, e.g. for a quick preview (see GraphExecutor::set_grid_stride). **/
+        std::size_t grid_stride() const;
+        void set_grid_stride(std::size_t stride);
+
         size_type num_attributes() const;
 
         size_type num_uniforms() const;
@@ -61,10 +74,12 @@ namespace noises
         std::vector<std::reference_wrapper<const ConnectionDataType>> attribute_data_types_;
         std::vector<std::reference_wrapper<const ConnectionDataType>> uniform_data_types_;
 
-        std::vector<std::reference_wrapper<const std::vector<unsigned char>>> attribute_refs_;
+        std::vector<std::tuple<const unsigned char*, std::size_t>> attribute_refs_;
+        std::vector<AttributeInfo> attribute_infos_;
         std::vector<unsigned char> uniform_memory_block_;
 
         AttributeInfo attribute_info_;
+        std::size_t grid_stride_;
     };
 }
 
@@ -2,6 +2,7 @@
 #include "connection.h"
 #include "input_socket.h"
 #include "output_socket.h"
+#include "graph_node.h"
 
 namespace noises
 {
@@ -26,6 +27,10 @@ namespace noises
 
     void Connection::disconnect()
     {
+        // Connecting marks the node changed through its socket, disconnecting doesn't change the socket
+        if(input_.parent() != nullptr)
+            input_.parent()->mark_changed();
+
         input_.remove_connection();
         output_.remove_connection(*this);
     }
@@ -22,4 +22,5 @@ namespace noises
     MAKE_TYPE_NAME_VALUE(std::string, "string");
     MAKE_TYPE_NAME_VALUE(long, "long");
     MAKE_TYPE_NAME_VALUE(unsigned long, "unsigned long");
+    MAKE_TYPE_NAME_VALUE(long long, "long long");
 }
@@ -164,6 +164,7 @@ namespace noises
     MAKE_TYPE_NAME(std::string);
     MAKE_TYPE_NAME(long);
     MAKE_TYPE_NAME(unsigned long);
+    MAKE_TYPE_NAME(long long);
 
 
 }
@@ -1,5 +1,6 @@
 #include "data_buffer.h"
 
+#include <algorithm>
 #include <cassert>
 #include "socket_collection.h"
 #include "attribute_info.h"
@@ -75,6 +76,18 @@ namespace noises
         std::copy(value, value + size, first_ptr);
     }
 
+    unsigned char* DataBuffer::get_attribute_all_raw(const OutputSocket &socket, const ConnectionDataType &should_equal)
+    {
+        assert(socket.data_type() == should_equal);
+        return get_attribute_all_raw(socket.index());
+    }
+
+    unsigned char* DataBuffer::get_attribute_all_raw(unsigned int socket_index)
+    {
+        std::vector<unsigned char>& block = attribute_memory_blocks_[socket_index];
+        return block.empty() ? nullptr : &block[0];
+    }
+
     const unsigned char* DataBuffer::get_uniform_raw(const OutputSocket &socket, const ConnectionDataType &should_equal) const
     {
         assert(socket.data_type() == should_equal);
@@ -175,4 +188,17 @@ namespace noises
             i++;
         }
     }
+
+    void DataBuffer::reset(AttributeInfo info)
+    {
+        resize_attribute(info);
+
+        for(std::vector<unsigned char>& buffer : attribute_memory_blocks_)
+        {
+            std::fill(buffer.begin(), buffer.end(), 0);
+        }
+
+        std::fill(uniform_memory_block_.begin(), uniform_memory_block_.end(), 0);
+        scratch_blocks_.clear();
+    }
 }
@@ -116,6 +116,10 @@ namespace noises
         void set_attribute_all_raw(const OutputSocket& socket, const ConnectionDataType& should_equal, const unsigned char* value, std::size_t length_check);
         /** Sets the entire attribute using a raw byte array, with *no* type checking. Only use this if you're sure you're messing with the right data type (dangerous) */
         void set_attribute_all_raw(unsigned int socket_index, const unsigned char* value, std::size_t length_check);
+        /** Gets a writable pointer to the first value of the entire attribute so it can be filled in place. Use this for library code that doesn't know the template parameters. */
+        unsigned char* get_attribute_all_raw(const OutputSocket& socket, const ConnectionDataType& should_equal);
+        /** Gets a writable pointer to the first value of the entire attribute, with *no* type checking. Only use this if you're sure you're messing with the right data type (dangerous) */
+        unsigned char* get_attribute_all_raw(unsigned int socket_index);
 
 
         /** Gets a uniform as a raw byte array. Use this for library code that doesn't know the template parameters. */
@@ -130,6 +134,10 @@ namespace noises
 
         void resize_attribute(AttributeInfo info);
 
+        /** Resizes the attributes to {info} and zeroes every value and scratch block, so the buffer can be used again as if it had just
+         *  been made with the same data types. **/
+        void reset(AttributeInfo info);
+
         template<typename T>
         void set_scratch(unsigned int index, const T& value)
         {
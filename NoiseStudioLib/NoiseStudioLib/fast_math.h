@@ -0,0 +1,290 @@
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace noises
+{
+    /** Polynomial approximations of the transcendental functions, used by MathPrecision::fast. They stay within about 1e-5 relative
+     *  error (absolute error for sin and cos, whose results pass through 0). There are no branches or library calls, only bitwise
+     *  selects, so loops over them vectorize. Only instantiated for float and double.
+     *  sin and cos are only accurate for |x| <= max_trig_argument(); past it the argument reduction loses the angle, so callers
+     *  have to use std::sin and std::cos for larger arguments (see is_trig_argument_in_range). **/
+    namespace fast_math
+    {
+        template<typename T>
+        struct FloatBits;
+
+        template<>
+        struct FloatBits<float>
+        {
+            typedef std::int32_t integer;
+            static const int mantissa_bits = 23;
+            static const int exponent_bias = 127;
+
+            // 1.5 * 2^23. Adding it pushes the fraction out of the mantissa.
+            static constexpr float round_magic() { return 12582912.0f; }
+
+            // exp overflows above this and its result stops being a normal number below the minimum
+            static constexpr float max_exp_argument() { return 88.0f; }
+            static constexpr float min_exp_argument() { return -87.3f; }
+
+            // The reduction by pi in sin and cos drifts by more than 1e-5 past this
+            static constexpr float max_trig_argument() { return 1e5f; }
+        };
+
+        template<>
+        struct FloatBits<double>
+        {
+            typedef std::int64_t integer;
+            static const int mantissa_bits = 52;
+            static const int exponent_bias = 1023;
+
+            static constexpr double round_magic() { return 6755399441055744.0; }
+
+            static constexpr double max_exp_argument() { return 709.0; }
+            static constexpr double min_exp_argument() { return -708.0; }
+
+            static constexpr double max_trig_argument() { return 1e5; }
+        };
+
+        template<typename T>
+        inline typename FloatBits<T>::integer to_bits(T value)
+        {
+            typename FloatBits<T>::integer bits;
+            std::memcpy(&bits, &value, sizeof(T));
+            return bits;
+        }
+
+        template<typename T>
+        inline T from_bits(typename FloatBits<T>::integer bits)
+        {
+            T value;
+            std::memcpy(&value, &bits, sizeof(T));
+            return value;
+        }
+
+        /** condition ? if_true : if_false, done on the bits. GCC won't if-convert a floating point ?: whose sides can trap
+         *  (everything but a plain copy, without -fno-trapping-math), which stops the whole loop vectorizing. **/
+        template<typename T>
+        inline T select(bool condition, T if_true, T if_false)
+        {
+            typedef typename FloatBits<T>::integer integer;
+            integer mask = -static_cast<integer>(condition);
+            return from_bits<T>((to_bits(if_true) & mask) | (to_bits(if_false) & ~mask));
+        }
+
+        /** x + round_magic(), whose low mantissa bits hold round(x) as an integer. Only valid for |x| < 2^(mantissa_bits - 1). **/
+        template<typename T>
+        inline T add_round_magic(T x)
+        {
+            return x + FloatBits<T>::round_magic();
+        }
+
+        /** The integer in the low mantissa bits of add_round_magic's result. **/
+        template<typename T>
+        inline typename FloatBits<T>::integer magic_to_integer(T magic_sum)
+        {
+            return to_bits(magic_sum) - to_bits(FloatBits<T>::round_magic());
+        }
+
+        /** Flips the sign of {value} if the integer in {magic_sum} is odd. **/
+        template<typename T>
+        inline T negate_if_odd(T value, T magic_sum)
+        {
+            typedef typename FloatBits<T>::integer integer;
+            const int sign_shift = sizeof(T) * 8 - 1;
+            integer sign = static_cast<integer>(static_cast<typename std::make_unsigned<integer>::type>(to_bits(magic_sum)) << sign_shift);
+            return from_bits<T>(to_bits(value) ^ sign);
+        }
+
+        /** 2^n for the integer n in {magic_sum}, which must be inside the normal exponent range. **/
+        template<typename T>
+        inline T pow2(T magic_sum)
+        {
+            typedef typename FloatBits<T>::integer integer;
+            typedef typename std::make_unsigned<integer>::type unsigned_integer;
+
+            // A NaN magic_sum (exp(NaN) gets here, and comes out NaN either way) can give a negative exponent, and
+            // left shifting a negative signed integer is undefined
+            integer exponent = magic_to_integer(magic_sum) + FloatBits<T>::exponent_bias;
+            return from_bits<T>(static_cast<integer>(static_cast<unsigned_integer>(exponent) << FloatBits<T>::mantissa_bits));
+        }
+
+        // sin(r) for r in [-pi/2, pi/2], Taylor series up to r^11
+        template<typename T>
+        inline T sin_reduced(T r)
+        {
+            T r2 = r * r;
+            T p = static_cast<T>(-1.0 / 39916800.0);
+            p = p * r2 + static_cast<T>(1.0 / 362880.0);
+            p = p * r2 + static_cast<T>(-1.0 / 5040.0);
+            p = p * r2 + static_cast<T>(1.0 / 120.0);
+            p = p * r2 + static_cast<T>(-1.0 / 6.0);
+            return r + r * r2 * p;
+        }
+
+        // pi split in two so (x - k * pi) keeps its precision for large k
+        template<typename T>
+        inline T reduce_by_pi(T x, T k)
+        {
+            const T pi_high = static_cast<T>(3.140625);
+            const T pi_low = static_cast<T>(9.67653589793e-4);
+            return (x - k * pi_high) - k * pi_low;
+        }
+
+        /** Whether sin and cos are accurate for {x}. **/
+        template<typename T>
+        inline bool is_trig_argument_in_range(T x)
+        {
+            return std::abs(x) <= FloatBits<T>::max_trig_argument();
+        }
+
+        template<typename T>
+        inline T sin(T x)
+        {
+            // x = k*pi + r, sin(x) = (-1)^k sin(r)
+            T magic_sum = add_round_magic(x * static_cast<T>(M_1_PI));
+            T k = magic_sum - FloatBits<T>::round_magic();
+            return negate_if_odd(sin_reduced(reduce_by_pi(x, k)), magic_sum);
+        }
+
+        template<typename T>
+        inline T cos(T x)
+        {
+            // x = (k + 1/2)*pi + r, cos(x) = -(-1)^k sin(r)
+            T magic_sum = add_round_magic(x * static_cast<T>(M_1_PI) - static_cast<T>(0.5));
+            T k = magic_sum - FloatBits<T>::round_magic();
+            T r = reduce_by_pi(x, k) - static_cast<T>(M_PI_2);
+            return negate_if_odd(-sin_reduced(r), magic_sum);
+        }
+
+        template<typename T>
+        inline T exp(T x)
+        {
+            const T max = FloatBits<T>::max_exp_argument();
+            const T min = FloatBits<T>::min_exp_argument();
+            T clamped = select(x > max, max, x);
+            clamped = select(clamped < min, min, clamped);
+
+            // x = n*ln(2) + r with |r| <= ln(2)/2, exp(x) = 2^n * exp(r)
+            T magic_sum = add_round_magic(clamped * static_cast<T>(M_LOG2E));
+            T n = magic_sum - FloatBits<T>::round_magic();
+            T r = clamped - n * static_cast<T>(M_LN2);
+
+            T p = static_cast<T>(1.0 / 5040.0);
+            p = p * r + static_cast<T>(1.0 / 720.0);
+            p = p * r + static_cast<T>(1.0 / 120.0);
+            p = p * r + static_cast<T>(1.0 / 24.0);
+            p = p * r + static_cast<T>(1.0 / 6.0);
+            p = p * r + static_cast<T>(0.5);
+            p = p * r + static_cast<T>(1.0);
+            p = p * r + static_cast<T>(1.0);
+
+            T result = p * pow2<T>(magic_sum);
+            result = select(x > max, std::numeric_limits<T>::infinity(), result);
+            return select(x < min, static_cast<T>(0), result);
+        }
+
+        template<typename T>
+        inline T log(T x)
+        {
+            typedef typename FloatBits<T>::integer integer;
+
+            // Scale denormals into the normal range so the exponent can be read from the bits
+            bool denormal = x < std::numeric_limits<T>::min();
+            T scaled = select(denormal, x * static_cast<T>(integer(1) << FloatBits<T>::mantissa_bits), x);
+
+            // x = m * 2^e with m in [sqrt(1/2), sqrt(2))
+            const integer mantissa_mask = (static_cast<integer>(1) << FloatBits<T>::mantissa_bits) - 1;
+            integer bits = to_bits(scaled);
+            T e = static_cast<T>((bits >> FloatBits<T>::mantissa_bits) - FloatBits<T>::exponent_bias);
+            e = select(denormal, e - static_cast<T>(FloatBits<T>::mantissa_bits), e);
+            T m = from_bits<T>((bits & mantissa_mask) | (static_cast<integer>(FloatBits<T>::exponent_bias) << FloatBits<T>::mantissa_bits));
+
+            bool above_sqrt2 = m > static_cast<T>(M_SQRT2);
+            m = select(above_sqrt2, m * static_cast<T>(0.5), m);
+            e = select(above_sqrt2, e + static_cast<T>(1), e);
+
+            // log(m) = 2 atanh(s) with s = (m - 1) / (m + 1), |s| < 0.172
+            T s = (m - static_cast<T>(1)) / (m + static_cast<T>(1));
+            T s2 = s * s;
+            T p = static_cast<T>(2.0 / 11.0);
+            p = p * s2 + static_cast<T>(2.0 / 9.0);
+            p = p * s2 + static_cast<T>(2.0 / 7.0);
+            p = p * s2 + static_cast<T>(2.0 / 5.0);
+            p = p * s2 + static_cast<T>(2.0 / 3.0);
+            p = p * s2 + static_cast<T>(2.0);
+
+            T result = e * static_cast<T>(M_LN2) + s * p;
+
+            // Same results as std::log outside (0, inf)
+            result = select(x == std::numeric_limits<T>::infinity(), x, result);
+            result = select(x < static_cast<T>(0), std::numeric_limits<T>::quiet_NaN(), result);
+            result = select(x == static_cast<T>(0), -std::numeric_limits<T>::infinity(), result);
+            return select(x != x, x, result);
+        }
+
+        template<typename T>
+        inline T log2(T x)
+        {
+            return fast_math::log(x) * static_cast<T>(M_LOG2E);
+        }
+
+        template<typename T>
+        inline T log10(T x)
+        {
+            return fast_math::log(x) * static_cast<T>(M_LOG10E);
+        }
+
+        /** Matches std::pow for zero and negative bases, so negative bases only work with whole exponents. **/
+        template<typename T>
+        inline T pow(T base, T exponent)
+        {
+            T result = fast_math::exp(exponent * fast_math::log(std::abs(base)));
+
+            // Too large for round_whole. Treated as even whole numbers; unless the base is +-1 the result is 0 or infinity anyway.
+            const T round_limit = static_cast<T>(typename FloatBits<T>::integer(1) << (FloatBits<T>::mantissa_bits - 1));
+            bool large = std::abs(exponent) >= round_limit;
+            T magic_sum = add_round_magic(select(large, static_cast<T>(0), exponent));
+            bool whole = large | (magic_sum - FloatBits<T>::round_magic() == exponent);
+
+            T negative_result = select(whole, negate_if_odd(result, magic_sum), std::numeric_limits<T>::quiet_NaN());
+            result = select(base < static_cast<T>(0), negative_result, result);
+
+            T zero_result = select(exponent > static_cast<T>(0), static_cast<T>(0), std::numeric_limits<T>::infinity());
+            result = select(base == static_cast<T>(0), zero_result, result);
+            return select(exponent == static_cast<T>(0), static_cast<T>(1), result);
+        }
+
+        template<typename T>
+        inline T atan2(T y, T x)
+        {
+            T abs_x = std::abs(x);
+            T abs_y = std::abs(y);
+            T largest = select(abs_x > abs_y, abs_x, abs_y);
+            T smallest = select(abs_x > abs_y, abs_y, abs_x);
+
+            // Minimax polynomial for atan on [0, 1]
+            T z = smallest / select(largest == static_cast<T>(0), static_cast<T>(1), largest);
+            T z2 = z * z;
+            T p = static_cast<T>(-0.0117212);
+            p = p * z2 + static_cast<T>(0.05265332);
+            p = p * z2 + static_cast<T>(-0.11643287);
+            p = p * z2 + static_cast<T>(0.19354346);
+            p = p * z2 + static_cast<T>(-0.33262347);
+            p = p * z2 + static_cast<T>(0.99997726);
+            T result = z * p;
+
+            result = select(abs_y > abs_x, static_cast<T>(M_PI_2) - result, result);
+            result = select(x < static_cast<T>(0), static_cast<T>(M_PI) - result, result);
+            return select(y < static_cast<T>(0), -result, result);
+        }
+    }
+}
+
+#endif // FAST_MATH_H
@@ -1,28 +1,88 @@
 #include "graph.h"
+
+#include <mutex>
+
 #include "utils.h"
 #include "nodes/uniform_buffer.h"
 #include "nodes/attribute_buffer.h"
 #include "graph_executor.h"
+#include "parallel.h"
 
 namespace noises
 {
-    Graph::Graph() : id_counter_(0), in_refresh_after_(false) { }
+    struct Graph::KeptExecutor
+    {
+        KeptExecutor() : result_caching_enabled(false) { }
+
+        std::mutex mutex;
+        std::unique_ptr<GraphExecutor> executor;
+        bool result_caching_enabled;
+    };
+
+    Graph::Graph() : id_counter_(0), in_refresh_after_(false), kept_executor_(new KeptExecutor()) { }
+
+    Graph::~Graph() { }
+
+    Graph::Graph(Graph&& other) :
+        id_counter_(other.id_counter_),
+        in_refresh_after_(false),
+        nodes_(std::move(other.nodes_)),
+        connections_(std::move(other.connections_)),
+        input_nodes_(std::move(other.input_nodes_)),
+        output_nodes_(std::move(other.output_nodes_)),
+        properties_(std::move(other.properties_)),
+        manual_input_buffers_(std::move(other.manual_input_buffers_)),
+        kept_executor_(new KeptExecutor())
+    {
+        for(auto& node : nodes_)
+        {
+            node->set_parent(*this);
+        }
+    }
+
+    Graph& Graph::operator=(Graph&& other)
+    {
+        // The kept executor refers to this graph's old nodes
+        kept_executor_.reset(new KeptExecutor());
+
+        id_counter_ = other.id_counter_;
+        nodes_ = std::move(other.nodes_);
+        connections_ = std::move(other.connections_);
+        input_nodes_ = std::move(other.input_nodes_);
+        output_nodes_ = std::move(other.output_nodes_);
+        properties_ = std::move(other.properties_);
+        manual_input_buffers_ = std::move(other.manual_input_buffers_);
+
+        for(auto& node : nodes_)
+        {
+            node->set_parent(*this);
+        }
+
+        return *this;
+    }
 
     int Graph::add_node(std::unique_ptr<GraphNode> node)
     {
         node->set_id(id_counter_);
-        node->set_parent(*this);
         id_counter_++;
 
+        adopt_node(std::move(node));
+
+        return id_counter_ - 1;
+    }
+
+    void Graph::adopt_node(std::unique_ptr<GraphNode> node)
+    {
+        node->set_parent(*this);
+
         GraphNode& node_ref = *node;
 
         nodes_.push_back(std::move(node));
 
         node_ref.request_recalculate_sockets();
 
-        node_ref.outputs().listen_socket_changed([this, &node_ref](const OutputSocket&) { this->refresh_after(node_ref); });
-
-        return id_counter_ - 1;
+        // Through the node's parent rather than this, which changes when the graph is moved
+        node_ref.outputs().listen_socket_changed([&node_ref](const OutputSocket&) { node_ref.parent()->refresh_after(node_ref); });
     }
 
     void Graph::remove_node(GraphNode* node)
@@ -174,6 +234,11 @@ namespace noises
         return properties_.get_property_by_name(name);
     }
 
+    boost::optional<std::reference_wrapper<const Property>> Graph::get_property_by_name(const std::string &name) const
+    {
+        return properties_.get_property_by_name(name);
+    }
+
     // Icky repetitive
     GraphNode& Graph::add_attribute_output(const std::string &name)
     {
@@ -324,11 +389,12 @@ namespace noises
         new_buffer->add_uniform(data_type);
         new_buffer->set_uniform_raw(0, data_type.size_full(), data_ptr);
 
-        manual_input_buffers_.insert(std::pair<std::string, std::unique_ptr<DataBuffer>>(input_name, std::move(new_buffer)));
+        manual_input_buffers_.insert(std::pair<std::string, std::shared_ptr<const DataBuffer>>(input_name, std::move(new_buffer)));
 
         nodes::UniformBuffer& input_node = *this->get_uniform_input(input_name);
         input_node.set_output_type(data_type);
         input_node.input().set_accepts(data_type);
+        input_node.mark_changed();
 
         refresh_all_sockets();
     }
@@ -351,11 +417,12 @@ namespace noises
         new_buffer->add_attribute(data_type);
         new_buffer->set_attribute_all_raw(0, data_ptr, attribute_length * data_type.size_full());
 
-        manual_input_buffers_.insert(std::pair<std::string, std::unique_ptr<DataBuffer>>(input_name, std::move(new_buffer)));
+        manual_input_buffers_.insert(std::pair<std::string, std::shared_ptr<const DataBuffer>>(input_name, std::move(new_buffer)));
 
         nodes::AttributeBuffer& input_node = *this->get_attribute_input(input_name);
         input_node.set_output_type(data_type);
         input_node.input().set_accepts(data_type);
+        input_node.mark_changed();
 
         refresh_all_sockets();
     }
@@ -366,13 +433,148 @@ namespace noises
         if(it == manual_input_buffers_.end())
             return boost::none;
 
-        return std::ref(static_cast<const DataBuffer&>(*std::get<1>(*it)));
+        return std::ref(*std::get<1>(*it));
     }
 
     GraphOutputs Graph::execute() const
     {
-        GraphExecutor executor(*this);
-        return executor.execute();
+        GraphOutputs outputs;
+        with_executor([&outputs](GraphExecutor& executor) { outputs = executor.execute(); });
+        return outputs;
+    }
+
+    std::vector<GraphOutputs> Graph::execute_batch(const std::vector<InputUniformSet>& items) const
+    {
+        std::vector<GraphOutputs> outputs;
+        with_executor([&](GraphExecutor& executor) { outputs = executor.execute_batch(items); });
+        return outputs;
+    }
+
+    void Graph::with_executor(const std::function<void(GraphExecutor&)>& body) const
+    {
+        // Executing a graph doesn't change it, so several threads can do it at once. Only one of them gets the kept results
+        std::unique_lock<std::mutex> lock(kept_executor_->mutex, std::try_to_lock);
+        if(!lock.owns_lock())
+        {
+            GraphExecutor executor(*this);
+            body(executor);
+            return;
+        }
+
+        if(!kept_executor_->executor)
+        {
+            kept_executor_->executor.reset(new GraphExecutor(*this));
+            kept_executor_->executor->set_result_caching_enabled(kept_executor_->result_caching_enabled);
+        }
+
+        body(*kept_executor_->executor);
+    }
+
+    void Graph::set_result_caching_enabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(kept_executor_->mutex);
+        kept_executor_->result_caching_enabled = enabled;
+        if(kept_executor_->executor)
+            kept_executor_->executor->set_result_caching_enabled(enabled);
+    }
+
+    bool Graph::result_caching_enabled() const
+    {
+        std::lock_guard<std::mutex> lock(kept_executor_->mutex);
+        return kept_executor_->result_caching_enabled;
+    }
+
+    void Graph::clear_cached_results()
+    {
+        std::lock_guard<std::mutex> lock(kept_executor_->mutex);
+        if(kept_executor_->executor)
+            kept_executor_->executor->clear_cached_results();
+    }
+
+    std::future<GraphOutputs> Graph::execute_async() const
+    {
+        std::shared_ptr<const Graph> graph;
+        try
+        {
+            graph = snapshot();
+        }
+        catch(const NodeNotCopyable&)
+        {
+            // Executing the graph itself instead would race with changes to it
+            std::promise<GraphOutputs> failed;
+            failed.set_exception(std::current_exception());
+            return failed.get_future();
+        }
+
+        auto task = std::make_shared<std::packaged_task<GraphOutputs()>>([graph]()
+        {
+            GraphExecutor executor(*graph);
+            return executor.execute();
+        });
+        std::future<GraphOutputs> result = task->get_future();
+
+        run_in_background([task]() { (*task)(); });
+
+        return result;
+    }
+
+    std::shared_ptr<const Graph> Graph::snapshot() const
+    {
+        std::shared_ptr<Graph> copy = std::make_shared<Graph>();
+
+        for(const auto& node : nodes_)
+        {
+            copy->adopt_node(node->clone());
+        }
+
+        for(const auto& node : input_nodes_)
+        {
+            copy->input_nodes_.push_back(node->clone());
+        }
+
+        for(const auto& node : output_nodes_)
+        {
+            copy->output_nodes_.push_back(node->clone());
+        }
+
+        for(const auto& connection : connections_)
+        {
+            const OutputSocket& output = connection->output();
+            const InputSocket& input = connection->input();
+
+            GraphNode& output_node = *copy->get_node_by_id(output.parent()->id());
+            GraphNode& input_node = *copy->get_node_by_id(input.parent()->id());
+
+            copy->connect(output_node.output(output.name()), input_node.input(input.name()));
+            copy->connections_.back()->set_id(connection->id());
+        }
+
+        for(const Property& property : properties_.properties())
+        {
+            copy->properties_.add(property.name(), property.data_type()).copy_values_from(property);
+        }
+
+        // Connecting the copies changed their revisions, and an executor moved on to the snapshot (see GraphExecutor::set_graph) needs
+        // them to match the originals
+        for(std::size_t i = 0; i < nodes_.size(); i++)
+        {
+            copy->nodes_[i]->set_revision(nodes_[i]->revision());
+        }
+
+        for(std::size_t i = 0; i < input_nodes_.size(); i++)
+        {
+            copy->input_nodes_[i]->set_revision(input_nodes_[i]->revision());
+        }
+
+        for(std::size_t i = 0; i < output_nodes_.size(); i++)
+        {
+            copy->output_nodes_[i]->set_revision(output_nodes_[i]->revision());
+        }
+
+        copy->id_counter_ = id_counter_;
+        copy->manual_input_buffers_ = manual_input_buffers_;
+
+        return copy;
     }
 
     void Graph::refresh_after(GraphNode& node)
@@ -3,7 +3,11 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
+#include <future>
 #include <boost/optional.hpp>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
 #include <unordered_map>
 
@@ -14,10 +18,17 @@
 namespace noises
 {
     class GraphOutputs;
+    class GraphExecutor;
+    class InputUniformSet;
     class Graph
     {
     public:
         Graph();
+        ~Graph();
+
+        /** The nodes, connections and inputs move across. Results kept by execute() stay behind with the old graph. **/
+        Graph(Graph&& other);
+        Graph& operator=(Graph&& other);
 
         /** Simple way to add a node to the graph. **/
         template<typename T, typename... Args>
@@ -29,7 +40,17 @@ namespace noises
             return node_ref;
         }
 
-        /** Adds a graph node to the graph. Returns the id of the added node. **/
+        /** Adds a graph node to the graph. Returns the id of the added node. If T can be default constructed and is the node's actual
+         *  type, snapshot() copies the node by making another T (see GraphNode::clone). **/
+        template<typename T>
+        int add_node(std::unique_ptr<T> node)
+        {
+            set_default_clone_factory(*node, typename std::is_default_constructible<T>::type());
+            return add_node(std::unique_ptr<GraphNode>(std::move(node)));
+        }
+
+        /** Adds a graph node to the graph. Returns the id of the added node. The node can only be snapshotted if it overrides
+         *  GraphNode::clone or has a clone factory. **/
         int add_node(std::unique_ptr<GraphNode> node);
 
         /** Removes a graph node from the graph. The passed in reference is invalidated (the node is destroyed) **/
@@ -79,6 +100,7 @@ namespace noises
 
         void remove_property(const std::string& name);
         boost::optional<std::reference_wrapper<Property>> get_property_by_name(const std::string& name);
+        boost::optional<std::reference_wrapper<const Property>> get_property_by_name(const std::string& name) const;
 
         boost::optional<std::reference_wrapper<nodes::AttributeBuffer>> get_attribute_input(const std::string& name);
         boost::optional<std::reference_wrapper<nodes::AttributeBuffer>> get_attribute_output(const std::string& name);
@@ -120,16 +142,55 @@ namespace noises
 
         boost::optional<std::reference_wrapper<const DataBuffer>> get_input_buffer(const std::string& input_name) const;
 
+        /** Executes the graph with an executor that's kept with it, which only recalculates folded constants when something upstream of
+         *  them has changed (see GraphExecutor::set_constant_folding_enabled). With set_result_caching_enabled it keeps the other nodes'
+         *  results too. **/
         GraphOutputs execute() const;
 
+        /** Makes the executor execute() keeps hold on to the buffer of every pure node between executions, and only execute the nodes with
+         *  something upstream of them changed (see GraphExecutor::set_result_caching_enabled). That costs as much memory as all of those
+         *  buffers together, for as long as the graph lives or until clear_cached_results, so it's off by default. Waits for an execute()
+         *  running on another thread. **/
+        void set_result_caching_enabled(bool enabled);
+        bool result_caching_enabled() const;
+
+        /** Frees the results kept by execute(), e.g. while the graph isn't being edited for a while. **/
+        void clear_cached_results();
+
+        /** Executes a snapshot() of the graph on one of the library's background threads, with an executor of its own so several can run at
+         *  once. The graph can be changed straight away. If a node can't be copied for the snapshot (see GraphNode::clone), the future
+         *  holds NodeNotCopyable. **/
+        std::future<GraphOutputs> execute_async() const;
+
+        /** Executes the graph once for each set of input values, sharing the plan and buffers between them (see GraphExecutor::execute_batch). **/
+        std::vector<GraphOutputs> execute_batch(const std::vector<InputUniformSet>& items) const;
+
+        /** A copy of the graph as it is now, for executing on another thread while this one keeps being edited. Every node is copied
+         *  (see GraphNode::clone) with the same ids and revisions, along with the connections, graph inputs and properties; the input
+         *  values themselves are shared rather than copied, since setting an input replaces them. Copies of the pointer are cheap, and
+         *  the snapshot never changes. Throws NodeNotCopyable if a node can't be copied. **/
+        std::shared_ptr<const Graph> snapshot() const;
+
         void refresh_all_sockets();
 
         void refresh_after(GraphNode& node);
 
     private:
         void refresh_after_inner(GraphNode& node, std::size_t recursion_depth);
+        void adopt_node(std::unique_ptr<GraphNode> node);
         void remove_connection(const Connection& connection);
 
+        template<typename T>
+        static void set_default_clone_factory(T& node, std::true_type /* is_default_constructible */)
+        {
+            // A T that's really a derived node would be copied as just a T
+            if(typeid(node) == typeid(T))
+                node.set_clone_factory([]() { return std::unique_ptr<GraphNode>(new T()); });
+        }
+
+        template<typename T>
+        static void set_default_clone_factory(T&, std::false_type /* is_default_constructible */) { }
+
         template<typename TBuffer>
         boost::optional<std::reference_wrapper<TBuffer>> get_buffer(const std::string& name, std::vector<std::unique_ptr<GraphNode>>& buffer_list)
         {
@@ -150,7 +211,14 @@ namespace noises
 
         PropertyCollection properties_;
 
-        std::unordered_map<std::string, std::unique_ptr<DataBuffer>> manual_input_buffers_;
+        std::unordered_map<std::string, std::shared_ptr<const DataBuffer>> manual_input_buffers_;
+
+        // The executor execute() keeps between executions, so folded constants are only recalculated when something upstream changes
+        struct KeptExecutor;
+        std::unique_ptr<KeptExecutor> kept_executor_;
+
+        // Runs {body} with the kept executor, or with a new one if another thread is using it
+        void with_executor(const std::function<void(GraphExecutor&)>& body) const;
     };
 }
 
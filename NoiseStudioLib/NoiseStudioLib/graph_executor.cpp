@@ -1,22 +1,198 @@
 #include "graph_executor.h"
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
 #include <boost/format.hpp>
 
 #include "graph.h"
 #include "graph_node.h"
 #include "graph_validator.h"
 #include "composite_data_buffer.h"
+#include "parallel.h"
+
+namespace
+{
+    // Chunks of a grid are whole rows, or whole slices along the slower axes when they fit, so each one is a contiguous slab of the grid
+    std::size_t fused_chunk_length(const noises::GridInfo& grid, std::size_t length)
+    {
+        const std::size_t chunk_size = noises::GraphExecutor::fusion_chunk_size;
+
+        std::size_t slab = 1;
+        for(std::size_t axis = 0; axis < grid.rank(); axis++)
+        {
+            std::size_t next = slab * grid.extent(axis);
+            if(next == 0 || next > chunk_size)
+                break;
+
+            slab = next;
+        }
+
+        return std::max<std::size_t>(1, std::min(chunk_size / slab * slab, length));
+    }
+}
 
 namespace noises
 {
-    GraphExecutor::GraphExecutor(const Graph &graph) : graph_(graph)
+    const std::size_t GraphExecutor::fusion_chunk_size;
+
+    GraphExecutor::GraphExecutor(const Graph &graph) : graph_(&graph), input_overrides_(nullptr), recycle_buffers_(false), fusion_enabled_(true),
+        constant_folding_enabled_(true), grid_stride_(1), result_caching_enabled_(false), node_count_(0), nodes_completed_(0)
+    {
+
+    }
+
+    void GraphExecutor::set_constant_folding_enabled(bool enabled)
+    {
+        constant_folding_enabled_ = enabled;
+    }
+
+    bool GraphExecutor::constant_folding_enabled() const
+    {
+        return constant_folding_enabled_;
+    }
+
+    std::vector<int> GraphExecutor::folded_nodes() const
     {
+        return std::vector<int>(folded_this_execution_.begin(), folded_this_execution_.end());
+    }
 
+    void GraphExecutor::set_result_caching_enabled(bool enabled)
+    {
+        result_caching_enabled_ = enabled;
+        if(!enabled)
+            forget_cached_results();
+    }
+
+    bool GraphExecutor::result_caching_enabled() const
+    {
+        return result_caching_enabled_;
+    }
+
+    void GraphExecutor::clear_cached_results()
+    {
+        forget_cached_results();
+    }
+
+    void GraphExecutor::forget_cached_results()
+    {
+        for(auto it = kept_results_.begin(); it != kept_results_.end(); )
+        {
+            if(it->second.folded)
+                ++it;
+            else
+                it = kept_results_.erase(it);
+        }
+    }
+
+    std::vector<int> GraphExecutor::reused_nodes() const
+    {
+        return reused_nodes_;
+    }
+
+    void GraphExecutor::set_fusion_enabled(bool enabled)
+    {
+        fusion_enabled_ = enabled;
+    }
+
+    bool GraphExecutor::fusion_enabled() const
+    {
+        return fusion_enabled_;
+    }
+
+    void GraphExecutor::set_active_elements(const ActiveElements& elements)
+    {
+        // The elements that aren't active are left at zero, so none of the kept buffers are right any more
+        active_elements_ = elements;
+        forget_cached_results();
+    }
+
+    void GraphExecutor::clear_active_elements()
+    {
+        if(active_elements_)
+            forget_cached_results();
+
+        active_elements_ = boost::none;
+    }
+
+    void GraphExecutor::set_grid_stride(unsigned int stride)
+    {
+        if(stride == 0)
+            throw std::invalid_argument("Grid stride can't be 0.");
+
+        if(stride != grid_stride_)
+            forget_cached_results();
+
+        grid_stride_ = stride;
+    }
+
+    unsigned int GraphExecutor::grid_stride() const
+    {
+        return grid_stride_;
+    }
+
+    void GraphExecutor::set_cancellation_token(const CancellationToken& token)
+    {
+        cancellation_token_ = token;
+    }
+
+    void GraphExecutor::clear_cancellation_token()
+    {
+        cancellation_token_ = boost::none;
+    }
+
+    void GraphExecutor::throw_if_cancelled() const
+    {
+        if(cancellation_token_)
+            cancellation_token_->throw_if_cancelled();
+    }
+
+    void GraphExecutor::set_progress_callback(const ProgressCallback& callback)
+    {
+        progress_callback_ = callback;
+    }
+
+    void GraphExecutor::report_elements(int node_id, std::size_t& elements_processed, std::size_t elements, std::size_t element_count)
+    {
+        if(!progress_callback_)
+            return;
+
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        elements_processed += elements;
+        progress_callback_(ExecutionProgress { nodes_completed_, node_count_, node_id, elements_processed, element_count });
+    }
+
+    void GraphExecutor::report_node_done(const GraphNode& node, std::size_t element_count)
+    {
+        nodes_completed_ += get_group_members(node).size();
+
+        if(progress_callback_)
+            progress_callback_(ExecutionProgress { nodes_completed_, node_count_, node.id(), element_count, element_count });
+    }
+
+    bool GraphExecutor::is_masked(std::size_t attribute_length) const
+    {
+        return active_elements_ && active_elements_->length() == attribute_length;
+    }
+
+    std::vector<std::vector<int>> GraphExecutor::fused_groups() const
+    {
+        std::vector<std::vector<int>> out;
+        for(auto& pair : fused_groups_)
+        {
+            out.push_back(pair.second);
+        }
+        return out;
     }
 
     const Graph& GraphExecutor::graph()
     {
-        return graph_;
+        return *graph_;
+    }
+
+    void GraphExecutor::set_graph(const Graph& graph)
+    {
+        graph_ = &graph;
     }
 
     GraphOutputs GraphExecutor::execute()
@@ -25,12 +201,195 @@ namespace noises
         if(!validation)
             throw std::logic_error("Could not execute graph. It is invalid.");
 
+        plan_execution();
+        return execute_planned();
+    }
+
+    void GraphExecutor::plan_execution()
+    {
+        upstream_revisions_.clear();
+        fold_constants();
+        find_fused_groups();
+    }
+
+    GraphOutputs GraphExecutor::execute_planned()
+    {
+        find_kept_results();
         get_topological_order();
+
+        // Output buffers of the previous execution are left in the bottom level
+        buffer_stack_.clear();
         buffer_stack_.resize(topological_order_.size());
 
+        // The bottom level of the order isn't executed
+        node_count_ = 0;
+        nodes_completed_ = 0;
+        for(std::size_t level = 1; level < topological_order_.size(); level++)
+        {
+            for(int node_id : topological_order_[level])
+            {
+                node_count_ += get_group_members(*graph_->get_node_by_id(node_id)).size();
+            }
+        }
+
         return execute_internal();
     }
 
+    std::future<GraphOutputs> GraphExecutor::execute_async()
+    {
+        // std::function has to be copyable, the task isn't
+        auto task = std::make_shared<std::packaged_task<GraphOutputs()>>([this]() { return execute(); });
+        std::future<GraphOutputs> result = task->get_future();
+
+        run_in_background([task]() { (*task)(); });
+
+        return result;
+    }
+
+    std::vector<GraphOutputs> GraphExecutor::execute_batch(const std::vector<InputUniformSet>& items)
+    {
+        auto validation = validate_graph();
+        if(!validation)
+            throw std::logic_error("Could not execute graph. It is invalid.");
+
+        for(const InputUniformSet& item : items)
+        {
+            check_batch_item(item);
+        }
+
+        std::vector<GraphOutputs> outputs(items.size());
+        if(items.empty())
+            return outputs;
+
+        // Goes back to normal executions however the batch ends
+        struct BatchScope
+        {
+            GraphExecutor& executor;
+
+            ~BatchScope()
+            {
+                executor.input_overrides_ = nullptr;
+                executor.batch_inputs_.clear();
+                executor.recycle_buffers_ = false;
+                executor.spare_buffers_.clear();
+            }
+        } batch_scope { *this };
+
+        for(const InputUniformSet& item : items)
+        {
+            for(const auto& pair : item.buffers())
+            {
+                batch_inputs_.insert(pair.first);
+            }
+        }
+
+        recycle_buffers_ = true;
+        plan_execution();
+
+        outputs[0] = execute_batch_item(items[0]);
+
+        std::size_t longest = 0;
+        for(auto& pair : outputs[0].buffers())
+        {
+            longest = std::max(longest, pair.second.get().attribute_info().length());
+        }
+
+        std::size_t thread_count = parallel_thread_count();
+        if(items.size() == 1 || thread_count == 1 || longest >= fusion_chunk_size * thread_count)
+        {
+            for(std::size_t i = 1; i < items.size(); i++)
+            {
+                outputs[i] = execute_batch_item(items[i]);
+            }
+            return outputs;
+        }
+
+        // Each item only keeps a few threads busy, so run the rest side by side instead. Every thread has an executor of its own, planned
+        // the first time it's used and kept for the thread's next item like this one is. Their chunks run on the item's thread
+        std::vector<std::unique_ptr<GraphExecutor>> idle_executors;
+        std::mutex idle_mutex;
+
+        parallel_for(items.size() - 1, 1, [&](std::size_t begin, std::size_t end)
+        {
+            std::unique_ptr<GraphExecutor> executor;
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                if(!idle_executors.empty())
+                {
+                    executor = std::move(idle_executors.back());
+                    idle_executors.pop_back();
+                }
+            }
+
+            if(!executor)
+            {
+                executor.reset(new GraphExecutor(*graph_));
+                executor->fusion_enabled_ = fusion_enabled_;
+                executor->constant_folding_enabled_ = constant_folding_enabled_;
+                executor->active_elements_ = active_elements_;
+                executor->grid_stride_ = grid_stride_;
+                executor->cancellation_token_ = cancellation_token_;
+                executor->result_caching_enabled_ = result_caching_enabled_;
+                executor->batch_inputs_ = batch_inputs_;
+                executor->recycle_buffers_ = true;
+                executor->plan_execution();
+            }
+
+            for(std::size_t i = begin; i < end; i++)
+            {
+                outputs[i + 1] = executor->execute_batch_item(items[i + 1]);
+            }
+
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            idle_executors.push_back(std::move(executor));
+        });
+
+        return outputs;
+    }
+
+    GraphOutputs GraphExecutor::execute_batch_item(const InputUniformSet& item)
+    {
+        input_overrides_ = &item.buffers();
+        return execute_planned();
+    }
+
+    void GraphExecutor::check_batch_item(const InputUniformSet& item) const
+    {
+        for(const auto& pair : item.buffers())
+        {
+            const std::string& input_name = pair.first;
+
+            const GraphNode* input_node = nullptr;
+            for(const GraphNode& node : graph_->input_nodes())
+            {
+                if(node.name() == input_name)
+                    input_node = &node;
+            }
+
+            if(!input_node)
+                throw std::invalid_argument(input_name + " is not a valid input.");
+
+            const OutputSocket& socket = input_node->output("Output");
+            if(socket.type() != SocketType::uniform)
+                throw std::invalid_argument(input_name + " is not a uniform argument.");
+
+            if(!graph_->get_input_buffer(input_name) || pair.second->get_uniform_type(0) != socket.data_type())
+                throw std::invalid_argument(input_name + " has to be set on the graph first, with the same type as the batch uses.");
+        }
+    }
+
+    boost::optional<std::reference_wrapper<const DataBuffer>> GraphExecutor::get_input_buffer(const std::string& input_name) const
+    {
+        if(input_overrides_)
+        {
+            auto found = input_overrides_->find(input_name);
+            if(found != input_overrides_->end())
+                return std::cref(*found->second);
+        }
+
+        return graph_->get_input_buffer(input_name);
+    }
+
     GraphOutputs GraphExecutor::execute_internal()
     {
         while(buffer_stack_.size() > 1)
@@ -39,17 +398,27 @@ namespace noises
 
             for(int node_id : current_nodes_to_calculate)
             {
+                throw_if_cancelled();
                 execute_node(node_id);
             }
 
-            // Release any memory we don't need any more
+            // Release any memory we don't need any more, unless it's a result to keep or the next item of a batch can use it
+            for(auto& pair : buffer_stack_.back())
+            {
+                auto kept = kept_results_.find(pair.first);
+                if(kept != kept_results_.end())
+                    kept->second.buffer = std::move(pair.second);
+                else if(recycle_buffers_)
+                    spare_buffers_[pair.first] = std::move(pair.second);
+            }
+
             topological_order_.pop_back();
             buffer_stack_.pop_back();
         }
 
         GraphOutputs outputs;
 
-        for(const GraphNode& output : graph_.output_nodes())
+        for(const GraphNode& output : graph_->output_nodes())
         {
             // Attribute length is irrelevant here
             outputs.add(output.name(), extract_buffer(get_buffer(output.id())));
@@ -60,10 +429,27 @@ namespace noises
 
     void GraphExecutor::execute_node(int node_id)
     {
-        const GraphNode& node = *graph_.get_node_by_id(node_id);
+        if(reusable_this_execution_.count(node_id) != 0)
+        {
+            // Nothing upstream of it has changed, so get_buffer hands back the kept buffer
+            DataBuffer& kept_buffer = get_buffer(node_id);
+            reused_nodes_.push_back(node_id);
+            report_node_done(*graph_->get_node_by_id(node_id), kept_buffer.attribute_info().length());
+            return;
+        }
+
+        auto fused_group = fused_groups_.find(node_id);
+        if(fused_group != fused_groups_.end())
+        {
+            execute_fused_group(fused_group->second);
+            return;
+        }
+
+        const GraphNode& node = *graph_->get_node_by_id(node_id);
         auto buffers = get_node_dependency_buffers(node);
 
         CompositeDataBuffer input_buffer;
+        input_buffer.set_grid_stride(grid_stride_);
         std::vector<unsigned char> empty_buffer;
 
         add_attribute_dependencies(input_buffer, node, buffers, empty_buffer);
@@ -71,16 +457,480 @@ namespace noises
 
         DataBuffer& output_buffer = get_buffer(node.id(), input_buffer.attribute_info());
 
-        output_buffer.add(node.outputs());
-
+        // A buffer kept from the last item of a batch already has them
+        if(output_buffer.num_attributes() == 0 && output_buffer.num_uniforms() == 0)
+            output_buffer.add(node.outputs());
 
         node.execute_uniforms(input_buffer, output_buffer);
 
         DataBuffer::size_type attribute_length = output_buffer.attribute_info().length();
 
-        for(DataBuffer::size_type i = 0; i < attribute_length; i++)
+        if(node.is_elementwise())
+        {
+            // A chunk at a time like a fused group, so a big attribute can be cancelled part way through and reports its progress
+            bool masked = is_masked(attribute_length);
+            std::size_t chunk_length = fused_chunk_length(output_buffer.attribute_info().grid(), attribute_length);
+            std::size_t elements_processed = 0;
+
+            parallel_for(attribute_length, chunk_length, [&](std::size_t begin, std::size_t end)
+            {
+                throw_if_cancelled();
+
+                if(masked)
+                {
+                    active_elements_->for_each_range(begin, end, [&](std::size_t range_begin, std::size_t range_end)
+                    {
+                        node.execute_attribute_range(input_buffer, output_buffer, range_begin, range_end);
+                    });
+                }
+                else
+                {
+                    node.execute_attribute_range(input_buffer, output_buffer, begin, end);
+                }
+
+                report_elements(node.id(), elements_processed, end - begin, attribute_length);
+            });
+        }
+        else
         {
-            node.execute_attributes(input_buffer, output_buffer, i);
+            node.execute_attribute_range(input_buffer, output_buffer, 0, attribute_length);
+        }
+
+        report_node_done(node, attribute_length);
+    }
+
+    void GraphExecutor::fold_constants()
+    {
+        // Results for nodes that were removed or can't be folded any more are dropped by find_kept_results
+        folded_this_execution_.clear();
+
+        if(!constant_folding_enabled_)
+            return;
+
+        std::unordered_map<int, bool> foldable;
+        std::unordered_set<int> visited;
+
+        for(const GraphNode& output : graph_->output_nodes())
+        {
+            fold_constants_upstream_of(output, foldable, visited);
+        }
+    }
+
+    void GraphExecutor::fold_constants_upstream_of(const GraphNode& node, std::unordered_map<int, bool>& foldable, std::unordered_set<int>& visited)
+    {
+        if(!visited.insert(node.id()).second)
+            return;
+
+        for(const InputSocket& socket : node.inputs().all_sockets())
+        {
+            auto possible_connection = socket.connection();
+            if(!possible_connection)
+                continue;
+
+            const GraphNode& dependency = *possible_connection->get().output().parent();
+
+            if(is_foldable(dependency, foldable))
+                evaluate_folded(dependency);
+            else
+                fold_constants_upstream_of(dependency, foldable, visited);
+        }
+    }
+
+    bool GraphExecutor::is_foldable(const GraphNode& node, std::unordered_map<int, bool>& foldable) const
+    {
+        auto found = foldable.find(node.id());
+        if(found != foldable.end())
+            return found->second;
+
+        foldable[node.id()] = false;
+
+        // Output nodes have to stay in the normal execution so their buffers can be handed out
+        for(const GraphNode& output : graph_->output_nodes())
+        {
+            if(output.id() == node.id())
+                return false;
+        }
+
+        if(!node.is_pure() || node.outputs().all_sockets().empty() || !node.outputs().attribute_sockets().empty())
+            return false;
+
+        // A batch changes these inputs without changing their revisions
+        if(node.is_graph_internal_node() && batch_inputs_.count(node.name()) != 0)
+            return false;
+
+        for(const InputSocket& socket : node.inputs().all_sockets())
+        {
+            auto possible_connection = socket.connection();
+            if(!possible_connection)
+                continue;
+
+            const OutputSocket& dependency_socket = possible_connection->get().output();
+            if(dependency_socket.type() != SocketType::uniform || !is_foldable(*dependency_socket.parent(), foldable))
+                return false;
+        }
+
+        foldable[node.id()] = true;
+        return true;
+    }
+
+    DataBuffer& GraphExecutor::evaluate_folded(const GraphNode& node)
+    {
+        if(folded_this_execution_.count(node.id()) != 0)
+            return *kept_results_.at(node.id()).buffer;
+
+        std::unordered_map<int, std::reference_wrapper<DataBuffer>> buffers;
+        for(int dependency_id : get_node_dependencies(node))
+        {
+            const GraphNode& dependency = *graph_->get_node_by_id(dependency_id);
+            buffers.emplace(dependency_id, std::ref(evaluate_folded(dependency)));
+        }
+
+        // Foldable nodes are pure and only depend on other foldable nodes, so they always have upstream revisions
+        const UpstreamRevisions& upstream_revisions = *get_upstream_revisions(node);
+
+        folded_this_execution_.insert(node.id());
+
+        KeptResult& folded = kept_results_[node.id()];
+        folded.folded = true;
+        if(folded.buffer && folded.upstream_revisions == upstream_revisions)
+            return *folded.buffer;
+
+        CompositeDataBuffer input_buffer;
+        std::vector<unsigned char> empty_buffer;
+
+        add_attribute_dependencies(input_buffer, node, buffers, empty_buffer);
+        add_uniform_dependencies(input_buffer, node, buffers);
+
+        std::unique_ptr<DataBuffer> buffer(new DataBuffer(AttributeInfo()));
+        buffer->add(node.outputs());
+        node.execute_uniforms(input_buffer, *buffer);
+
+        folded.buffer = std::move(buffer);
+        folded.upstream_revisions = upstream_revisions;
+        return *folded.buffer;
+    }
+
+    void GraphExecutor::find_kept_results()
+    {
+        reusable_this_execution_.clear();
+        reused_nodes_.clear();
+
+        // Folded constants were brought up to date by fold_constants. Nodes that were removed, or can't be folded or kept any more,
+        // lose their entries
+        std::unordered_map<int, KeptResult> kept_results;
+        for(int node_id : folded_this_execution_)
+        {
+            kept_results[node_id] = std::move(kept_results_.at(node_id));
+        }
+
+        if(result_caching_enabled_)
+        {
+            for(const GraphNode& output : graph_->output_nodes())
+            {
+                for(const InputSocket& socket : output.inputs().all_sockets())
+                {
+                    auto possible_connection = socket.connection();
+                    if(possible_connection)
+                        get_upstream_revisions(*possible_connection->get().output().parent());
+                }
+            }
+
+            // Only the last node of a fused group has a buffer to keep
+            std::unordered_set<int> not_kept(folded_this_execution_);
+            for(const auto& pair : fused_groups_)
+            {
+                not_kept.insert(pair.second.begin(), pair.second.end() - 1);
+            }
+
+            for(const auto& pair : upstream_revisions_)
+            {
+                if(!pair.second || not_kept.count(pair.first) != 0)
+                    continue;
+
+                KeptResult& kept = kept_results[pair.first];
+                kept.upstream_revisions = *pair.second;
+
+                // Nodes that changed lose their buffers
+                auto previous = kept_results_.find(pair.first);
+                if(previous != kept_results_.end() && previous->second.buffer && previous->second.upstream_revisions == kept.upstream_revisions)
+                {
+                    kept.buffer = std::move(previous->second.buffer);
+                    reusable_this_execution_.insert(pair.first);
+                }
+            }
+        }
+
+        kept_results_ = std::move(kept_results);
+    }
+
+    const boost::optional<GraphExecutor::UpstreamRevisions>& GraphExecutor::get_upstream_revisions(const GraphNode& node)
+    {
+        auto found = upstream_revisions_.find(node.id());
+        if(found != upstream_revisions_.end())
+            return found->second;
+
+        // A batch changes these inputs without changing their revisions
+        bool keepable = node.is_pure() && !(node.is_graph_internal_node() && batch_inputs_.count(node.name()) != 0);
+        UpstreamRevisions upstream_revisions(1, std::make_pair(node.id(), node.revision()));
+
+        // Carries on past nodes that can't be kept, so everything upstream of the outputs gets an entry
+        for(const InputSocket& socket : node.inputs().all_sockets())
+        {
+            auto possible_connection = socket.connection();
+            if(!possible_connection)
+                continue;
+
+            const boost::optional<UpstreamRevisions>& dependency_revisions = get_upstream_revisions(*possible_connection->get().output().parent());
+            if(dependency_revisions)
+                upstream_revisions.insert(upstream_revisions.end(), dependency_revisions->begin(), dependency_revisions->end());
+            else
+                keepable = false;
+        }
+
+        boost::optional<UpstreamRevisions>& out = upstream_revisions_[node.id()];
+        if(keepable)
+        {
+            std::sort(upstream_revisions.begin(), upstream_revisions.end());
+            upstream_revisions.erase(std::unique(upstream_revisions.begin(), upstream_revisions.end()), upstream_revisions.end());
+            out = std::move(upstream_revisions);
+        }
+        return out;
+    }
+
+    void GraphExecutor::find_fused_groups()
+    {
+        fused_groups_.clear();
+
+        if(!fusion_enabled_)
+            return;
+
+        // Every element-wise node that can't be folded into its consumer ends a group
+        for(const GraphNode& node : graph_->nodes())
+        {
+            if(!node.is_elementwise() || is_fusable_into_consumer(node))
+                continue;
+
+            std::vector<int> group;
+            add_fused_group_members(node, group);
+
+            if(group.size() > 1)
+                fused_groups_.emplace(node.id(), std::move(group));
+        }
+    }
+
+    bool GraphExecutor::is_fusable_into_consumer(const GraphNode& node) const
+    {
+        if(!node.is_elementwise() || node.is_graph_internal_node())
+            return false;
+
+        // The output can't be needed anywhere except the consumer, otherwise it has to be materialized anyway
+        auto outputs = node.outputs().all_sockets();
+        if(outputs.size() != 1)
+            return false;
+
+        const OutputSocket& output = outputs[0];
+        if(output.type() != SocketType::attribute || output.connections().size() != 1)
+            return false;
+
+        const GraphNode* consumer = output.connections()[0].get().input().parent();
+        return consumer->is_elementwise() && !consumer->is_graph_internal_node();
+    }
+
+    void GraphExecutor::add_fused_group_members(const GraphNode& node, std::vector<int>& group) const
+    {
+        // Dependencies first, so the group is in execution order
+        for(const InputSocket& socket : node.inputs().all_sockets())
+        {
+            auto possible_connection = socket.connection();
+            if(!possible_connection)
+                continue;
+
+            const GraphNode& dependency = *possible_connection->get().output().parent();
+            if(is_fusable_into_consumer(dependency))
+                add_fused_group_members(dependency, group);
+        }
+
+        group.push_back(node.id());
+    }
+
+    void GraphExecutor::execute_fused_group(const std::vector<int>& group)
+    {
+        const GraphNode& last = *graph_->get_node_by_id(group.back());
+        auto buffers = get_node_dependency_buffers(last);
+
+        // All of the attributes coming into the group are the same length. Keep the one that says it's a grid if there is one, so the
+        // members that care (e.g. the mappings) know where in the grid each chunk is
+        AttributeInfo attribute_info;
+        for(int node_id : group)
+        {
+            for(const InputSocket& socket : graph_->get_node_by_id(node_id)->get().inputs().attribute_sockets())
+            {
+                auto possible_connection = socket.connection();
+                if(!possible_connection)
+                    continue;
+
+                auto dependency = buffers.find(possible_connection->get().output().parent()->id());
+                if(dependency != buffers.end() && attribute_info.grid().rank() == 0)
+                    attribute_info = dependency->second.get().attribute_info();
+            }
+        }
+
+        std::size_t length = attribute_info.length();
+        std::size_t chunk_length = fused_chunk_length(attribute_info.grid(), length);
+
+        DataBuffer& output_buffer = get_buffer(last.id(), attribute_info);
+        if(output_buffer.num_attributes() == 0 && output_buffer.num_uniforms() == 0)
+            output_buffer.add(last.outputs());
+
+        // Chunks run in parallel, each with a set of chunk buffers no other chunk is using at the time. Intermediate results only ever
+        // exist a chunk per thread at a time, and a set is reused by the next chunk so the uniforms are only executed once per set
+        typedef std::vector<std::unique_ptr<DataBuffer>> ChunkBuffers;
+        std::vector<ChunkBuffers> idle_chunk_buffers;
+        std::mutex idle_mutex;
+
+        bool masked = is_masked(length);
+        std::size_t elements_processed = 0;
+
+        auto execute_chunk = [&](std::size_t begin, std::size_t end)
+        {
+            throw_if_cancelled();
+
+            // The parts of the chunk to calculate, relative to the chunk
+            std::vector<ActiveElements::Range> ranges;
+            if(masked)
+            {
+                active_elements_->for_each_range(begin, end, [&](std::size_t range_begin, std::size_t range_end)
+                {
+                    ranges.emplace_back(range_begin - begin, range_end - begin);
+                });
+
+                // Nothing to calculate, but the chunk still counts as processed, as it does for unfused nodes
+                if(ranges.empty() && begin != end)
+                {
+                    report_elements(last.id(), elements_processed, end - begin, length);
+                    return;
+                }
+            }
+            else if(begin != end)
+            {
+                ranges.emplace_back(0, end - begin);
+            }
+
+            ChunkBuffers chunk_buffers;
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                if(!idle_chunk_buffers.empty())
+                {
+                    chunk_buffers = std::move(idle_chunk_buffers.back());
+                    idle_chunk_buffers.pop_back();
+                }
+            }
+
+            bool new_buffers = chunk_buffers.empty();
+            if(new_buffers)
+            {
+                for(int node_id : group)
+                {
+                    chunk_buffers.emplace_back(new DataBuffer(AttributeInfo(chunk_length, attribute_info.tag())));
+                    chunk_buffers.back()->add(graph_->get_node_by_id(node_id)->get().outputs());
+                }
+            }
+
+            std::size_t count = end - begin;
+            AttributeInfo chunk_info(count, attribute_info.tag(), attribute_info.grid().part(begin));
+            std::vector<unsigned char> empty_buffer;
+
+            for(std::size_t i = 0; i < group.size(); i++)
+            {
+                const GraphNode& node = *graph_->get_node_by_id(group[i]);
+                chunk_buffers[i]->resize_attribute(chunk_info);
+
+                CompositeDataBuffer input_buffer;
+                input_buffer.set_grid_stride(grid_stride_);
+                add_chunk_attribute_dependencies(input_buffer, node, group, chunk_buffers, buffers, begin, count, empty_buffer);
+                add_uniform_dependencies(input_buffer, node, buffers);
+
+                if(new_buffers)
+                    node.execute_uniforms(input_buffer, *chunk_buffers[i]);
+
+                for(const ActiveElements::Range& range : ranges)
+                {
+                    node.execute_attribute_range(input_buffer, *chunk_buffers[i], range.first, range.second);
+                }
+            }
+
+            const DataBuffer& last_chunk_buffer = *chunk_buffers.back();
+            for(const OutputSocket& socket : last.outputs().attribute_sockets())
+            {
+                std::size_t value_size = socket.data_type().size_full();
+                const std::vector<unsigned char>& chunk = last_chunk_buffer.get_memory_block(socket.index());
+                unsigned char* destination = output_buffer.get_attribute_all_raw(socket.index());
+
+                for(const ActiveElements::Range& range : ranges)
+                {
+                    std::memcpy(destination + (begin + range.first) * value_size, chunk.data() + range.first * value_size,
+                                (range.second - range.first) * value_size);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                idle_chunk_buffers.push_back(std::move(chunk_buffers));
+            }
+
+            if(begin != end)
+                report_elements(last.id(), elements_processed, end - begin, length);
+        };
+
+        parallel_for(length, chunk_length, execute_chunk);
+
+        // The uniforms still need executing when there are no attributes, or none of them are active
+        if(idle_chunk_buffers.empty())
+            execute_chunk(0, 0);
+
+        const DataBuffer& last_chunk_buffer = *idle_chunk_buffers.front().back();
+        for(const OutputSocket& socket : last.outputs().uniform_sockets())
+        {
+            output_buffer.set_uniform_raw(socket, socket.data_type(), last_chunk_buffer.get_uniform_raw(socket, socket.data_type()));
+        }
+
+        report_node_done(last, length);
+    }
+
+    void GraphExecutor::add_chunk_attribute_dependencies(CompositeDataBuffer &input_buffer, const GraphNode &node, const std::vector<int>& group,
+                                                         const std::vector<std::unique_ptr<DataBuffer>>& chunk_buffers,
+                                                         std::unordered_map<int, std::reference_wrapper<DataBuffer>>& buffers,
+                                                         std::size_t begin, std::size_t length, std::vector<unsigned char>& empty_buffer)
+    {
+        AttributeInfo chunk_info(length);
+
+        for(const InputSocket& attribute_socket : node.inputs().attribute_sockets())
+        {
+            auto possible_connection = attribute_socket.connection();
+            if(!possible_connection)
+            {
+                input_buffer.add_attribute(ConnectionDataType::undefined(), empty_buffer, AttributeInfo());
+                continue;
+            }
+
+            const Connection& connection = *possible_connection;
+            const OutputSocket& output_socket = connection.output();
+            int dependency_id = output_socket.parent()->id();
+            std::size_t value_size = connection.data_type().size_full();
+
+            auto member = std::find(group.begin(), group.end(), dependency_id);
+            if(member != group.end())
+            {
+                // Produced earlier in this chunk
+                const DataBuffer& chunk_buffer = *chunk_buffers[member - group.begin()];
+                input_buffer.add_attribute(connection.data_type(), chunk_buffer.get_memory_block(output_socket.index()).data(), length * value_size, chunk_info);
+            }
+            else
+            {
+                const DataBuffer& dependency_buffer = buffers.at(dependency_id);
+                const std::vector<unsigned char>& block = dependency_buffer.get_memory_block(output_socket.index());
+                input_buffer.add_attribute(connection.data_type(), block.data() + begin * value_size, length * value_size, chunk_info);
+            }
         }
     }
 
@@ -98,7 +948,8 @@ namespace noises
                 int dependency_id = dependency_node->id();
 
                 DataBuffer& dependency_buffer = buffers.at(dependency_id);
-                input_buffer.add_attribute(connection.data_type(), dependency_buffer.get_memory_block(output_socket.index()), dependency_buffer.attribute_info());
+                input_buffer.add_attribute(connection.data_type(), dependency_buffer.get_memory_block(output_socket.index()), dependency_buffer.attribute_info(),
+                                           attribute_socket.independent_length());
                 continue;
             }
 
@@ -109,11 +960,12 @@ namespace noises
                 continue;
             }
 
-            auto graph_input = graph_.get_input_buffer(node.name());
+            auto graph_input = get_input_buffer(node.name());
             if(graph_input)
             {
                 const DataBuffer& input_attribute_buffer = graph_input->get();
-                input_buffer.add_attribute(input_attribute_buffer.get_attribute_type(0), input_attribute_buffer.get_memory_block(0), input_attribute_buffer.attribute_info());
+                input_buffer.add_attribute(input_attribute_buffer.get_attribute_type(0), input_attribute_buffer.get_memory_block(0), input_attribute_buffer.attribute_info(),
+                                           attribute_socket.independent_length());
             }
             else
             {
@@ -148,7 +1000,7 @@ namespace noises
                 continue;
             }
 
-            auto graph_input = graph_.get_input_buffer(node.name());
+            auto graph_input = get_input_buffer(node.name());
             if(graph_input)
             {
                 const DataBuffer& input_uniform_buffer = graph_input->get();
@@ -174,22 +1026,65 @@ namespace noises
             out.emplace(std::make_pair(dependency_id, std::ref(buffer)));
         }
 
+        // Folded constants aren't in the topological order, their buffers are kept by the executor
+        for(int member_id : get_group_members(node))
+        {
+            for(const InputSocket& socket : graph_->get_node_by_id(member_id)->get().inputs().all_sockets())
+            {
+                auto possible_connection = socket.connection();
+                if(!possible_connection)
+                    continue;
+
+                int dependency_id = possible_connection->get().output().parent()->id();
+                if(folded_this_execution_.count(dependency_id) != 0)
+                    out.emplace(std::make_pair(dependency_id, std::ref(*kept_results_.at(dependency_id).buffer)));
+            }
+        }
+
         return out;
     }
 
+    std::vector<int> GraphExecutor::get_group_members(const GraphNode& node) const
+    {
+        auto fused_group = fused_groups_.find(node.id());
+        if(fused_group != fused_groups_.end())
+            return fused_group->second;
+
+        return std::vector<int>(1, node.id());
+    }
+
     std::vector<int> GraphExecutor::get_node_dependencies(const GraphNode& node)
     {
+        // A kept buffer doesn't need anything upstream of it
+        if(reusable_this_execution_.count(node.id()) != 0)
+            return std::vector<int>();
+
+        // A fused group depends on everything its members depend on, apart from the members themselves
+        std::vector<int> group = get_group_members(node);
+
         std::vector<int> out;
-        for(const InputSocket& socket : node.inputs().all_sockets())
+        for(int member_id : group)
         {
-            auto possible_connection = socket.connection();
-            if(possible_connection)
+            const GraphNode& member = *graph_->get_node_by_id(member_id);
+
+            for(const InputSocket& socket : member.inputs().all_sockets())
             {
-                const Connection& connection = *possible_connection;
-                int dependency_id = connection.output().parent()->id();
+                auto possible_connection = socket.connection();
+                if(possible_connection)
+                {
+                    const Connection& connection = *possible_connection;
+                    int dependency_id = connection.output().parent()->id();
+
+                    if(std::find(group.begin(), group.end(), dependency_id) != group.end())
+                        continue;
 
-                if(std::find(out.begin(), out.end(), dependency_id) == out.end())
-                    out.push_back(dependency_id);
+                    // Already calculated by fold_constants
+                    if(folded_this_execution_.count(dependency_id) != 0)
+                        continue;
+
+                    if(std::find(out.begin(), out.end(), dependency_id) == out.end())
+                        out.push_back(dependency_id);
+                }
             }
         }
         return out;
@@ -245,8 +1140,25 @@ namespace noises
 
         if(it_q == buffer_level.end())
         {
-            // We need to allocate a new buffer
-            std::unique_ptr<DataBuffer> buffer(new DataBuffer(buffer_attribute_info));
+            // We need to allocate a new buffer, unless the node's result was kept from the last execution or its buffer from the last
+            // item of a batch is spare
+            std::unique_ptr<DataBuffer> buffer;
+            auto spare = spare_buffers_.find(node_id);
+            if(reusable_this_execution_.count(node_id) != 0)
+            {
+                buffer = std::move(kept_results_.at(node_id).buffer);
+            }
+            else if(spare != spare_buffers_.end())
+            {
+                buffer = std::move(spare->second);
+                spare_buffers_.erase(spare);
+                buffer->reset(buffer_attribute_info);
+            }
+            else
+            {
+                buffer.reset(new DataBuffer(buffer_attribute_info));
+            }
+
             DataBuffer& buffer_ref = *buffer;
 
             auto pair = std::make_pair(node_id, std::move(buffer));
@@ -285,7 +1197,7 @@ namespace noises
 
     ValidationResults GraphExecutor::validate_graph() const
     {
-        GraphValidator validator(graph_);
+        GraphValidator validator(*graph_);
         return validator.validate();
     }
 
@@ -297,7 +1209,7 @@ namespace noises
         out.push_back(std::vector<int>());
 
         std::vector<int> root;
-        for(const GraphNode& output_node : graph_.output_nodes())
+        for(const GraphNode& output_node : graph_->output_nodes())
         {
             root.push_back(output_node.id());
         }
@@ -310,21 +1222,12 @@ namespace noises
 
             for(int node_id : out.back())
             {
-                const GraphNode& node = *graph_.get_node_by_id(node_id);
+                const GraphNode& node = *graph_->get_node_by_id(node_id);
 
-                for(const InputSocket& socket : node.inputs().all_sockets())
+                for(int id : get_node_dependencies(node))
                 {
-                    auto possible_connection = socket.connection();
-                    if(possible_connection)
-                    {
-                        const Connection& connection = *possible_connection;
-                        const GraphNode* connection_output = connection.output().parent();
-
-                        int id = connection_output->id();
-
-                        if(std::find(next_stack_layer.begin(), next_stack_layer.end(), id) == next_stack_layer.end())
-                            next_stack_layer.push_back(id);
-                    }
+                    if(std::find(next_stack_layer.begin(), next_stack_layer.end(), id) == next_stack_layer.end())
+                        next_stack_layer.push_back(id);
                 }
             }
 
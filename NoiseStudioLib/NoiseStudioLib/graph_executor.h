@@ -4,8 +4,18 @@
 #include "graph_outputs.h"
 #include "validation_results.h"
 #include "data_buffer.h"
+#include "active_elements.h"
+#include "cancellation_token.h"
+#include "input_uniform_set.h"
 
 #include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/optional.hpp>
 
 namespace noises
 {
@@ -13,6 +23,18 @@ namespace noises
     class GraphNode;
     class CompositeDataBuffer;
 
+    /** How far an execute() has got. Fused groups count as all of their members, and report their progress as the last member. **/
+    struct ExecutionProgress
+    {
+        std::size_t nodes_completed;
+        std::size_t node_count;
+
+        // The node being calculated, or the one that just finished
+        int node_id;
+        std::size_t elements_processed;
+        std::size_t element_count;
+    };
+
     class GraphExecutor
     {
     public:
@@ -20,15 +42,105 @@ namespace noises
 
         const Graph& graph();
 
+        /** Executes {graph} from now on, e.g. a newer Graph::snapshot of the graph it was executing. Snapshots keep the revisions of the
+         *  nodes they copy, so folded constants and kept results carry over for every node that hasn't changed since. **/
+        void set_graph(const Graph& graph);
+
         ValidationResults validate_graph() const;
         GraphOutputs execute();
 
+        /** Runs execute() on one of the library's background threads (see run_in_background). Anything it throws comes out of the future's
+         *  get(). The executor and the graph have to be left alone until the future is ready. **/
+        std::future<GraphOutputs> execute_async();
+
+        /** Executes the graph once per item, with the item's values in place of the graph's own for those uniform inputs, and returns the
+         *  outputs in the same order. The graph is validated and planned once, and each node's buffers are reused from one item to the
+         *  next. Items too small to give every thread a chunk (see fusion_chunk_size) run side by side, each on a thread of its own; the
+         *  progress callback only hears about the items that run one at a time. Every input an item sets needs a value of the same type
+         *  set on the graph already, since that's what decides the graph's types. **/
+        std::vector<GraphOutputs> execute_batch(const std::vector<InputUniformSet>& items);
+
+        /** Runs groups of element-wise nodes (see GraphNode::is_elementwise) that feed each other through single-consumer attribute outputs
+         *  a chunk at a time, so only the last node of each group gets a full-size buffer. On by default; turn it off to debug a node. **/
+        void set_fusion_enabled(bool enabled);
+        bool fusion_enabled() const;
+
+        /** The groups fused by the last execute(), each in execution order (the last node is the one whose output is kept). **/
+        std::vector<std::vector<int>> fused_groups() const;
+
+        /** Number of elements each fused group (or element-wise node on its own) processes at a time, rounded down to whole rows (or
+         *  slabs of a volume) when the attributes are a grid. The chunks are spread across parallel_thread_count() threads. **/
+        static const std::size_t fusion_chunk_size = 4096;
+
+        /** Evaluates pure nodes with only uniform inputs and outputs (see GraphNode::is_pure) before the rest of the graph and keeps their
+         *  results between executions until a property, constant or graph input upstream of them changes. On by default. **/
+        void set_constant_folding_enabled(bool enabled);
+        bool constant_folding_enabled() const;
+
+        /** Ids of the nodes whose cached results were used by the last execute(). **/
+        std::vector<int> folded_nodes() const;
+
+        /** Keeps the buffers of pure nodes (see GraphNode::is_pure) between executions, and only executes a node again once something
+         *  upstream of it has changed: a property, a connection, a graph input or mark_changed. Nodes that only feed kept buffers aren't
+         *  executed at all. Off by default, since the buffers are kept instead of being freed as soon as nothing needs them; see
+         *  Graph::set_result_caching_enabled for the executor Graph::execute keeps. **/
+        void set_result_caching_enabled(bool enabled);
+        bool result_caching_enabled() const;
+
+        /** Frees the buffers kept for result caching, so the next execute() executes every node again. **/
+        void clear_cached_results();
+
+        /** Ids of the nodes (or the last nodes of fused groups) whose kept buffers were used by the last execute() instead of executing. **/
+        std::vector<int> reused_nodes() const;
+
+        /** Only calculates the active elements of element-wise nodes (see GraphNode::is_elementwise), e.g. to skip the parts of a grid that a
+         *  mask zeroes anyway. Their other elements are left at zero, and fused chunks with nothing active are skipped. Nodes that aren't
+         *  element-wise, and attributes that aren't elements.length() long, are still calculated in full. **/
+        void set_active_elements(const ActiveElements& elements);
+
+        /** Goes back to calculating every element. **/
+        void clear_active_elements();
+
+        /** Makes every grid (e.g. from BlankGrid) with only every {stride}-th element along each axis, on top of its own stride, without
+         *  changing the graph. The mappings still cover the same area, so a preview at stride 8 is the full render with pixels skipped. **/
+        void set_grid_stride(unsigned int stride);
+        unsigned int grid_stride() const;
+
+        /** execute() checks {token} before each node and each chunk of an element-wise node or fused group, and throws ExecutionCancelled
+         *  once it's been cancelled. Nodes that work on the whole buffer at once (e.g. Blur) aren't stopped part way through. **/
+        void set_cancellation_token(const CancellationToken& token);
+        void clear_cancellation_token();
+
+        typedef std::function<void(const ExecutionProgress&)> ProgressCallback;
+
+        /** Called after each chunk of an element-wise node or fused group, and after each node. Chunks run on several threads, so it can
+         *  be called from any of them, but never from two at once. It's called while the chunk's thread waits, so keep it short. **/
+        void set_progress_callback(const ProgressCallback& callback);
+
     private:
-        const Graph& graph_;
+        const Graph* graph_;
 
         void get_topological_order();
+        void plan_execution();
+        void find_kept_results();
+        GraphOutputs execute_planned();
         GraphOutputs execute_internal();
         void execute_node(int node_id);
+        void find_fused_groups();
+        bool is_fusable_into_consumer(const GraphNode& node) const;
+        bool is_masked(std::size_t attribute_length) const;
+        void add_fused_group_members(const GraphNode& node, std::vector<int>& group) const;
+        void execute_fused_group(const std::vector<int>& group);
+        std::vector<int> get_group_members(const GraphNode& node) const;
+        void fold_constants();
+        void forget_cached_results();
+        void fold_constants_upstream_of(const GraphNode& node, std::unordered_map<int, bool>& foldable, std::unordered_set<int>& visited);
+        bool is_foldable(const GraphNode& node, std::unordered_map<int, bool>& foldable) const;
+        DataBuffer& evaluate_folded(const GraphNode& node);
+        void add_chunk_attribute_dependencies(CompositeDataBuffer& input_buffer, const GraphNode& node, const std::vector<int>& group,
+                                              const std::vector<std::unique_ptr<DataBuffer>>& chunk_buffers,
+                                              std::unordered_map<int, std::reference_wrapper<DataBuffer>>& buffers,
+                                              std::size_t begin, std::size_t length, std::vector<unsigned char>& empty_buffer);
         void get_attribute_length(const CompositeDataBuffer& input);
         std::vector<int> get_node_dependencies(const GraphNode& node);
         DataBuffer& get_buffer(int node_id, AttributeInfo buffer_attribute_info = AttributeInfo());
@@ -39,6 +151,67 @@ namespace noises
 
         std::deque<std::vector<int>> topological_order_;
         std::deque<std::vector<std::pair<int, std::unique_ptr<DataBuffer>>>> buffer_stack_;
+
+        // The values of the current batch item's inputs, and the names of every input set by an item of the batch
+        const std::unordered_map<std::string, std::shared_ptr<const DataBuffer>>* input_overrides_;
+        std::unordered_set<std::string> batch_inputs_;
+
+        // During a batch the buffers of one item are kept for the same node in the next, instead of being freed
+        bool recycle_buffers_;
+        std::unordered_map<int, std::unique_ptr<DataBuffer>> spare_buffers_;
+
+        boost::optional<std::reference_wrapper<const DataBuffer>> get_input_buffer(const std::string& input_name) const;
+        void check_batch_item(const InputUniformSet& item) const;
+        GraphOutputs execute_batch_item(const InputUniformSet& item);
+
+        // Keyed by the id of the last node in each group
+        std::unordered_map<int, std::vector<int>> fused_groups_;
+        bool fusion_enabled_;
+
+        std::unordered_set<int> folded_this_execution_;
+        bool constant_folding_enabled_;
+
+        boost::optional<ActiveElements> active_elements_;
+        unsigned int grid_stride_;
+        boost::optional<CancellationToken> cancellation_token_;
+
+        void throw_if_cancelled() const;
+
+        // (id, revision) of a node and everything upstream of it, sorted
+        typedef std::vector<std::pair<int, unsigned long>> UpstreamRevisions;
+
+        struct KeptResult
+        {
+            KeptResult() : folded(false) { }
+
+            // The upstream revisions the buffer was calculated with
+            UpstreamRevisions upstream_revisions;
+
+            // Null while the node's buffer is in buffer_stack_, or hasn't been calculated with these revisions yet
+            std::unique_ptr<DataBuffer> buffer;
+
+            // Folded constants only have uniforms, so unlike the other kept results they don't depend on the grid stride or active elements
+            bool folded;
+        };
+
+        // Only pure nodes, and ones that only depend on pure nodes, have results that can be kept. Worked out once per plan_execution
+        const boost::optional<UpstreamRevisions>& get_upstream_revisions(const GraphNode& node);
+        std::unordered_map<int, boost::optional<UpstreamRevisions>> upstream_revisions_;
+
+        // Persists between executions: the folded constants, and with result caching on the other nodes whose buffers can be kept. An
+        // entry's buffer is only used while its upstream revisions match, and find_kept_results drops the entries of nodes that changed
+        std::unordered_map<int, KeptResult> kept_results_;
+        std::unordered_set<int> reusable_this_execution_;
+        std::vector<int> reused_nodes_;
+        bool result_caching_enabled_;
+
+        ProgressCallback progress_callback_;
+        std::mutex progress_mutex_;
+        std::size_t node_count_;
+        std::size_t nodes_completed_;
+
+        void report_elements(int node_id, std::size_t& elements_processed, std::size_t elements, std::size_t element_count);
+        void report_node_done(const GraphNode& node, std::size_t element_count);
     };
 }
 
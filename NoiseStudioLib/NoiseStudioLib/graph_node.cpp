@@ -1,6 +1,7 @@
 #include "graph_node.h"
 
 #include <functional>
+#include <stdexcept>
 
 #include "validation_results.h"
 
@@ -12,12 +13,13 @@ namespace noises
         outputs_(this),
         in_recalculate_sockets_(false),
         is_graph_internal_node_(false),
+        revision_(0),
         parent_(nullptr)
     {
-        inputs_.listen_socket_changed([this](const InputSocket&) { recalculate_sockets_internal(); });
+        inputs_.listen_socket_changed([this](const InputSocket&) { mark_changed(); recalculate_sockets_internal(); });
         outputs_.listen_socket_changed([this](const OutputSocket&) { recalculate_sockets_internal(); });
 
-        properties_.listen_changed([this](Property&) { recalculate_sockets_internal(); });
+        properties_.listen_changed([this](Property&) { mark_changed(); recalculate_sockets_internal(); });
     }
 
     GraphNode::~GraphNode() { }
@@ -62,6 +64,39 @@ namespace noises
         // Optionally implemented in derived classes
     }
 
+    void GraphNode::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        for(DataBuffer::size_type i = begin; i < end; i++)
+        {
+            execute_attributes(input, output, i);
+        }
+    }
+
+    bool GraphNode::is_elementwise() const
+    {
+        return false;
+    }
+
+    bool GraphNode::is_pure() const
+    {
+        return is_elementwise();
+    }
+
+    unsigned long GraphNode::revision() const
+    {
+        return revision_;
+    }
+
+    void GraphNode::mark_changed()
+    {
+        revision_++;
+    }
+
+    void GraphNode::set_revision(unsigned long revision)
+    {
+        revision_ = revision;
+    }
+
     int GraphNode::id() const
     {
         return id_;
@@ -139,6 +174,50 @@ namespace noises
         return outputs_[name];
     }
 
+    std::unique_ptr<GraphNode> GraphNode::clone() const
+    {
+        if(!clone_factory_)
+            throw NodeNotCopyable(display_name() + " can't be copied. Add it with Graph::add_node<T> or override clone.");
+
+        std::unique_ptr<GraphNode> copy = clone_factory_();
+        copy->clone_factory_ = clone_factory_;
+        copy_to(*copy);
+        return copy;
+    }
+
+    void GraphNode::copy_to(GraphNode& copy) const
+    {
+        copy.name_ = name_;
+        copy.id_ = id_;
+        copy.is_graph_internal_node_ = is_graph_internal_node_;
+
+        for(const Property& property : properties())
+        {
+            copy.property(property.name()).copy_values_from(property);
+        }
+
+        // e.g. the graph makes its inputs optional, and lets its outputs accept anything
+        for(const InputSocket& socket : inputs().all_sockets())
+        {
+            auto possible_copy_socket = copy.inputs().get_by_name(socket.name());
+            if(!possible_copy_socket)
+                continue;
+
+            InputSocket& copy_socket = *possible_copy_socket;
+            for(const ConnectionDataType& type : socket.accepted_types())
+            {
+                copy_socket.set_accepts(type);
+            }
+            copy_socket.set_optional(socket.optional());
+            copy_socket.set_independent_length(socket.independent_length());
+        }
+    }
+
+    void GraphNode::set_clone_factory(std::function<std::unique_ptr<GraphNode>()> factory)
+    {
+        clone_factory_ = std::move(factory);
+    }
+
     void GraphNode::request_recalculate_sockets()
     {
         recalculate_sockets_internal();
@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 #include "socket_collection.h"
 #include "data_buffer.h"
@@ -17,6 +20,13 @@ namespace noises
     class Property;
     class ValidationResults;
 
+    /** Thrown by GraphNode::clone for a node that doesn't know how to copy itself. **/
+    class NodeNotCopyable : public std::logic_error
+    {
+    public:
+        explicit NodeNotCopyable(const std::string& message) : std::logic_error(message) { }
+    };
+
     class GraphNode
     {
     public:
@@ -53,11 +63,42 @@ namespace noises
         /** Executes a graph node and computes its attribute outputs. This method is called once for each index in the final output (e.g. x/y) **/
         virtual void execute_attributes(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type index) const;
 
+        /** Executes a graph node for the attribute indices [begin, end). The default calls execute_attributes for each index; nodes that
+         *  can process a whole block at once (e.g. Math) override this instead. **/
+        virtual void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+
+        /** True if each attribute output index only depends on the same index of the attribute inputs, execute_uniforms doesn't read attribute
+         *  inputs, and execute_attribute_range only touches [begin, end). GraphExecutor can then run chains of these nodes a chunk at a time. **/
+        virtual bool is_elementwise() const;
+
+        /** True if the node's outputs only depend on its inputs, properties and revision(). GraphExecutor folds pure nodes that only have
+         *  uniform inputs and outputs, and can keep the results of the rest between executions (see set_result_caching_enabled). Defaults
+         *  to is_elementwise(). **/
+        virtual bool is_pure() const;
+
+        /** Incremented whenever a property or input socket changes (including being connected or disconnected), or mark_changed is
+         *  called. **/
+        unsigned long revision() const;
+
+        /** Call when state that isn't a property (e.g. a constant's value) changes, so cached results are recalculated. **/
+        void mark_changed();
+
         virtual void validate(ValidationResults& results) const;
 
+        /** An unconnected copy of the node for Graph::snapshot, with the same id, name and property values, and the same settings on its
+         *  input sockets. Nodes with state that isn't a property (e.g. a constant's value) override this to copy that too. Nodes added
+         *  with Graph::add_node<T> make another T, others have to override it or NodeNotCopyable is thrown. **/
+        virtual std::unique_ptr<GraphNode> clone() const;
+
+        /** Makes a new node of the same type for clone(). Set by Graph::add_node<T>. **/
+        void set_clone_factory(std::function<std::unique_ptr<GraphNode>()> factory);
+
         int id() const;
         void set_id(int id);
 
+        /** For Graph::snapshot, whose copies keep the revisions of the nodes they were copied from. **/
+        void set_revision(unsigned long revision);
+
         Property& property(const std::string& name);
         const Property& property(const std::string& name) const;
 
@@ -86,6 +127,9 @@ namespace noises
 
         void remove_property(const Property& property);
 
+        /** Copies the name, id, property values and input socket settings onto {copy}, a new node of the same type, for clone(). **/
+        void copy_to(GraphNode& copy) const;
+
         /** Called when a connection is changed for a socket, a property is changed or added or removed, or the node is added to the graph.
          *  Use this to calculate socket output types (for example when they're dependent on the input type). **/
         virtual void recalculate_sockets();
@@ -103,9 +147,11 @@ namespace noises
         int id_;
         bool in_recalculate_sockets_;
         bool is_graph_internal_node_;
+        unsigned long revision_;
 
         Graph* parent_;
 
+        std::function<std::unique_ptr<GraphNode>()> clone_factory_;
     };
 }
 
@@ -1,5 +1,10 @@
 #include "graph_outputs.h"
 
+#include <algorithm>
+#include <stdexcept>
+
+#include "nodes/whole_grid.h"
+
 namespace noises
 {
     GraphOutputs::GraphOutputs() { }
@@ -34,4 +39,80 @@ namespace noises
     {
         return get_raw_buffer(name).attribute_info();
     }
+
+    void GraphOutputs::build_mip_chain(const std::string& name, std::size_t levels, MipFilter filter)
+    {
+        DataBuffer& base = get_raw_buffer(name);
+
+        AttributeInfo info = base.attribute_info();
+        std::size_t full_levels = full_mip_levels(info.grid().extent(0), info.grid().extent(1));
+        if(levels == 0 || levels > full_levels)
+            levels = full_levels;
+
+        std::vector<std::unique_ptr<DataBuffer>> chain;
+        for(std::size_t level = 1; level < levels; level++)
+        {
+            chain.push_back(downsample(chain.empty() ? base : *chain.back(), filter));
+        }
+
+        mip_chains_[name] = std::move(chain);
+    }
+
+    void GraphOutputs::set_mip_level(const std::string& name, std::size_t level, GraphOutputs&& level_outputs)
+    {
+        nodes::WholeGrid expected(get_raw_buffer(name).attribute_info(), "A mip chain");
+
+        std::vector<std::unique_ptr<DataBuffer>>& chain = mip_chains_[name];
+        if(level == 0 || level > chain.size() + 1)
+            throw std::invalid_argument("Mip levels have to be set in order, after level 0.");
+
+        for(std::size_t i = 0; i < level; i++)
+        {
+            expected.width = (expected.width + 1) / 2;
+            expected.height = (expected.height + 1) / 2;
+        }
+
+        AttributeInfo info = level_outputs.attribute_info(name);
+        if(info.grid().rank() != 2 || info.grid().extent(0) != expected.width || info.grid().extent(1) != expected.height)
+            throw std::invalid_argument("Mip level " + std::to_string(level) + " of " + name + " has to be " + std::to_string(expected.width) + "x" +
+                                        std::to_string(expected.height) + ".");
+
+        auto it = std::find_if(level_outputs.buffers_.begin(), level_outputs.buffers_.end(), [&](const std::unique_ptr<DataBuffer>& buffer)
+        {
+            return buffer.get() == &level_outputs.get_raw_buffer(name);
+        });
+
+        std::unique_ptr<DataBuffer> buffer = std::move(*it);
+        level_outputs.buffers_.erase(it);
+        level_outputs.buffer_map_.erase(name);
+
+        if(level == chain.size() + 1)
+            chain.push_back(std::move(buffer));
+        else
+            chain[level - 1] = std::move(buffer);
+    }
+
+    std::size_t GraphOutputs::mip_levels(const std::string& name) const
+    {
+        get_raw_buffer(name);
+
+        auto it = mip_chains_.find(name);
+        return it == mip_chains_.end() ? 1 : it->second.size() + 1;
+    }
+
+    DataBuffer& GraphOutputs::get_mip_buffer(const std::string& name, std::size_t level) const
+    {
+        if(level == 0)
+            return get_raw_buffer(name);
+
+        if(level >= mip_levels(name))
+            throw std::out_of_range("Output " + name + " has no mip level " + std::to_string(level));
+
+        return *mip_chains_.at(name)[level - 1];
+    }
+
+    AttributeInfo GraphOutputs::mip_attribute_info(const std::string& name, std::size_t level) const
+    {
+        return get_mip_buffer(name, level).attribute_info();
+    }
 }
@@ -7,6 +7,7 @@
 
 #include "data_buffer.h"
 #include "attribute_info.h"
+#include "mip_chain.h"
 
 namespace noises
 {
@@ -71,10 +72,42 @@ namespace noises
 
         std::vector<std::pair<std::string, std::reference_wrapper<DataBuffer>>> buffers();
 
+        /** Builds a level of detail pyramid for the output {name}, which has to be a whole 2D float or double grid. Each level is half
+         *  the size of the one above (rounding up) and is filtered down from it, with the rows of each level spread over threads.
+         *  {levels} counts the output itself as level 0, 0 goes all the way down to 1x1. Replaces any chain already built for it. **/
+        void build_mip_chain(const std::string& name, std::size_t levels = 0, MipFilter filter = MipFilter::box);
+
+        /** Uses {level_outputs}' output {name} as level {level} of {name}'s chain instead of filtering it down, e.g. from running the
+         *  graph again with BlankGrid::set_stride(1 << level). Levels have to be set in order after 0, which is this output, and have
+         *  to be the size build_mip_chain would make them, otherwise this throws std::invalid_argument. **/
+        void set_mip_level(const std::string& name, std::size_t level, GraphOutputs&& level_outputs);
+
+        /** Number of levels of {name}'s chain, including the output itself. 1 if there's no chain. **/
+        std::size_t mip_levels(const std::string& name) const;
+
+        /** Level {level} of {name}'s chain, 0 being the output itself. **/
+        DataBuffer& get_mip_buffer(const std::string& name, std::size_t level) const;
+
+        AttributeInfo mip_attribute_info(const std::string& name, std::size_t level) const;
+
+        template<typename ValueType>
+        std::vector<ValueType> get_mip_vector(const std::string& name, std::size_t level) const
+        {
+            DataBuffer& buffer = get_mip_buffer(name, level);
+            const ConnectionDataType& type = buffer.get_attribute_type(0);
+            assert(type.is<ValueType>());
+
+            const ValueType* buffer_start = reinterpret_cast<const ValueType*>(buffer.get_memory_block(0).data());
+            return std::vector<ValueType>(buffer_start, buffer_start + buffer.attribute_info().length() * type.dimensions());
+        }
+
     private:
 
         std::unordered_map<std::string, std::reference_wrapper<DataBuffer>> buffer_map_;
         std::vector<std::unique_ptr<DataBuffer>> buffers_;
+
+        // Levels from 1 down for each output that has a chain
+        std::unordered_map<std::string, std::vector<std::unique_ptr<DataBuffer>>> mip_chains_;
     };
 }
 
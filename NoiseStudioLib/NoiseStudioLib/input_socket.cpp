@@ -5,7 +5,7 @@
 namespace noises
 {
     InputSocket::InputSocket(const std::string& name, SocketType type) :
-        Socket(name, type), optional_(false), connection_(nullptr) { }
+        Socket(name, type), optional_(false), independent_length_(false), connection_(nullptr) { }
 
     void InputSocket::set_accepts(const ConnectionDataType& type)
     {
@@ -52,6 +52,17 @@ namespace noises
         trigger_changed();
     }
 
+    bool InputSocket::independent_length() const
+    {
+        return independent_length_;
+    }
+
+    void InputSocket::set_independent_length(bool independent_length)
+    {
+        independent_length_ = independent_length;
+        trigger_changed();
+    }
+
     void InputSocket::on_removing()
     {
         Graph* graph = parent()->parent();
@@ -23,6 +23,11 @@ namespace noises
         bool optional() const;
         void set_optional(bool optional);
 
+        /** Attributes connected to an independent length input don't have to be the same length as the node's other attribute inputs,
+         *  e.g. a grid that is looked up rather than read element by element. The node's attribute length comes from the other inputs. **/
+        bool independent_length() const;
+        void set_independent_length(bool independent_length);
+
         const boost::optional<std::reference_wrapper<const Connection>> connection() const;
         void set_connection(const Connection& connection);
         void remove_connection();
@@ -32,6 +37,7 @@ namespace noises
     private:
         AcceptedTypes accepted_types_;
         bool optional_;
+        bool independent_length_;
         const Connection* connection_;
     };
 }
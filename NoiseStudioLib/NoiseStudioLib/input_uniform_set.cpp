@@ -0,0 +1,18 @@
+#include "input_uniform_set.h"
+
+namespace noises
+{
+    void InputUniformSet::set_uniform_raw(const std::string& input_name, const ConnectionDataType& data_type, const unsigned char* data_ptr)
+    {
+        std::shared_ptr<DataBuffer> buffer = std::make_shared<DataBuffer>(AttributeInfo(0, ""));
+        buffer->add_uniform(data_type);
+        buffer->set_uniform_raw(0, data_type.size_full(), data_ptr);
+
+        buffers_[input_name] = std::move(buffer);
+    }
+
+    const std::unordered_map<std::string, std::shared_ptr<const DataBuffer>>& InputUniformSet::buffers() const
+    {
+        return buffers_;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef INPUT_UNIFORM_SET_H
+#define INPUT_UNIFORM_SET_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "connection_data_type.h"
+#include "data_buffer.h"
+#include "ptr_array.h"
+
+namespace noises
+{
+    /** Values for some of a graph's uniform inputs, e.g. the seed and offset of one tile, used in place of the graph's own values for one
+     *  item of GraphExecutor::execute_batch. **/
+    class InputUniformSet
+    {
+    public:
+        template<typename ValueType, unsigned int Dimensions>
+        void set_uniform(const std::string& input_name, ptr_array<ValueType, Dimensions> value)
+        {
+            set_uniform_raw(input_name, ConnectionDataType::value<ValueType, Dimensions>(), value.raw());
+        }
+
+        void set_uniform_raw(const std::string& input_name, const ConnectionDataType& data_type, const unsigned char* data_ptr);
+
+        /** A buffer holding each input's value as its only uniform, like Graph::get_input_buffer. **/
+        const std::unordered_map<std::string, std::shared_ptr<const DataBuffer>>& buffers() const;
+
+    private:
+        std::unordered_map<std::string, std::shared_ptr<const DataBuffer>> buffers_;
+    };
+}
+
+#endif // INPUT_UNIFORM_SET_H
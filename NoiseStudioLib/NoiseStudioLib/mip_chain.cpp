@@ -0,0 +1,131 @@
+#include "mip_chain.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "parallel.h"
+#include "nodes/whole_grid.h"
+
+namespace
+{
+    using noises::nodes::clamp_index;
+
+    struct MipKernel
+    {
+        // Source offsets from 2x of the destination pixel, and their weights. They're symmetric, so a level is centred on the pixels
+        // a strided render of it would have.
+        std::vector<std::ptrdiff_t> taps;
+        std::vector<double> weights;
+    };
+
+    MipKernel kernel(noises::MipFilter filter)
+    {
+        if(filter == noises::MipFilter::box)
+            return MipKernel { { -1, 0, 1 }, { 0.25, 0.5, 0.25 } };
+        return MipKernel { { -2, -1, 0, 1, 2 }, { 0.0625, 0.25, 0.375, 0.25, 0.0625 } };
+    }
+
+    // Each destination row is the source rows under it filtered down into a row of the full width, then that row filtered across
+    template<typename T>
+    void downsample_rows(const T* in, T* out, std::size_t width, std::size_t height, std::size_t channels, const MipKernel& mip_kernel)
+    {
+        const std::size_t row_size = width * channels;
+        const std::size_t out_width = (width + 1) / 2;
+        const std::size_t out_height = (height + 1) / 2;
+
+        std::vector<T> weights(mip_kernel.weights.begin(), mip_kernel.weights.end());
+
+        noises::parallel_for(out_height, noises::nodes::WholeGrid::rows_per_task(), [&](std::size_t begin, std::size_t end)
+        {
+            std::vector<T> column_sums(row_size);
+
+            for(std::size_t y = begin; y < end; y++)
+            {
+                std::fill(column_sums.begin(), column_sums.end(), static_cast<T>(0));
+                for(std::size_t tap = 0; tap < mip_kernel.taps.size(); tap++)
+                {
+                    const T weight = weights[tap];
+                    const T* row = in + clamp_index(static_cast<std::ptrdiff_t>(y * 2) + mip_kernel.taps[tap], height) * row_size;
+                    T* sums = column_sums.data();
+
+                    for(std::size_t i = 0; i < row_size; i++)
+                    {
+                        sums[i] += weight * row[i];
+                    }
+                }
+
+                T* out_row = out + y * out_width * channels;
+                for(std::size_t x = 0; x < out_width; x++)
+                {
+                    for(std::size_t channel = 0; channel < channels; channel++)
+                    {
+                        T sum = static_cast<T>(0);
+                        for(std::size_t tap = 0; tap < mip_kernel.taps.size(); tap++)
+                        {
+                            std::size_t column = clamp_index(static_cast<std::ptrdiff_t>(x * 2) + mip_kernel.taps[tap], width);
+                            sum += weights[tap] * column_sums[column * channels + channel];
+                        }
+                        out_row[x * channels + channel] = sum;
+                    }
+                }
+            }
+        });
+    }
+}
+
+namespace noises
+{
+    std::unique_ptr<DataBuffer> downsample(const DataBuffer& source, MipFilter filter)
+    {
+        if(source.num_attributes() == 0)
+            throw std::invalid_argument("Can only make a mip chain of an attribute.");
+
+        AttributeInfo info = source.attribute_info();
+        nodes::WholeGrid source_grid(info, "A mip chain");
+
+        const ConnectionDataType& data_type = source.get_attribute_type(0);
+        if((data_type.is<float>() || data_type.is<double>()) == false || data_type.dimensions() == 0)
+            throw std::invalid_argument("A mip chain can only be made of float or double attributes.");
+
+        const std::size_t width = source_grid.width;
+        const std::size_t height = source_grid.height;
+
+        GridInfo grid = info.grid().strided(2);
+        std::string tag = boost::str(boost::format("[2d][w/h][t-b][%1%,%2%]") % grid.extent(0) % grid.extent(1));
+
+        std::unique_ptr<DataBuffer> level(new DataBuffer(AttributeInfo(grid.size(), tag, grid)));
+        level->add_attribute(data_type);
+
+        if(source_grid.empty())
+            return level;
+
+        const unsigned char* in = source.get_memory_block(0).data();
+        unsigned char* out = level->get_attribute_all_raw(0);
+
+        if(data_type.is<float>())
+        {
+            downsample_rows(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), width, height, data_type.dimensions(), kernel(filter));
+        }
+        else
+        {
+            downsample_rows(reinterpret_cast<const double*>(in), reinterpret_cast<double*>(out), width, height, data_type.dimensions(), kernel(filter));
+        }
+
+        return level;
+    }
+
+    std::size_t full_mip_levels(std::size_t width, std::size_t height)
+    {
+        std::size_t levels = 1;
+        while(width > 1 || height > 1)
+        {
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+            levels++;
+        }
+        return levels;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <cstddef>
+#include <memory>
+
+#include "data_buffer.h"
+
+namespace noises
+{
+    enum class MipFilter
+    {
+        box = 0, // The 2x2 box centred on each pixel, i.e. 1/4, 1/2, 1/4 of the pixel and its neighbours along each axis
+        gaussian = 1 // 5x5 binomial kernel, smoother but softer
+    };
+
+    /** Makes the next level down of a mip chain from the first attribute of {source}, which has to be a whole 2D float or double grid.
+     *  The result is half the size, rounding up, and its grid has twice the stride, so it lines up with the full grid the same way a
+     *  BlankGrid with that stride would: pixel (x, y) is centred on pixel (2x, 2y) of {source}. Edges are clamped. **/
+    std::unique_ptr<DataBuffer> downsample(const DataBuffer& source, MipFilter filter);
+
+    /** Number of levels in a full chain for a {width} x {height} grid, from the grid itself down to 1x1. **/
+    std::size_t full_mip_levels(std::size_t width, std::size_t height);
+}
+
+#endif // MIP_CHAIN_H
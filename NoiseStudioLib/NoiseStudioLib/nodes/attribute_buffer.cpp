@@ -36,6 +36,11 @@ namespace nodes {
         return "Attribute Buffer";
     }
 
+    bool AttributeBuffer::is_pure() const
+    {
+        return true;
+    }
+
     InputSocket& AttributeBuffer::input()
     {
         return *input_;
@@ -56,6 +61,19 @@ namespace nodes {
         return *output_;
     }
 
+    std::unique_ptr<GraphNode> AttributeBuffer::clone() const
+    {
+        // Made by the graph rather than add_node, so there's no factory
+        AttributeBuffer* buffer = new AttributeBuffer();
+        std::unique_ptr<GraphNode> copy(buffer);
+        copy_to(*copy);
+
+        if(has_manual_output_type_)
+            buffer->set_output_type(output_->data_type());
+
+        return copy;
+    }
+
     void AttributeBuffer::set_output_type(const ConnectionDataType &data_type)
     {
         has_manual_output_type_ = true;
@@ -2,6 +2,9 @@
 
 #include <boost/format.hpp>
 
+#include "composite_data_buffer.h"
+#include "validation_results.h"
+
 namespace noises {
 namespace nodes
 {
@@ -9,9 +12,13 @@ namespace nodes
     {
         Property& width = add_property<unsigned int, 1>("Width");
         Property& height = add_property<unsigned int, 1>("Height");
+        Property& depth = add_property<unsigned int, 1>("Depth");
+        Property& stride = add_property<unsigned int, 1>("Stride");
 
         unsigned int default_width = 512;
         unsigned int default_height = 512;
+        unsigned int default_depth = 0;
+        unsigned int default_stride = 1;
 
         InputSocket& width_socket = inputs().add("Width", SocketType::uniform);
         InputSocket& height_socket = inputs().add("Height", SocketType::uniform);
@@ -21,6 +28,8 @@ namespace nodes
 
         width.set_default_value<unsigned int, 1>(&default_width);
         height.set_default_value<unsigned int, 1>(&default_height);
+        depth.set_default_value<unsigned int, 1>(&default_depth);
+        stride.set_default_value<unsigned int, 1>(&default_stride);
 
         width_socket.set_optional(true);
         height_socket.set_optional(true);
@@ -28,29 +37,65 @@ namespace nodes
         outputs().add("Grid", ConnectionDataType::undefined(), SocketType::attribute);
     }
 
-    void BlankGrid::execute_uniforms(const CompositeDataBuffer&, DataBuffer &output) const
+    void BlankGrid::execute_uniforms(const CompositeDataBuffer& input, DataBuffer &output) const
     {
         //TODO use input and output sockets if they're connected
         unsigned int width = property("Width").value_or_default<unsigned int, 1>().value();
         unsigned int height = property("Height").value_or_default<unsigned int, 1>().value();
+        unsigned int depth = property("Depth").value_or_default<unsigned int, 1>().value();
+        std::size_t stride = property("Stride").value_or_default<unsigned int, 1>().value() * input.grid_stride();
+
+        if(depth == 0)
+        {
+            GridInfo grid = GridInfo { width, height }.strided(stride);
 
-        std::size_t length = width * height;
+            // 2d image, data is rows, top to bottom, width/height
+            std::string tag = boost::str(boost::format("[2d][w/h][t-b][%1%,%2%]") % grid.extent(0) % grid.extent(1));
 
-        // 2d image, data is rows, top to bottom, width/height
-        std::string tag = boost::str(boost::format("[2d][w/h][t-b][%1%,%2%]") % width % height);
+            output.resize_attribute(AttributeInfo(grid.size(), tag, grid));
+        }
+        else
+        {
+            GridInfo grid = GridInfo { width, height, depth }.strided(stride);
 
-        output.resize_attribute(AttributeInfo(length, tag));
+            // 3d volume, data is slices front to back, each of them rows top to bottom
+            std::string tag = boost::str(boost::format("[3d][w/h/d][t-b][%1%,%2%,%3%]") % grid.extent(0) % grid.extent(1) % grid.extent(2));
+
+            output.resize_attribute(AttributeInfo(grid.size(), tag, grid));
+        }
     }
 
     void BlankGrid::set_size(unsigned int width, unsigned int height)
+    {
+        set_size(width, height, 0);
+    }
+
+    void BlankGrid::set_size(unsigned int width, unsigned int height, unsigned int depth)
     {
         property("Width").set_value<unsigned int>(&width);
         property("Height").set_value<unsigned int>(&height);
+        property("Depth").set_value<unsigned int>(&depth);
+    }
+
+    void BlankGrid::set_stride(unsigned int stride)
+    {
+        property("Stride").set_value<unsigned int>(&stride);
+    }
+
+    void BlankGrid::validate(ValidationResults &results) const
+    {
+        if(property("Stride").value_or_default<unsigned int, 1>().value() == 0)
+            results.add("Grid stride must be at least 1.");
     }
 
     std::string BlankGrid::node_name() const
     {
         return "Grid";
     }
+
+    bool BlankGrid::is_pure() const
+    {
+        return true;
+    }
 }}
 
@@ -14,7 +14,18 @@ namespace nodes {
 
         void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
 
+        void validate(ValidationResults& results) const;
+
+        bool is_pure() const;
+
         void set_size(unsigned int width, unsigned int height);
+
+        /** Makes a 3D grid of {depth} slices of width x height. A depth of 0 makes a 2D grid. **/
+        void set_size(unsigned int width, unsigned int height, unsigned int depth);
+
+        /** Only makes every {stride}-th element along each axis, e.g. for a quick preview or a lower level of detail. The mappings
+         *  still go over the same area as the full size grid, so a strided render is the full one with elements skipped. **/
+        void set_stride(unsigned int stride);
     };
 }}
 
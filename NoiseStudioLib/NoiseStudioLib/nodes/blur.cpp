@@ -0,0 +1,338 @@
+#include "blur.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "composite_data_buffer.h"
+#include "validation_results.h"
+#include "parallel.h"
+#include "whole_grid.h"
+
+namespace
+{
+    using noises::nodes::clamp_index;
+
+    // Box blur along a row as a sliding window: add the pixel entering the window and remove the one leaving it, so each
+    // pixel costs the same whatever the radius
+    template<typename T>
+    void box_row(const T* in, T* out, std::size_t width, std::size_t channels, std::size_t radius)
+    {
+        const double scale = 1.0 / static_cast<double>(radius * 2 + 1);
+        const std::ptrdiff_t r = static_cast<std::ptrdiff_t>(radius);
+
+        for(std::size_t channel = 0; channel < channels; channel++)
+        {
+            double sum = 0.0;
+            for(std::ptrdiff_t x = -r; x <= r; x++)
+            {
+                sum += in[clamp_index(x, width) * channels + channel];
+            }
+
+            for(std::size_t x = 0; x < width; x++)
+            {
+                out[x * channels + channel] = static_cast<T>(sum * scale);
+
+                std::ptrdiff_t entering = static_cast<std::ptrdiff_t>(x) + r + 1;
+                std::ptrdiff_t leaving = static_cast<std::ptrdiff_t>(x) - r;
+                sum += in[clamp_index(entering, width) * channels + channel];
+                sum -= in[clamp_index(leaving, width) * channels + channel];
+            }
+        }
+    }
+
+    // Any kernel along a row. Away from the edges no index needs clamping, so each weight is one multiply-add over a contiguous
+    // run of values, which the compiler vectorizes.
+    template<typename T>
+    void kernel_row(const T* in, T* out, std::size_t width, std::size_t channels, const std::vector<T>& weights)
+    {
+        const std::ptrdiff_t radius = static_cast<std::ptrdiff_t>(weights.size() / 2);
+        const std::ptrdiff_t w = static_cast<std::ptrdiff_t>(width);
+
+        std::ptrdiff_t interior_begin = std::min(radius, w);
+        std::ptrdiff_t interior_end = std::max(w - radius, interior_begin);
+
+        auto clamped_pixel = [&](std::ptrdiff_t x)
+        {
+            for(std::size_t channel = 0; channel < channels; channel++)
+            {
+                T sum = static_cast<T>(0);
+                for(std::ptrdiff_t k = -radius; k <= radius; k++)
+                {
+                    sum += weights[k + radius] * in[clamp_index(x + k, width) * channels + channel];
+                }
+                out[x * channels + channel] = sum;
+            }
+        };
+
+        for(std::ptrdiff_t x = 0; x < interior_begin; x++)
+        {
+            clamped_pixel(x);
+        }
+
+        const std::size_t first = interior_begin * channels;
+        const std::size_t last = interior_end * channels;
+
+        std::fill(out + first, out + last, static_cast<T>(0));
+        for(std::ptrdiff_t k = -radius; k <= radius; k++)
+        {
+            const T weight = weights[k + radius];
+            const T* source = in + (static_cast<std::ptrdiff_t>(first) + k * static_cast<std::ptrdiff_t>(channels));
+            T* target = out + first;
+
+            for(std::size_t i = 0; i < last - first; i++)
+            {
+                target[i] += weight * source[i];
+            }
+        }
+
+        for(std::ptrdiff_t x = interior_end; x < w; x++)
+        {
+            clamped_pixel(x);
+        }
+    }
+
+    // Box blur down the columns for the rows [begin, end). Keeps a running sum per value of a row, so the rows are read
+    // (and the sums updated) in order, a whole row at a time
+    template<typename T>
+    void box_columns(const T* in, T* out, std::size_t row_size, std::size_t height, std::size_t radius, std::size_t begin, std::size_t end)
+    {
+        const double scale = 1.0 / static_cast<double>(radius * 2 + 1);
+        const std::ptrdiff_t r = static_cast<std::ptrdiff_t>(radius);
+
+        std::vector<double> sums(row_size, 0.0);
+        for(std::ptrdiff_t y = static_cast<std::ptrdiff_t>(begin) - r; y <= static_cast<std::ptrdiff_t>(begin) + r; y++)
+        {
+            const T* row = in + clamp_index(y, height) * row_size;
+            for(std::size_t i = 0; i < row_size; i++)
+            {
+                sums[i] += row[i];
+            }
+        }
+
+        for(std::size_t y = begin; y < end; y++)
+        {
+            T* out_row = out + y * row_size;
+            const T* entering = in + clamp_index(static_cast<std::ptrdiff_t>(y) + r + 1, height) * row_size;
+            const T* leaving = in + clamp_index(static_cast<std::ptrdiff_t>(y) - r, height) * row_size;
+
+            for(std::size_t i = 0; i < row_size; i++)
+            {
+                out_row[i] = static_cast<T>(sums[i] * scale);
+                sums[i] += static_cast<double>(entering[i]) - static_cast<double>(leaving[i]);
+            }
+        }
+    }
+
+    // Any kernel down the columns for the rows [begin, end), a whole row at a time
+    template<typename T>
+    void kernel_columns(const T* in, T* out, std::size_t row_size, std::size_t height, const std::vector<T>& weights, std::size_t begin, std::size_t end)
+    {
+        const std::ptrdiff_t radius = static_cast<std::ptrdiff_t>(weights.size() / 2);
+
+        for(std::size_t y = begin; y < end; y++)
+        {
+            T* out_row = out + y * row_size;
+            std::fill(out_row, out_row + row_size, static_cast<T>(0));
+
+            for(std::ptrdiff_t k = -radius; k <= radius; k++)
+            {
+                const T weight = weights[k + radius];
+                const T* row = in + clamp_index(static_cast<std::ptrdiff_t>(y) + k, height) * row_size;
+
+                for(std::size_t i = 0; i < row_size; i++)
+                {
+                    out_row[i] += weight * row[i];
+                }
+            }
+        }
+    }
+}
+
+namespace noises {
+namespace nodes
+{
+    Blur::Blur() :
+        input_socket_(nullptr),
+        output_socket_(nullptr),
+        kernel_property_(nullptr),
+        radius_property_(nullptr),
+        sigma_property_(nullptr)
+    {
+        input_socket_ = &inputs().add("Input", SocketType::attribute);
+        input_socket_->set_accepts(ConnectionDataType::any()); // Checked in validate
+
+        output_socket_ = &outputs().add("Output", ConnectionDataType::undefined(), SocketType::attribute);
+
+        kernel_property_ = &add_property<int, 1>("Kernel");
+        int default_kernel = static_cast<int>(BlurKernel::box);
+        kernel_property_->set_default_value<int, 1>(&default_kernel);
+
+        radius_property_ = &add_property<unsigned int, 1>("Radius");
+        unsigned int default_radius = 2;
+        radius_property_->set_default_value<unsigned int, 1>(&default_radius);
+
+        sigma_property_ = &add_property<float, 1>("Sigma");
+        float default_sigma = 0.0f;
+        sigma_property_->set_default_value<float, 1>(&default_sigma);
+    }
+
+    std::string Blur::node_name() const
+    {
+        return "Blur";
+    }
+
+    bool Blur::is_pure() const
+    {
+        return true;
+    }
+
+    void Blur::recalculate_sockets()
+    {
+        if(output_socket_ == nullptr)
+            return; // Still initializing
+
+        auto connection = input_socket_->connection();
+        output_socket_->set_data_type(connection ? connection->get().data_type() : ConnectionDataType::undefined());
+    }
+
+    void Blur::set_kernel(BlurKernel kernel)
+    {
+        int value = static_cast<int>(kernel);
+        kernel_property_->set_value<int, 1>(&value);
+    }
+
+    void Blur::set_radius(unsigned int radius)
+    {
+        radius_property_->set_value<unsigned int, 1>(&radius);
+    }
+
+    void Blur::set_sigma(float sigma)
+    {
+        sigma_property_->set_value<float, 1>(&sigma);
+    }
+
+    std::unique_ptr<GraphNode> Blur::clone() const
+    {
+        std::unique_ptr<GraphNode> copy = GraphNode::clone();
+        static_cast<Blur&>(*copy).set_custom_kernel(custom_weights_);
+        return copy;
+    }
+
+    void Blur::set_custom_kernel(const std::vector<float>& weights)
+    {
+        custom_weights_ = weights;
+        mark_changed();
+    }
+
+    std::vector<double> Blur::weights() const
+    {
+        BlurKernel kernel = static_cast<BlurKernel>(kernel_property_->value_or_default<int, 1>().value());
+        unsigned int radius = radius_property_->value_or_default<unsigned int, 1>().value();
+
+        if(kernel == BlurKernel::custom)
+            return std::vector<double>(custom_weights_.begin(), custom_weights_.end());
+
+        if(kernel == BlurKernel::box)
+            return std::vector<double>(radius * 2 + 1, 1.0 / (radius * 2 + 1));
+
+        // Gaussian, by default the radius covers 3 standard deviations
+        double sigma = sigma_property_->value_or_default<float, 1>().value();
+        if(sigma <= 0.0)
+            sigma = std::max(radius / 3.0, 0.5);
+
+        std::vector<double> weights;
+        double total = 0.0;
+        for(int k = -static_cast<int>(radius); k <= static_cast<int>(radius); k++)
+        {
+            double weight = std::exp(-(k * k) / (2.0 * sigma * sigma));
+            weights.push_back(weight);
+            total += weight;
+        }
+
+        for(double& weight : weights)
+        {
+            weight /= total;
+        }
+
+        return weights;
+    }
+
+    template<typename T>
+    void Blur::blur(const CompositeDataBuffer& input, DataBuffer& output, const WholeGrid& grid) const
+    {
+        const std::size_t width = grid.width;
+        const std::size_t height = grid.height;
+        const ConnectionDataType& data_type = input_socket_->connection()->get().data_type();
+        const std::size_t channels = data_type.dimensions();
+        const std::size_t row_size = width * channels;
+
+        const T* in = reinterpret_cast<const T*>(std::get<0>(input.get_attribute_all_raw(*input_socket_, data_type)));
+        T* out = reinterpret_cast<T*>(output.get_attribute_all_raw(*output_socket_, data_type));
+
+        bool is_box = static_cast<BlurKernel>(kernel_property_->value_or_default<int, 1>().value()) == BlurKernel::box;
+        std::size_t radius = radius_property_->value_or_default<unsigned int, 1>().value();
+
+        std::vector<double> double_weights = weights();
+        std::vector<T> kernel(double_weights.begin(), double_weights.end());
+
+        // Rows first into a temporary buffer, then the columns of that into the output
+        std::vector<T> rows(width * height * channels);
+
+        parallel_for(height, WholeGrid::rows_per_task(), [&](std::size_t begin, std::size_t end)
+        {
+            for(std::size_t y = begin; y < end; y++)
+            {
+                if(is_box)
+                    box_row(in + y * row_size, &rows[y * row_size], width, channels, radius);
+                else
+                    kernel_row(in + y * row_size, &rows[y * row_size], width, channels, kernel);
+            }
+        });
+
+        parallel_for(height, WholeGrid::rows_per_task(), [&](std::size_t begin, std::size_t end)
+        {
+            if(is_box)
+                box_columns(rows.data(), out, row_size, height, radius, begin, end);
+            else
+                kernel_columns(rows.data(), out, row_size, height, kernel, begin, end);
+        });
+    }
+
+    void Blur::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type, DataBuffer::size_type) const
+    {
+        // Each output pixel depends on its neighbours, so Blur isn't element-wise and this is called once for the whole grid
+        WholeGrid grid(output.attribute_info(), "Blur");
+        if(grid.empty())
+            return;
+
+        const ConnectionDataType& data_type = input_socket_->connection()->get().data_type();
+
+        if(data_type.is<float>())
+        {
+            blur<float>(input, output, grid);
+        }
+        else if(data_type.is<double>())
+        {
+            blur<double>(input, output, grid);
+        }
+    }
+
+    void Blur::validate(ValidationResults &results) const
+    {
+        auto connection = input_socket_->connection();
+        if(connection)
+        {
+            const ConnectionDataType& data_type = connection->get().data_type();
+            if((data_type.is<float>() || data_type.is<double>()) == false || data_type.dimensions() == 0)
+            {
+                results.add("Blur only supports float or double attributes.");
+            }
+        }
+
+        BlurKernel kernel = static_cast<BlurKernel>(kernel_property_->value_or_default<int, 1>().value());
+        if(kernel == BlurKernel::custom && custom_weights_.size() % 2 == 0)
+        {
+            results.add("Blur custom kernel needs an odd number of weights.");
+        }
+    }
+} }
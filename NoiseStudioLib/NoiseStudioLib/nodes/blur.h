@@ -0,0 +1,66 @@
+#ifndef BLUR_H
+#define BLUR_H
+
+#include <vector>
+
+#include "graph_node.h"
+
+namespace noises {
+namespace nodes
+{
+    enum class BlurKernel
+    {
+        box,
+        gaussian,
+
+        // The weights passed to set_custom_kernel
+        custom
+    };
+
+    struct WholeGrid;
+
+    // Blurs a 2D grid (e.g. from BlankGrid) with a separable kernel: one pass along the rows, then one along the columns. Pixels past the
+    // edges repeat the edge pixel.
+    class Blur : public GraphNode
+    {
+    public:
+        Blur();
+
+        std::string node_name() const;
+
+        void recalculate_sockets();
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+
+        void validate(ValidationResults& results) const;
+
+        bool is_pure() const;
+
+        std::unique_ptr<GraphNode> clone() const;
+
+        void set_kernel(BlurKernel kernel);
+        void set_radius(unsigned int radius);
+        void set_sigma(float sigma);
+
+        /** Sets the weights for BlurKernel::custom, used along both axes. The middle weight is for the pixel itself, so there must be an
+         *  odd number of them. They aren't normalized. **/
+        void set_custom_kernel(const std::vector<float>& weights);
+
+        /** The weights used along each axis with the current properties. **/
+        std::vector<double> weights() const;
+
+    private:
+        template<typename T>
+        void blur(const CompositeDataBuffer& input, DataBuffer& output, const WholeGrid& grid) const;
+
+        InputSocket* input_socket_;
+        OutputSocket* output_socket_;
+
+        Property* kernel_property_;
+        Property* radius_property_;
+        Property* sigma_property_;
+
+        std::vector<float> custom_weights_;
+    };
+} }
+
+#endif // BLUR_H
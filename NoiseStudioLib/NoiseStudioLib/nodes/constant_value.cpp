@@ -13,5 +13,15 @@ namespace nodes
         output.set_uniform_raw(*value_socket_, value_socket_->data_type(), &buffer_[0]);
     }
 
+    std::unique_ptr<GraphNode> ConstantValue::clone() const
+    {
+        std::unique_ptr<GraphNode> copy = GraphNode::clone();
+        ConstantValue& constant = static_cast<ConstantValue&>(*copy);
+
+        constant.buffer_ = buffer_;
+        constant.value_socket_->set_data_type(value_socket_->data_type());
+        return copy;
+    }
+
     const std::string ConstantValue::socket_name = "Value";
 } }
@@ -29,6 +29,7 @@ namespace nodes
         void set_value(const ptr_array<T, Dimensions> value)
         {
             value.copy_to(buffer_);
+            mark_changed();
             outputs()[socket_name].set_data_type(ConnectionDataType::value<T, Dimensions>());
         }
 
@@ -41,6 +42,10 @@ namespace nodes
 
         void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
 
+        bool is_pure() const { return true; }
+
+        std::unique_ptr<GraphNode> clone() const;
+
     private:
         std::vector<unsigned char> buffer_;
 
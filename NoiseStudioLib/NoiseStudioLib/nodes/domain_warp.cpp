@@ -0,0 +1,191 @@
+#include "domain_warp.h"
+
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include "composite_data_buffer.h"
+#include "nodes/perlin_noise.h"
+
+namespace noises {
+namespace nodes
+{
+    struct DomainWarpData
+    {
+        DomainWarpData() : strength(0), frequency(0) { }
+
+        // One noise field per axis of the points
+        std::vector<PerlinNoiseData> warp;
+
+        // Only loaded if the Noise output is enabled
+        PerlinNoiseData noise;
+
+        float strength;
+        float frequency;
+    };
+
+    DomainWarp::DomainWarp() :
+        seed_socket_(nullptr),
+        points_socket_(nullptr),
+        warped_socket_(nullptr),
+        noise_socket_(nullptr),
+        strength_property_(nullptr),
+        frequency_property_(nullptr),
+        period_property_(nullptr),
+        noise_property_(nullptr)
+    {
+        seed_socket_ = &inputs().add("Seed", SocketType::uniform);
+        seed_socket_->set_accepts(ConnectionDataType::value<long, 1>());
+
+        points_socket_ = &inputs().add("Points", SocketType::attribute);
+        points_socket_->set_accepts(ConnectionDataType::value<float, 2>());
+        points_socket_->set_accepts(ConnectionDataType::value<float, 3>());
+        points_socket_->set_accepts(ConnectionDataType::value<float, 4>());
+        points_socket_->set_accepts(ConnectionDataType::value<float, 5>());
+        points_socket_->set_accepts(ConnectionDataType::value<float, 6>());
+
+        warped_socket_ = &outputs().add("Warped", ConnectionDataType::undefined(), SocketType::attribute);
+
+        strength_property_ = &add_property<float, 1>("Strength");
+        float default_strength = 1.0f;
+        strength_property_->set_default_value<float, 1>(&default_strength);
+
+        frequency_property_ = &add_property<float, 1>("Frequency");
+        float default_frequency = 1.0f;
+        frequency_property_->set_default_value<float, 1>(&default_frequency);
+
+        period_property_ = &add_property<int, 1>("Period");
+        int default_period = 0;
+        period_property_->set_default_value<int, 1>(&default_period);
+
+        noise_property_ = &add_property<int, 1>("Output Noise");
+        int default_output_noise = 0;
+        noise_property_->set_default_value<int, 1>(&default_output_noise);
+    }
+
+    std::string DomainWarp::node_name() const
+    {
+        return "Domain Warp";
+    }
+
+    bool DomainWarp::is_elementwise() const
+    {
+        return true;
+    }
+
+    bool DomainWarp::is_pure() const
+    {
+        return true;
+    }
+
+    void DomainWarp::recalculate_sockets()
+    {
+        if(points_socket_ == nullptr || warped_socket_ == nullptr || noise_property_ == nullptr)
+            return; // Still initializing
+
+        auto points_connection = points_socket_->connection();
+        if(points_connection)
+            warped_socket_->set_data_type(points_connection->get().data_type());
+        else
+            warped_socket_->set_data_type(ConnectionDataType::undefined());
+
+        bool output_noise = noise_property_->value_or_default<int, 1>().value() != 0;
+
+        if(output_noise && noise_socket_ == nullptr)
+        {
+            noise_socket_ = &outputs().add("Noise", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+        }
+        else if(!output_noise && noise_socket_ != nullptr)
+        {
+            outputs().remove(*noise_socket_);
+            noise_socket_ = nullptr;
+        }
+    }
+
+    void DomainWarp::set_strength(float strength)
+    {
+        strength_property_->set_value<float, 1>(&strength);
+    }
+
+    void DomainWarp::set_frequency(float frequency)
+    {
+        frequency_property_->set_value<float, 1>(&frequency);
+    }
+
+    void DomainWarp::set_period(int period)
+    {
+        period_property_->set_value<int, 1>(&period);
+    }
+
+    void DomainWarp::set_output_noise(bool output_noise)
+    {
+        int value = output_noise ? 1 : 0;
+        noise_property_->set_value<int, 1>(&value);
+    }
+
+    void DomainWarp::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
+    {
+        long seed = input.get_uniform<long, 1>(*seed_socket_);
+        int dimensions = points_socket_->connection()->get().data_type().dimensions();
+
+        std::shared_ptr<DomainWarpData> data(new DomainWarpData);
+        data->strength = strength_property_->value_or_default<float, 1>().value();
+        data->frequency = frequency_property_->value_or_default<float, 1>().value();
+
+        // The warp fields are sampled at point * frequency, so they have to repeat every period * frequency to tile with the output
+        int period = period_property_->value_or_default<int, 1>().value();
+        int warp_period = static_cast<int>(std::round(period * data->frequency));
+
+        // Seed + 1 onwards for the warp axes so the Noise output (Seed) matches a PerlinNoise node with the same seed
+        data->warp.resize(dimensions);
+        for(int i = 0; i < dimensions; i++)
+        {
+            PerlinNoise::load_data(data->warp[i], seed + 1 + i, dimensions, warp_period);
+        }
+
+        if(noise_socket_ != nullptr)
+            PerlinNoise::load_data(data->noise, seed, dimensions, period);
+
+        output.set_scratch(0, std::move(data));
+    }
+
+    void DomainWarp::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        const DomainWarpData& data = *output.get_scratch_ref<std::shared_ptr<DomainWarpData>>(0);
+        const int dimensions = data.warp.size();
+        const ConnectionDataType& points_type = ConnectionDataType::dynamic<float>(dimensions);
+
+        const float* points = reinterpret_cast<const float*>(std::get<0>(input.get_attribute_all_raw(*points_socket_, points_type)));
+        float* warped_out = reinterpret_cast<float*>(output.get_attribute_all_raw(*warped_socket_, warped_socket_->data_type()));
+        float* noise_out = nullptr;
+        if(noise_socket_ != nullptr)
+            noise_out = reinterpret_cast<float*>(output.get_attribute_all_raw(*noise_socket_, ConnectionDataType::value<float, 1>()));
+
+        std::array<float, PerlinNoise::max_dimensions> sample;
+
+        for(DataBuffer::size_type index = begin; index < end; index++)
+        {
+            const float* point = points + index * dimensions;
+            float* warped = warped_out + index * dimensions;
+
+            for(int i = 0; i < dimensions; i++)
+            {
+                sample[i] = point[i] * data.frequency;
+            }
+
+            for(int i = 0; i < dimensions; i++)
+            {
+                warped[i] = point[i] + PerlinNoise::evaluate(data.warp[i], &sample[0]) * data.strength;
+            }
+
+            if(noise_out != nullptr)
+                noise_out[index] = PerlinNoise::evaluate(data.noise, warped);
+        }
+    }
+
+    void DomainWarp::execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
+} }
@@ -0,0 +1,46 @@
+#ifndef DOMAIN_WARP_H
+#define DOMAIN_WARP_H
+
+#include "graph_node.h"
+
+namespace noises {
+namespace nodes
+{
+    // Offsets each point by perlin noise (one noise field per axis), optionally evaluating noise at the warped point in the same pass
+    class DomainWarp : public GraphNode
+    {
+    public:
+        DomainWarp();
+
+        std::string node_name() const;
+
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+        void execute_attributes(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type index) const;
+
+        bool is_elementwise() const;
+        bool is_pure() const;
+
+        void recalculate_sockets();
+
+        void set_strength(float strength);
+        void set_frequency(float frequency);
+        void set_period(int period);
+
+        /** Adds or removes the Noise output, which is perlin noise (using Seed) sampled at the warped points. **/
+        void set_output_noise(bool output_noise);
+
+    private:
+        InputSocket* seed_socket_;
+        InputSocket* points_socket_;
+        OutputSocket* warped_socket_;
+        OutputSocket* noise_socket_;
+
+        Property* strength_property_;
+        Property* frequency_property_;
+        Property* period_property_;
+        Property* noise_property_;
+    };
+} }
+
+#endif // DOMAIN_WARP_H
@@ -0,0 +1,459 @@
+#include "erosion.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "composite_data_buffer.h"
+#include "validation_results.h"
+#include "fast_math.h"
+#include "parallel.h"
+#include "whole_grid.h"
+
+namespace
+{
+    // The order the four outflows of a pixel are stored in
+    enum Direction { left = 0, right = 1, up = 2, down = 3 };
+
+    struct ErosionSettings
+    {
+        std::uint32_t seed;
+        float rainfall;
+        float evaporation;
+        float capacity;
+        float erosion_rate;
+        float deposition_rate;
+        float thermal_rate;
+        float talus;
+    };
+
+    // A number in [0, 1) that only depends on its arguments (murmur3's finalizer), so the rain on a pixel doesn't depend on which
+    // thread gets to it first. 32 bit so it vectorizes.
+    inline float rain_noise(std::uint32_t seed, std::uint32_t iteration, std::uint32_t index)
+    {
+        std::uint32_t h = seed ^ (iteration * 0x85EBCA77u) ^ (index * 0x9E3779B1u);
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // The per pixel work of one step. Each step is split into two passes over the rows. The first works out how much leaves each pixel
+    // towards each neighbour and only writes to that pixel's outflow; the second gathers what arrives from the neighbours and writes
+    // the pixel's new state into the other half of the double buffer. Neither pass writes anything another pixel reads in the same pass.
+    //
+    // Each thread works on its own copy, so the compiler can keep the settings and pointers in registers instead of assuming that
+    // writing a pixel might change them.
+    struct ErosionPixels
+    {
+        std::size_t width;
+        std::size_t height;
+        ErosionSettings settings;
+        std::uint32_t iteration;
+
+        const float* ground;
+        const float* water;
+        const float* sediment;
+        float* concentration;
+
+        float* next_ground;
+        float* next_water;
+        float* next_sediment;
+
+        // How much leaves each pixel towards each neighbour, one plane per Direction so the loops read them contiguously
+        float* outflow[4];
+
+        float rain(std::uint32_t rain_iteration, std::size_t index) const
+        {
+            return settings.rainfall * 2.0f * rain_noise(settings.seed, rain_iteration, static_cast<std::uint32_t>(index));
+        }
+
+        // Sum of what the neighbours send towards {index}, each outflow weighted by weight(neighbour)
+        template<bool Interior, typename Weight>
+        float gather(std::size_t x, std::size_t y, std::size_t index, Weight weight) const
+        {
+            float in = 0.0f;
+            if(Interior || x > 0)
+                in += outflow[right][index - 1] * weight(index - 1);
+            if(Interior || x + 1 < width)
+                in += outflow[left][index + 1] * weight(index + 1);
+            if(Interior || y > 0)
+                in += outflow[down][index - width] * weight(index - width);
+            if(Interior || y + 1 < height)
+                in += outflow[up][index + width] * weight(index + width);
+            return in;
+        }
+
+        // How far each neighbour is below {index}, using level(neighbour), minus {threshold}. 0 for neighbours that aren't lower or
+        // aren't there. Returns the largest.
+        template<bool Interior, typename Level>
+        float drops(std::size_t x, std::size_t y, std::size_t index, float threshold, Level level, float (&out)[4]) const
+        {
+            float own = level(index) - threshold;
+            out[left] = Interior || x > 0 ? std::max(own - level(index - 1), 0.0f) : 0.0f;
+            out[right] = Interior || x + 1 < width ? std::max(own - level(index + 1), 0.0f) : 0.0f;
+            out[up] = Interior || y > 0 ? std::max(own - level(index - width), 0.0f) : 0.0f;
+            out[down] = Interior || y + 1 < height ? std::max(own - level(index + width), 0.0f) : 0.0f;
+
+            return std::max(std::max(out[left], out[right]), std::max(out[up], out[down]));
+        }
+
+        // Spreads {amount} over the neighbours in proportion to {drops}. {amount} has to be 0 when all the drops are.
+        void store_outflow(std::size_t index, const float (&drops)[4], float amount)
+        {
+            float total = drops[left] + drops[right] + drops[up] + drops[down];
+            float scale = amount / std::max(total, std::numeric_limits<float>::min());
+
+            for(int direction = 0; direction < 4; direction++)
+            {
+                outflow[direction][index] = drops[direction] * scale;
+            }
+        }
+
+        // Water flows towards lower water surfaces. At most half the largest difference moves, so it never overshoots and sloshes back.
+        template<bool Interior>
+        void water_outflow(std::size_t x, std::size_t y, std::size_t index)
+        {
+            const float* ground_levels = ground;
+            const float* water_levels = water;
+            auto surface = [ground_levels, water_levels](std::size_t i) { return ground_levels[i] + water_levels[i]; };
+
+            float differences[4];
+            float largest = drops<Interior>(x, y, index, 0.0f, surface, differences);
+            store_outflow(index, differences, std::min(water[index], largest * 0.5f));
+
+            float carried = sediment[index] / std::max(water[index], std::numeric_limits<float>::min());
+            concentration[index] = noises::fast_math::select(water[index] > 0.0f, carried, 0.0f);
+        }
+
+        template<bool Interior>
+        void water_gather(std::size_t x, std::size_t y, std::size_t index)
+        {
+            const float* concentrations = concentration;
+            auto carried = [concentrations](std::size_t i) { return concentrations[i]; };
+            auto one = [](std::size_t) { return 1.0f; };
+            const float* ground_levels = ground;
+            auto ground_level = [ground_levels](std::size_t i) { return ground_levels[i]; };
+
+            float water_out = outflow[left][index] + outflow[right][index] + outflow[up][index] + outflow[down][index];
+
+            float new_water = water[index] - water_out + gather<Interior>(x, y, index, one);
+            float new_sediment = sediment[index] - water_out * concentration[index] + gather<Interior>(x, y, index, carried);
+
+            // Faster flow carries more. Over capacity some of the extra is deposited, under it some of the ground is eroded, but never
+            // more than half way down to the lowest neighbour or the water would carve pits.
+            float capacity = settings.capacity * water_out;
+            float slopes[4];
+            float steepest = drops<Interior>(x, y, index, 0.0f, ground_level, slopes);
+
+            float deposited = std::max(new_sediment - capacity, 0.0f) * settings.deposition_rate;
+            float eroded = std::min(std::max(capacity - new_sediment, 0.0f) * settings.erosion_rate, steepest * 0.5f);
+
+            next_ground[index] = ground[index] + deposited - eroded;
+            next_sediment[index] = new_sediment - deposited + eroded;
+            next_water[index] = new_water * (1.0f - settings.evaporation) + rain(iteration + 1, index);
+        }
+
+        // Material above the talus slides to the lower neighbours. As with water, at most half the largest excess moves.
+        template<bool Interior>
+        void thermal_outflow(std::size_t x, std::size_t y, std::size_t index)
+        {
+            const float* ground_levels = ground;
+            auto ground_level = [ground_levels](std::size_t i) { return ground_levels[i]; };
+
+            float excess[4];
+            float largest = drops<Interior>(x, y, index, settings.talus, ground_level, excess);
+            store_outflow(index, excess, largest * 0.5f * settings.thermal_rate);
+        }
+
+        template<bool Interior>
+        void thermal_gather(std::size_t x, std::size_t y, std::size_t index)
+        {
+            auto one = [](std::size_t) { return 1.0f; };
+
+            float out = outflow[left][index] + outflow[right][index] + outflow[up][index] + outflow[down][index];
+            next_ground[index] = ground[index] - out + gather<Interior>(x, y, index, one);
+        }
+    };
+
+    class ErosionSimulation
+    {
+    public:
+        ErosionSimulation(const float* heights, std::size_t width, std::size_t height, const ErosionSettings& settings) :
+            ground_(heights, heights + width * height),
+            water_(width * height),
+            sediment_(width * height, 0.0f),
+            concentration_(width * height),
+            next_ground_(width * height),
+            next_water_(width * height),
+            next_sediment_(width * height),
+            outflow_(width * height * 4)
+        {
+            pixels_.width = width;
+            pixels_.height = height;
+            pixels_.settings = settings;
+            pixels_.iteration = 0;
+
+            for(std::size_t i = 0; i < water_.size(); i++)
+            {
+                water_[i] = pixels_.rain(0, i);
+            }
+        }
+
+        void run(unsigned int iterations)
+        {
+            for(pixels_.iteration = 0; pixels_.iteration < iterations; pixels_.iteration++)
+            {
+                for_each_pixel<&ErosionPixels::water_outflow<false>, &ErosionPixels::water_outflow<true>>();
+                for_each_pixel<&ErosionPixels::water_gather<false>, &ErosionPixels::water_gather<true>>();
+                ground_.swap(next_ground_);
+                water_.swap(next_water_);
+                sediment_.swap(next_sediment_);
+
+                if(pixels_.settings.thermal_rate > 0.0f)
+                {
+                    for_each_pixel<&ErosionPixels::thermal_outflow<false>, &ErosionPixels::thermal_outflow<true>>();
+                    for_each_pixel<&ErosionPixels::thermal_gather<false>, &ErosionPixels::thermal_gather<true>>();
+                    ground_.swap(next_ground_);
+                }
+            }
+        }
+
+        // Whatever sediment is still suspended settles where it is
+        void write(float* out) const
+        {
+            for(std::size_t i = 0; i < ground_.size(); i++)
+            {
+                out[i] = ground_[i] + sediment_[i];
+            }
+        }
+
+    private:
+        typedef void (ErosionPixels::*PixelFunction)(std::size_t x, std::size_t y, std::size_t index);
+
+        // Calls Edge for pixels on the edge of the grid and Interior for the rest. Interior pixels have all four neighbours, so they
+        // don't need any bounds checks, which lets the loop over them vectorize.
+        template<PixelFunction Edge, PixelFunction Interior>
+        void for_each_pixel()
+        {
+            pixels_.ground = ground_.data();
+            pixels_.water = water_.data();
+            pixels_.sediment = sediment_.data();
+            pixels_.concentration = concentration_.data();
+            pixels_.next_ground = next_ground_.data();
+            pixels_.next_water = next_water_.data();
+            pixels_.next_sediment = next_sediment_.data();
+            for(int direction = 0; direction < 4; direction++)
+            {
+                pixels_.outflow[direction] = &outflow_[direction * ground_.size()];
+            }
+
+            const ErosionPixels& shared = pixels_;
+
+            noises::parallel_for(pixels_.height, noises::nodes::WholeGrid::rows_per_task(), [&shared](std::size_t begin, std::size_t end)
+            {
+                ErosionPixels pixels = shared;
+                const std::size_t width = pixels.width;
+
+                for(std::size_t y = begin; y < end; y++)
+                {
+                    const std::size_t row = y * width;
+
+                    if(y == 0 || y + 1 == pixels.height || width < 3)
+                    {
+                        for(std::size_t x = 0; x < width; x++)
+                        {
+                            (pixels.*Edge)(x, y, row + x);
+                        }
+                        continue;
+                    }
+
+                    (pixels.*Edge)(0, y, row);
+                    for(std::size_t x = 1; x + 1 < width; x++)
+                    {
+                        (pixels.*Interior)(x, y, row + x);
+                    }
+                    (pixels.*Edge)(width - 1, y, row + width - 1);
+                }
+            });
+        }
+
+        ErosionPixels pixels_;
+
+        std::vector<float> ground_;
+        std::vector<float> water_;
+        std::vector<float> sediment_;
+
+        // Sediment per unit of water, so sediment moves along with the water carrying it
+        std::vector<float> concentration_;
+
+        std::vector<float> next_ground_;
+        std::vector<float> next_water_;
+        std::vector<float> next_sediment_;
+
+        std::vector<float> outflow_;
+    };
+}
+
+namespace noises {
+namespace nodes
+{
+    Erosion::Erosion() :
+        seed_socket_(nullptr),
+        height_socket_(nullptr),
+        eroded_socket_(nullptr),
+        iterations_property_(nullptr),
+        rainfall_property_(nullptr),
+        evaporation_property_(nullptr),
+        capacity_property_(nullptr),
+        erosion_rate_property_(nullptr),
+        deposition_rate_property_(nullptr),
+        thermal_rate_property_(nullptr),
+        talus_property_(nullptr)
+    {
+        seed_socket_ = &inputs().add("Seed", SocketType::uniform);
+        seed_socket_->set_accepts(ConnectionDataType::value<long, 1>());
+
+        height_socket_ = &inputs().add("Height", SocketType::attribute);
+        height_socket_->set_accepts(ConnectionDataType::value<float, 1>());
+
+        eroded_socket_ = &outputs().add("Eroded", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+
+        iterations_property_ = &add_property<unsigned int, 1>("Iterations");
+        unsigned int default_iterations = 50;
+        iterations_property_->set_default_value<unsigned int, 1>(&default_iterations);
+
+        rainfall_property_ = &add_property<float, 1>("Rainfall");
+        float default_rainfall = 0.01f;
+        rainfall_property_->set_default_value<float, 1>(&default_rainfall);
+
+        evaporation_property_ = &add_property<float, 1>("Evaporation");
+        float default_evaporation = 0.05f;
+        evaporation_property_->set_default_value<float, 1>(&default_evaporation);
+
+        capacity_property_ = &add_property<float, 1>("Sediment Capacity");
+        float default_capacity = 1.0f;
+        capacity_property_->set_default_value<float, 1>(&default_capacity);
+
+        erosion_rate_property_ = &add_property<float, 1>("Erosion Rate");
+        float default_erosion_rate = 0.3f;
+        erosion_rate_property_->set_default_value<float, 1>(&default_erosion_rate);
+
+        deposition_rate_property_ = &add_property<float, 1>("Deposition Rate");
+        float default_deposition_rate = 0.3f;
+        deposition_rate_property_->set_default_value<float, 1>(&default_deposition_rate);
+
+        thermal_rate_property_ = &add_property<float, 1>("Thermal Rate");
+        float default_thermal_rate = 0.5f;
+        thermal_rate_property_->set_default_value<float, 1>(&default_thermal_rate);
+
+        talus_property_ = &add_property<float, 1>("Talus");
+        float default_talus = 0.01f;
+        talus_property_->set_default_value<float, 1>(&default_talus);
+    }
+
+    std::string Erosion::node_name() const
+    {
+        return "Erosion";
+    }
+
+    bool Erosion::is_pure() const
+    {
+        return true;
+    }
+
+    void Erosion::set_iterations(unsigned int iterations)
+    {
+        iterations_property_->set_value<unsigned int, 1>(&iterations);
+    }
+
+    void Erosion::set_rainfall(float rainfall)
+    {
+        rainfall_property_->set_value<float, 1>(&rainfall);
+    }
+
+    void Erosion::set_evaporation(float evaporation)
+    {
+        evaporation_property_->set_value<float, 1>(&evaporation);
+    }
+
+    void Erosion::set_sediment_capacity(float sediment_capacity)
+    {
+        capacity_property_->set_value<float, 1>(&sediment_capacity);
+    }
+
+    void Erosion::set_erosion_rate(float erosion_rate)
+    {
+        erosion_rate_property_->set_value<float, 1>(&erosion_rate);
+    }
+
+    void Erosion::set_deposition_rate(float deposition_rate)
+    {
+        deposition_rate_property_->set_value<float, 1>(&deposition_rate);
+    }
+
+    void Erosion::set_thermal_rate(float thermal_rate)
+    {
+        thermal_rate_property_->set_value<float, 1>(&thermal_rate);
+    }
+
+    void Erosion::set_talus(float talus)
+    {
+        talus_property_->set_value<float, 1>(&talus);
+    }
+
+    void Erosion::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type, DataBuffer::size_type) const
+    {
+        // Every iteration moves material between neighbours, so Erosion isn't element-wise and this is called once for the whole grid
+        WholeGrid grid(output.attribute_info(), "Erosion");
+        if(grid.empty())
+            return;
+
+        ErosionSettings settings;
+        // Both halves of the seed matter, folded together for the 32 bit rain hash
+        std::uint64_t seed = static_cast<std::uint64_t>(input.get_uniform<long, 1>(*seed_socket_));
+        settings.seed = static_cast<std::uint32_t>(seed ^ (seed >> 32));
+        settings.rainfall = rainfall_property_->value_or_default<float, 1>().value();
+        settings.evaporation = evaporation_property_->value_or_default<float, 1>().value();
+        settings.capacity = capacity_property_->value_or_default<float, 1>().value();
+        settings.erosion_rate = erosion_rate_property_->value_or_default<float, 1>().value();
+        settings.deposition_rate = deposition_rate_property_->value_or_default<float, 1>().value();
+        settings.thermal_rate = thermal_rate_property_->value_or_default<float, 1>().value();
+        settings.talus = talus_property_->value_or_default<float, 1>().value();
+
+        const float* heights = reinterpret_cast<const float*>(std::get<0>(input.get_attribute_all_raw(*height_socket_, ConnectionDataType::value<float, 1>())));
+        float* eroded = reinterpret_cast<float*>(output.get_attribute_all_raw(*eroded_socket_, ConnectionDataType::value<float, 1>()));
+
+        ErosionSimulation simulation(heights, grid.width, grid.height, settings);
+        simulation.run(iterations_property_->value_or_default<unsigned int, 1>().value());
+        simulation.write(eroded);
+    }
+
+    void Erosion::validate(ValidationResults &results) const
+    {
+        auto check_fraction = [&results](const Property* property)
+        {
+            float value = property->value_or_default<float, 1>().value();
+            if(value < 0.0f || value > 1.0f)
+                results.add("Erosion " + property->name() + " must be between 0 and 1.");
+        };
+
+        check_fraction(evaporation_property_);
+        check_fraction(erosion_rate_property_);
+        check_fraction(deposition_rate_property_);
+        check_fraction(thermal_rate_property_);
+
+        auto check_not_negative = [&results](const Property* property)
+        {
+            if(property->value_or_default<float, 1>().value() < 0.0f)
+                results.add("Erosion " + property->name() + " can't be negative.");
+        };
+
+        check_not_negative(rainfall_property_);
+        check_not_negative(capacity_property_);
+        check_not_negative(talus_property_);
+    }
+} }
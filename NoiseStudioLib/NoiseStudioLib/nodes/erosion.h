@@ -0,0 +1,65 @@
+#ifndef EROSION_H
+#define EROSION_H
+
+#include "graph_node.h"
+
+namespace noises {
+namespace nodes
+{
+    // Erodes a heightmap on a 2D grid (e.g. from BlankGrid). Each iteration rains on the grid, moves water and the sediment it carries
+    // downhill to the four neighbours, erodes or deposits depending on how much the water can carry, evaporates some of the water, and
+    // then slides material down any slope steeper than the talus (thermal erosion). Every step reads the previous state and writes a
+    // new one, so the rows can be updated in parallel and the result only depends on the inputs, never on the thread count.
+    class Erosion : public GraphNode
+    {
+    public:
+        Erosion();
+
+        std::string node_name() const;
+
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+
+        void validate(ValidationResults& results) const;
+
+        bool is_pure() const;
+
+        void set_iterations(unsigned int iterations);
+
+        /** Average amount of water added to each pixel per iteration. The seed varies it from pixel to pixel. **/
+        void set_rainfall(float rainfall);
+
+        /** Fraction of the water that evaporates each iteration, 0 to 1. **/
+        void set_evaporation(float evaporation);
+
+        /** How much sediment water can carry per unit of water flowing out of a pixel. **/
+        void set_sediment_capacity(float sediment_capacity);
+
+        /** Fraction of the spare capacity eroded from the ground each iteration, 0 to 1. **/
+        void set_erosion_rate(float erosion_rate);
+
+        /** Fraction of the sediment over capacity deposited each iteration, 0 to 1. **/
+        void set_deposition_rate(float deposition_rate);
+
+        /** Fraction of the height over the talus that slides to lower neighbours each iteration, 0 to 1. 0 turns thermal erosion off. **/
+        void set_thermal_rate(float thermal_rate);
+
+        /** The largest height difference between neighbouring pixels that thermal erosion leaves alone. **/
+        void set_talus(float talus);
+
+    private:
+        InputSocket* seed_socket_;
+        InputSocket* height_socket_;
+        OutputSocket* eroded_socket_;
+
+        Property* iterations_property_;
+        Property* rainfall_property_;
+        Property* evaporation_property_;
+        Property* capacity_property_;
+        Property* erosion_rate_property_;
+        Property* deposition_rate_property_;
+        Property* thermal_rate_property_;
+        Property* talus_property_;
+    };
+} }
+
+#endif // EROSION_H
@@ -0,0 +1,196 @@
+#include "expression.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "composite_data_buffer.h"
+#include "validation_results.h"
+
+namespace noises {
+namespace nodes
+{
+    Expression::Expression() :
+        output_socket_(nullptr)
+    {
+        output_socket_ = &outputs().add("Output", ConnectionDataType::value<float, 1>(), SocketType::uniform);
+
+        set_expression("0");
+    }
+
+    std::string Expression::node_name() const
+    {
+        return "Expression";
+    }
+
+    void Expression::set_expression(const std::string& expression)
+    {
+        expression_ = expression;
+
+        try
+        {
+            program_ = ExpressionProgram::compile(expression);
+            error_.clear();
+        }
+        catch(const std::invalid_argument& e)
+        {
+            program_ = ExpressionProgram();
+            error_ = e.what();
+        }
+
+        mark_changed();
+        request_recalculate_sockets();
+    }
+
+    std::unique_ptr<GraphNode> Expression::clone() const
+    {
+        std::unique_ptr<GraphNode> copy = GraphNode::clone();
+        static_cast<Expression&>(*copy).set_expression(expression_);
+        return copy;
+    }
+
+    const std::string& Expression::expression() const
+    {
+        return expression_;
+    }
+
+    const ExpressionProgram& Expression::program() const
+    {
+        return program_;
+    }
+
+    void Expression::recalculate_sockets()
+    {
+        if(output_socket_ == nullptr)
+            return; // Still initializing
+
+        const std::vector<ExpressionVariable>& variables = program_.variables();
+
+        // Remove sockets for names the expression doesn't use any more
+        std::vector<std::string> unused;
+        for(const InputSocket& socket : inputs().all_sockets())
+        {
+            auto used = std::find_if(variables.begin(), variables.end(),
+                                     [&socket](const ExpressionVariable& variable) { return variable.name == socket.name(); });
+            if(used == variables.end())
+                unused.push_back(socket.name());
+        }
+
+        for(const std::string& name : unused)
+        {
+            inputs().remove(input(name));
+        }
+
+        variable_sockets_.clear();
+
+        bool any_attribute = false;
+
+        for(const ExpressionVariable& variable : variables)
+        {
+            if(!inputs().get_by_name(variable.name))
+            {
+                InputSocket& socket = inputs().add(variable.name, SocketType::either);
+                socket.set_accepts(ConnectionDataType::value<float, 1>());
+                socket.set_accepts(ConnectionDataType::value<float, 2>());
+                socket.set_accepts(ConnectionDataType::value<float, 3>());
+                socket.set_accepts(ConnectionDataType::value<float, 4>());
+            }
+
+            InputSocket& socket = input(variable.name);
+            variable_sockets_.push_back(&socket);
+
+            auto connection = socket.connection();
+            if(connection && connection->get().output().type() == SocketType::attribute)
+                any_attribute = true;
+        }
+
+        // If *any* input is an attribute, the result is an attribute
+        output_socket_->set_type(any_attribute ? SocketType::attribute : SocketType::uniform);
+    }
+
+    std::vector<ExpressionInput> Expression::resolve_inputs(const CompositeDataBuffer &input) const
+    {
+        std::vector<ExpressionInput> resolved;
+
+        for(const InputSocket* socket : variable_sockets_)
+        {
+            const Connection& connection = socket->connection()->get();
+            const ConnectionDataType& data_type = connection.data_type();
+
+            ExpressionInput expression_input;
+
+            if(connection.output().type() == SocketType::attribute)
+            {
+                expression_input.data = reinterpret_cast<const float*>(std::get<0>(input.get_attribute_all_raw(*socket, data_type)));
+                expression_input.element_stride = data_type.dimensions();
+            }
+            else
+            {
+                expression_input.data = reinterpret_cast<const float*>(input.get_uniform_raw(*socket, data_type));
+                expression_input.element_stride = 0;
+            }
+
+            resolved.push_back(expression_input);
+        }
+
+        return resolved;
+    }
+
+    void Expression::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
+    {
+        if(output_socket_->type() == SocketType::attribute)
+            return; // Handled in execute_attribute_range
+
+        float result = 0.0f;
+        program_.evaluate(resolve_inputs(input), &result, 1);
+        output.set_uniform<float, 1>(*output_socket_, &result);
+    }
+
+    void Expression::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        if(output_socket_->type() == SocketType::uniform)
+            return; // Handled in execute_uniforms
+
+        std::vector<ExpressionInput> inputs = resolve_inputs(input);
+        for(ExpressionInput& expression_input : inputs)
+        {
+            expression_input.data += begin * expression_input.element_stride;
+        }
+
+        float* out = reinterpret_cast<float*>(output.get_attribute_all_raw(*output_socket_, output_socket_->data_type()));
+        program_.evaluate(inputs, out + begin, end - begin);
+    }
+
+    void Expression::execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
+
+    bool Expression::is_elementwise() const
+    {
+        return true;
+    }
+
+    void Expression::validate(ValidationResults &results) const
+    {
+        if(!error_.empty())
+        {
+            results.add("Expression: " + error_);
+            return;
+        }
+
+        const std::vector<ExpressionVariable>& variables = program_.variables();
+
+        for(std::size_t i = 0; i < variables.size(); i++)
+        {
+            auto connection = variable_sockets_[i]->connection();
+            if(!connection)
+                continue; // Validation will be handled by the global validator
+
+            unsigned int dimensions = connection->get().data_type().dimensions();
+            if(variables[i].max_component >= dimensions)
+            {
+                results.add("Expression uses a component of " + variables[i].name + " that its input doesn't have.");
+            }
+        }
+    }
+} }
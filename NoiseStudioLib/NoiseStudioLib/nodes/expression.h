@@ -0,0 +1,51 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <string>
+#include <vector>
+
+#include "graph_node.h"
+#include "nodes/expression_program.h"
+
+namespace noises {
+namespace nodes
+{
+    // Evaluates a formula over named float inputs, e.g. "a*0.5 + sin(b.x)*c". Replaces chains of Math nodes with a single pass
+    // that doesn't need a buffer per intermediate value. There is one input socket per name used in the expression.
+    class Expression : public GraphNode
+    {
+    public:
+        Expression();
+
+        std::string node_name() const;
+
+        /** Compiles the expression and adds or removes input sockets to match the names it uses. A malformed expression is reported by validate. **/
+        void set_expression(const std::string& expression);
+        const std::string& expression() const;
+
+        const ExpressionProgram& program() const;
+
+        void recalculate_sockets();
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+        void execute_attributes(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type index) const;
+        bool is_elementwise() const;
+
+        void validate(ValidationResults& results) const;
+
+        std::unique_ptr<GraphNode> clone() const;
+
+    private:
+        std::vector<ExpressionInput> resolve_inputs(const CompositeDataBuffer& input) const;
+
+        std::string expression_;
+        std::string error_;
+        ExpressionProgram program_;
+
+        // In the same order as program_.variables()
+        std::vector<InputSocket*> variable_sockets_;
+        OutputSocket* output_socket_;
+    };
+} }
+
+#endif // EXPRESSION_H
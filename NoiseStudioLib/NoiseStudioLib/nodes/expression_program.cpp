@@ -0,0 +1,598 @@
+#include "expression_program.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace noises {
+namespace nodes
+{
+    namespace
+    {
+        const std::size_t max_registers = 256;
+
+        struct ExpressionFunction
+        {
+            const char* name;
+            ExpressionOpcode opcode;
+            unsigned int arity;
+        };
+
+        const ExpressionFunction functions[] =
+        {
+            { "min", ExpressionOpcode::min, 2 },
+            { "max", ExpressionOpcode::max, 2 },
+            { "pow", ExpressionOpcode::power, 2 },
+            { "mod", ExpressionOpcode::mod, 2 },
+            { "atan2", ExpressionOpcode::atan2, 2 },
+            { "clamp", ExpressionOpcode::clamp, 3 },
+            { "lerp", ExpressionOpcode::lerp, 3 },
+            { "abs", ExpressionOpcode::abs, 1 },
+            { "sqrt", ExpressionOpcode::sqrt, 1 },
+            { "exp", ExpressionOpcode::exp, 1 },
+            { "log", ExpressionOpcode::log, 1 },
+            { "log2", ExpressionOpcode::log2, 1 },
+            { "log10", ExpressionOpcode::log10, 1 },
+            { "floor", ExpressionOpcode::floor, 1 },
+            { "ceil", ExpressionOpcode::ceil, 1 },
+            { "round", ExpressionOpcode::round, 1 },
+            { "fract", ExpressionOpcode::fract, 1 },
+            { "sin", ExpressionOpcode::sin, 1 },
+            { "cos", ExpressionOpcode::cos, 1 },
+            { "tan", ExpressionOpcode::tan, 1 },
+            { "asin", ExpressionOpcode::asin, 1 },
+            { "acos", ExpressionOpcode::acos, 1 },
+            { "atan", ExpressionOpcode::atan, 1 }
+        };
+
+        ExpressionInstruction make_instruction(ExpressionOpcode opcode)
+        {
+            ExpressionInstruction instruction;
+            instruction.opcode = opcode;
+            instruction.target = 0;
+            instruction.a = 0;
+            instruction.b = 0;
+            instruction.c = 0;
+            instruction.input = 0;
+            instruction.component = 0;
+            instruction.constant = 0.0f;
+            return instruction;
+        }
+
+        template<typename Function>
+        void unary_lanes(float* target, const float* a, std::size_t count, Function function)
+        {
+            for(std::size_t i = 0; i < count; i++)
+                target[i] = function(a[i]);
+        }
+
+        template<typename Function>
+        void binary_lanes(float* target, const float* a, const float* b, std::size_t count, Function function)
+        {
+            for(std::size_t i = 0; i < count; i++)
+                target[i] = function(a[i], b[i]);
+        }
+
+        template<typename Function>
+        void ternary_lanes(float* target, const float* a, const float* b, const float* c, std::size_t count, Function function)
+        {
+            for(std::size_t i = 0; i < count; i++)
+                target[i] = function(a[i], b[i], c[i]);
+        }
+
+        // Runs one instruction over {count} lanes. Register r starts at registers + r * stride. The opcode switch is
+        // outside the lane loops so each case is a tight loop the compiler can vectorize.
+        void execute_instruction(const ExpressionInstruction& instruction, float* registers, std::size_t stride, std::size_t count,
+                                 const std::vector<ExpressionInput>* inputs, std::size_t first_element)
+        {
+            float* t = registers + instruction.target * stride;
+            const float* a = registers + instruction.a * stride;
+            const float* b = registers + instruction.b * stride;
+            const float* c = registers + instruction.c * stride;
+
+            switch(instruction.opcode)
+            {
+                case ExpressionOpcode::load_input:
+                {
+                    const ExpressionInput& input = (*inputs)[instruction.input];
+                    if(input.element_stride == 0)
+                    {
+                        std::fill(t, t + count, input.data[instruction.component]);
+                    }
+                    else
+                    {
+                        const float* source = input.data + first_element * input.element_stride + instruction.component;
+                        for(std::size_t i = 0; i < count; i++)
+                            t[i] = source[i * input.element_stride];
+                    }
+                    break;
+                }
+                case ExpressionOpcode::load_constant:
+                    std::fill(t, t + count, instruction.constant);
+                    break;
+
+                case ExpressionOpcode::add:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return x + y; });
+                    break;
+                case ExpressionOpcode::subtract:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return x - y; });
+                    break;
+                case ExpressionOpcode::multiply:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return x * y; });
+                    break;
+                case ExpressionOpcode::divide:
+                    // Same as the Math node, dividing by zero gives zero
+                    binary_lanes(t, a, b, count, [](float x, float y) { return y == 0.0f ? 0.0f : x / y; });
+                    break;
+                case ExpressionOpcode::mod:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return y == 0.0f ? 0.0f : std::fmod(x, y); });
+                    break;
+                case ExpressionOpcode::power:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return std::pow(x, y); });
+                    break;
+                case ExpressionOpcode::min:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return y < x ? y : x; });
+                    break;
+                case ExpressionOpcode::max:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return x < y ? y : x; });
+                    break;
+                case ExpressionOpcode::atan2:
+                    binary_lanes(t, a, b, count, [](float x, float y) { return std::atan2(x, y); });
+                    break;
+
+                case ExpressionOpcode::clamp:
+                    ternary_lanes(t, a, b, c, count, [](float x, float low, float high) { return x < low ? low : (high < x ? high : x); });
+                    break;
+                case ExpressionOpcode::lerp:
+                    ternary_lanes(t, a, b, c, count, [](float x, float y, float amount) { return x + (y - x) * amount; });
+                    break;
+
+                case ExpressionOpcode::negate:
+                    unary_lanes(t, a, count, [](float x) { return -x; });
+                    break;
+                case ExpressionOpcode::abs:
+                    unary_lanes(t, a, count, [](float x) { return std::fabs(x); });
+                    break;
+                case ExpressionOpcode::sqrt:
+                    unary_lanes(t, a, count, [](float x) { return std::sqrt(x); });
+                    break;
+                case ExpressionOpcode::exp:
+                    unary_lanes(t, a, count, [](float x) { return std::exp(x); });
+                    break;
+                case ExpressionOpcode::log:
+                    unary_lanes(t, a, count, [](float x) { return std::log(x); });
+                    break;
+                case ExpressionOpcode::log2:
+                    unary_lanes(t, a, count, [](float x) { return std::log2(x); });
+                    break;
+                case ExpressionOpcode::log10:
+                    unary_lanes(t, a, count, [](float x) { return std::log10(x); });
+                    break;
+                case ExpressionOpcode::floor:
+                    unary_lanes(t, a, count, [](float x) { return std::floor(x); });
+                    break;
+                case ExpressionOpcode::ceil:
+                    unary_lanes(t, a, count, [](float x) { return std::ceil(x); });
+                    break;
+                case ExpressionOpcode::round:
+                    unary_lanes(t, a, count, [](float x) { return std::round(x); });
+                    break;
+                case ExpressionOpcode::fract:
+                    unary_lanes(t, a, count, [](float x) { return x - std::floor(x); });
+                    break;
+                case ExpressionOpcode::sin:
+                    unary_lanes(t, a, count, [](float x) { return std::sin(x); });
+                    break;
+                case ExpressionOpcode::cos:
+                    unary_lanes(t, a, count, [](float x) { return std::cos(x); });
+                    break;
+                case ExpressionOpcode::tan:
+                    unary_lanes(t, a, count, [](float x) { return std::tan(x); });
+                    break;
+                case ExpressionOpcode::asin:
+                    unary_lanes(t, a, count, [](float x) { return std::asin(x); });
+                    break;
+                case ExpressionOpcode::acos:
+                    unary_lanes(t, a, count, [](float x) { return std::acos(x); });
+                    break;
+                case ExpressionOpcode::atan:
+                    unary_lanes(t, a, count, [](float x) { return std::atan(x); });
+                    break;
+            }
+        }
+    }
+
+    /** Recursive descent parser that emits bytecode as it goes. Operations on constants are folded instead of emitted. **/
+    class ExpressionCompiler
+    {
+    public:
+        ExpressionCompiler(const std::string& source, ExpressionProgram& program) :
+            source_(source), position_(0), program_(program), next_register_(0)
+        {
+        }
+
+        void compile()
+        {
+            skip_whitespace();
+            if(position_ == source_.size())
+                fail("Expression is empty");
+
+            Operand result = parse_expression();
+
+            skip_whitespace();
+            if(position_ != source_.size())
+                fail("Unexpected '" + std::string(1, source_[position_]) + "'");
+
+            program_.result_register_ = materialize(result);
+            program_.num_registers_ = next_register_;
+        }
+
+    private:
+        struct Operand
+        {
+            bool is_constant;
+            float value;
+            unsigned char reg;
+        };
+
+        static Operand constant(float value)
+        {
+            Operand operand;
+            operand.is_constant = true;
+            operand.value = value;
+            operand.reg = 0;
+            return operand;
+        }
+
+        static Operand in_register(unsigned char reg)
+        {
+            Operand operand;
+            operand.is_constant = false;
+            operand.value = 0.0f;
+            operand.reg = reg;
+            return operand;
+        }
+
+        // expression := term (('+' | '-') term)*
+        Operand parse_expression()
+        {
+            Operand left = parse_term();
+
+            while(true)
+            {
+                if(accept('+'))
+                    left = emit(ExpressionOpcode::add, { left, parse_term() });
+                else if(accept('-'))
+                    left = emit(ExpressionOpcode::subtract, { left, parse_term() });
+                else
+                    return left;
+            }
+        }
+
+        // term := unary (('*' | '/' | '%') unary)*
+        Operand parse_term()
+        {
+            Operand left = parse_unary();
+
+            while(true)
+            {
+                if(accept('*'))
+                    left = emit(ExpressionOpcode::multiply, { left, parse_unary() });
+                else if(accept('/'))
+                    left = emit(ExpressionOpcode::divide, { left, parse_unary() });
+                else if(accept('%'))
+                    left = emit(ExpressionOpcode::mod, { left, parse_unary() });
+                else
+                    return left;
+            }
+        }
+
+        // unary := '-' unary | '+' unary | power
+        Operand parse_unary()
+        {
+            if(accept('-'))
+                return emit(ExpressionOpcode::negate, { parse_unary() });
+            if(accept('+'))
+                return parse_unary();
+            return parse_power();
+        }
+
+        // power := primary ('^' unary)?   (right associative, binds tighter than unary minus on its left)
+        Operand parse_power()
+        {
+            Operand base = parse_primary();
+            if(accept('^'))
+                return emit(ExpressionOpcode::power, { base, parse_unary() });
+            return base;
+        }
+
+        // primary := number | name ('.' component)? | function '(' arguments ')' | '(' expression ')'
+        Operand parse_primary()
+        {
+            skip_whitespace();
+            if(position_ == source_.size())
+                fail("Unexpected end of expression");
+
+            char next = source_[position_];
+
+            if(accept('('))
+            {
+                Operand inner = parse_expression();
+                expect(')');
+                return inner;
+            }
+
+            if(std::isdigit(static_cast<unsigned char>(next)) || next == '.')
+                return parse_number();
+
+            if(std::isalpha(static_cast<unsigned char>(next)) || next == '_')
+            {
+                std::string name = parse_name();
+
+                if(accept('('))
+                    return parse_call(name);
+
+                return load_variable(name);
+            }
+
+            fail("Unexpected '" + std::string(1, next) + "'");
+            return constant(0.0f);
+        }
+
+        Operand parse_number()
+        {
+            const char* start = source_.c_str() + position_;
+            char* end = nullptr;
+            float value = std::strtof(start, &end);
+
+            if(end == start)
+                fail("Malformed number");
+
+            position_ += end - start;
+            return constant(value);
+        }
+
+        std::string parse_name()
+        {
+            std::size_t start = position_;
+            while(position_ < source_.size() &&
+                  (std::isalnum(static_cast<unsigned char>(source_[position_])) || source_[position_] == '_'))
+            {
+                position_++;
+            }
+
+            return source_.substr(start, position_ - start);
+        }
+
+        Operand parse_call(const std::string& name)
+        {
+            const ExpressionFunction* function = nullptr;
+            for(const ExpressionFunction& candidate : functions)
+            {
+                if(name == candidate.name)
+                    function = &candidate;
+            }
+
+            if(function == nullptr)
+                fail("Unknown function " + name);
+
+            std::vector<Operand> arguments;
+            if(!accept(')'))
+            {
+                do
+                {
+                    arguments.push_back(parse_expression());
+                }
+                while(accept(','));
+
+                expect(')');
+            }
+
+            if(arguments.size() != function->arity)
+                fail(name + " takes " + std::to_string(function->arity) + " argument(s)");
+
+            return emit(function->opcode, arguments);
+        }
+
+        Operand load_variable(const std::string& name)
+        {
+            unsigned int component = 0;
+
+            // Swizzle a single component out of a vector input
+            if(position_ < source_.size() && source_[position_] == '.')
+            {
+                position_++;
+                std::string component_name = parse_name();
+                const char* components = "xyzw";
+                const char* found = component_name.size() == 1 ? std::strchr(components, component_name[0]) : nullptr;
+
+                if(found == nullptr || *found == '\0')
+                    fail("Unknown component ." + component_name + " of " + name + " (use x, y, z or w)");
+
+                component = static_cast<unsigned int>(found - components);
+            }
+
+            std::vector<ExpressionVariable>& variables = program_.variables_;
+            auto it = std::find_if(variables.begin(), variables.end(), [&name](const ExpressionVariable& variable) { return variable.name == name; });
+
+            if(it == variables.end())
+            {
+                ExpressionVariable variable;
+                variable.name = name;
+                variable.max_component = 0;
+                variables.push_back(variable);
+                it = variables.end() - 1;
+            }
+
+            it->max_component = std::max(it->max_component, component);
+
+            ExpressionInstruction instruction = make_instruction(ExpressionOpcode::load_input);
+            instruction.target = allocate();
+            instruction.input = static_cast<unsigned int>(it - variables.begin());
+            instruction.component = component;
+            program_.instructions_.push_back(instruction);
+
+            return in_register(instruction.target);
+        }
+
+        Operand emit(ExpressionOpcode opcode, const std::vector<Operand>& arguments)
+        {
+            bool all_constant = std::all_of(arguments.begin(), arguments.end(), [](const Operand& operand) { return operand.is_constant; });
+
+            ExpressionInstruction instruction = make_instruction(opcode);
+
+            if(all_constant)
+            {
+                // Run the instruction on one lane of scratch registers instead of duplicating every operation
+                float registers[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for(std::size_t i = 0; i < arguments.size(); i++)
+                    registers[i + 1] = arguments[i].value;
+
+                instruction.a = 1;
+                instruction.b = 2;
+                instruction.c = 3;
+                execute_instruction(instruction, registers, 1, 1, nullptr, 0);
+                return constant(registers[0]);
+            }
+
+            std::vector<unsigned char> sources;
+            for(const Operand& argument : arguments)
+                sources.push_back(materialize(argument));
+
+            // Lanes are independent, so the target can reuse one of the source registers
+            for(std::size_t i = 0; i < arguments.size(); i++)
+                release(sources[i]);
+
+            instruction.target = allocate();
+            instruction.a = sources.size() > 0 ? sources[0] : 0;
+            instruction.b = sources.size() > 1 ? sources[1] : 0;
+            instruction.c = sources.size() > 2 ? sources[2] : 0;
+            program_.instructions_.push_back(instruction);
+
+            return in_register(instruction.target);
+        }
+
+        unsigned char materialize(const Operand& operand)
+        {
+            if(!operand.is_constant)
+                return operand.reg;
+
+            ExpressionInstruction instruction = make_instruction(ExpressionOpcode::load_constant);
+            instruction.target = allocate();
+            instruction.constant = operand.value;
+            program_.instructions_.push_back(instruction);
+            return instruction.target;
+        }
+
+        unsigned char allocate()
+        {
+            if(!free_registers_.empty())
+            {
+                unsigned char reg = free_registers_.back();
+                free_registers_.pop_back();
+                return reg;
+            }
+
+            if(next_register_ == max_registers)
+                fail("Expression is too complex");
+
+            return static_cast<unsigned char>(next_register_++);
+        }
+
+        void release(unsigned char reg)
+        {
+            if(std::find(free_registers_.begin(), free_registers_.end(), reg) == free_registers_.end())
+                free_registers_.push_back(reg);
+        }
+
+        void skip_whitespace()
+        {
+            while(position_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[position_])))
+                position_++;
+        }
+
+        bool accept(char c)
+        {
+            skip_whitespace();
+            if(position_ < source_.size() && source_[position_] == c)
+            {
+                position_++;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if(!accept(c))
+                fail("Expected '" + std::string(1, c) + "'");
+        }
+
+        void fail(const std::string& message) const
+        {
+            throw std::invalid_argument(message + " at position " + std::to_string(position_) + " in \"" + source_ + "\"");
+        }
+
+        const std::string& source_;
+        std::size_t position_;
+        ExpressionProgram& program_;
+
+        std::size_t next_register_;
+        std::vector<unsigned char> free_registers_;
+    };
+
+    const std::size_t ExpressionProgram::chunk_size;
+
+    ExpressionProgram::ExpressionProgram() :
+        num_registers_(0),
+        result_register_(0)
+    {
+    }
+
+    ExpressionProgram ExpressionProgram::compile(const std::string& source)
+    {
+        ExpressionProgram program;
+        ExpressionCompiler compiler(source, program);
+        compiler.compile();
+        return program;
+    }
+
+    void ExpressionProgram::evaluate(const std::vector<ExpressionInput>& inputs, float* out, std::size_t count) const
+    {
+        if(instructions_.empty())
+            return;
+
+        std::vector<float> registers(num_registers_ * chunk_size);
+
+        for(std::size_t first = 0; first < count; first += chunk_size)
+        {
+            std::size_t lanes = std::min(chunk_size, count - first);
+
+            for(const ExpressionInstruction& instruction : instructions_)
+            {
+                execute_instruction(instruction, registers.data(), chunk_size, lanes, &inputs, first);
+            }
+
+            const float* result = registers.data() + result_register_ * chunk_size;
+            std::copy(result, result + lanes, out + first);
+        }
+    }
+
+    const std::vector<ExpressionVariable>& ExpressionProgram::variables() const
+    {
+        return variables_;
+    }
+
+    const std::vector<ExpressionInstruction>& ExpressionProgram::instructions() const
+    {
+        return instructions_;
+    }
+
+    std::size_t ExpressionProgram::num_registers() const
+    {
+        return num_registers_;
+    }
+} }
@@ -0,0 +1,115 @@
+#ifndef EXPRESSION_PROGRAM_H
+#define EXPRESSION_PROGRAM_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace noises {
+namespace nodes
+{
+    enum class ExpressionOpcode : unsigned char
+    {
+        load_input,
+        load_constant,
+
+        // binary
+        add,
+        subtract,
+        multiply,
+        divide,
+        mod,
+        power,
+        min,
+        max,
+        atan2,
+
+        // ternary
+        clamp,
+        lerp,
+
+        // unary
+        negate,
+        abs,
+        sqrt,
+        exp,
+        log,
+        log2,
+        log10,
+        floor,
+        ceil,
+        round,
+        fract,
+        sin,
+        cos,
+        tan,
+        asin,
+        acos,
+        atan
+    };
+
+    /** One register-to-register instruction. Registers hold a whole chunk of elements. **/
+    struct ExpressionInstruction
+    {
+        ExpressionOpcode opcode;
+        unsigned char target;
+        unsigned char a;
+        unsigned char b;
+        unsigned char c;
+
+        // load_input only
+        unsigned int input;
+        unsigned int component;
+
+        // load_constant only
+        float constant;
+    };
+
+    /** A variable referenced by the expression, e.g. "b.x" is the variable "b" with component 0. **/
+    struct ExpressionVariable
+    {
+        std::string name;
+
+        // The highest component used by the expression (0 for bare names), so the input can be validated against it
+        unsigned int max_component;
+    };
+
+    /** Where the values of one variable live. Attributes advance by element_stride per element, uniforms have an element_stride of 0. **/
+    struct ExpressionInput
+    {
+        const float* data;
+        std::size_t element_stride;
+    };
+
+    /** A formula over named float inputs (e.g. "a*0.5 + sin(b.x)*c") compiled into register bytecode and evaluated a chunk at a time,
+     *  so the intermediate values stay in a small set of cache-resident registers instead of full-size buffers. **/
+    class ExpressionProgram
+    {
+    public:
+        /** Number of elements each register holds. **/
+        static const std::size_t chunk_size = 256;
+
+        ExpressionProgram();
+
+        /** Compiles {source}. Throws std::invalid_argument describing the first error if the expression is malformed. **/
+        static ExpressionProgram compile(const std::string& source);
+
+        /** Evaluates {count} elements. {inputs} are in the same order as variables(), each pointing at the first element to evaluate. **/
+        void evaluate(const std::vector<ExpressionInput>& inputs, float* out, std::size_t count) const;
+
+        const std::vector<ExpressionVariable>& variables() const;
+        const std::vector<ExpressionInstruction>& instructions() const;
+
+        std::size_t num_registers() const;
+
+    private:
+        friend class ExpressionCompiler;
+
+        std::vector<ExpressionVariable> variables_;
+        std::vector<ExpressionInstruction> instructions_;
+        std::size_t num_registers_;
+        unsigned char result_register_;
+    };
+} }
+
+#endif // EXPRESSION_PROGRAM_H
@@ -0,0 +1,175 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "composite_data_buffer.h"
+#include "validation_results.h"
+#include "parallel.h"
+#include "nodes/reduce.h"
+
+namespace noises {
+namespace nodes
+{
+    Histogram::Histogram()
+    {
+        input_socket_ = &inputs().add("Input", SocketType::attribute);
+        min_socket_ = &inputs().add("Min", SocketType::uniform);
+        max_socket_ = &inputs().add("Max", SocketType::uniform);
+
+        for(InputSocket* socket : { input_socket_, min_socket_, max_socket_ })
+        {
+            socket->set_accepts(ConnectionDataType::value<int, 1>());
+            socket->set_accepts(ConnectionDataType::value<float, 1>());
+            socket->set_accepts(ConnectionDataType::value<double, 1>());
+        }
+
+        min_socket_->set_optional(true);
+        max_socket_->set_optional(true);
+
+        histogram_socket_ = &outputs().add("Histogram", ConnectionDataType::value<unsigned int, 1>(), SocketType::attribute);
+
+        bins_property_ = &add_property<unsigned int, 1>("Bins");
+        unsigned int default_bins = 256;
+        bins_property_->set_default_value<unsigned int, 1>(&default_bins);
+    }
+
+    std::string Histogram::node_name() const
+    {
+        return "Histogram";
+    }
+
+    bool Histogram::is_pure() const
+    {
+        return true;
+    }
+
+    void Histogram::set_bins(unsigned int bins)
+    {
+        bins_property_->set_value<unsigned int, 1>(&bins);
+    }
+
+    template<typename T>
+    void Histogram::count(const CompositeDataBuffer& input, DataBuffer& output) const
+    {
+        const ConnectionDataType& data_type = ConnectionDataType::value<T, 1>();
+
+        auto attribute = input.get_attribute_all_raw(*input_socket_, data_type);
+        const T* data = reinterpret_cast<const T*>(std::get<0>(attribute));
+        std::size_t length = std::get<1>(attribute) / data_type.size_full();
+
+        unsigned int bins = std::max(bins_property_->value_or_default<unsigned int, 1>().value(), 1u);
+
+        // Without Min or Max the histogram covers the values in the attribute
+        double min = 0.0;
+        double max = 0.0;
+
+        if(!min_socket_->connection() || !max_socket_->connection())
+        {
+            std::pair<double, double> identity(0.0, 0.0);
+
+            std::pair<double, double> range = parallel_reduce(length, Reduce::chunk_size, identity,
+                [data](std::size_t begin, std::size_t end)
+                {
+                    std::pair<double, double> partial(data[begin], data[begin]);
+                    for(std::size_t i = begin; i < end; i++)
+                    {
+                        partial.first = std::min<double>(partial.first, data[i]);
+                        partial.second = std::max<double>(partial.second, data[i]);
+                    }
+                    return partial;
+                },
+                [](const std::pair<double, double>& left, const std::pair<double, double>& right)
+                {
+                    return std::make_pair(std::min(left.first, right.first), std::max(left.second, right.second));
+                });
+
+            min = range.first;
+            max = range.second;
+        }
+
+        if(min_socket_->connection())
+            min = input.get_uniform<T, 1>(*min_socket_)[0];
+
+        if(max_socket_->connection())
+            max = input.get_uniform<T, 1>(*max_socket_)[0];
+
+        double scale = max > min ? bins / (max - min) : 0.0;
+
+        // Each partial histogram covers at least as many values as there are bins so they don't take more memory than the input
+        std::vector<unsigned int> identity(bins, 0);
+
+        std::vector<unsigned int> histogram = parallel_reduce(length, std::max<std::size_t>(Reduce::chunk_size, bins), identity,
+            [data, bins, min, max, scale](std::size_t begin, std::size_t end)
+            {
+                std::vector<unsigned int> partial(bins, 0);
+                for(std::size_t i = begin; i < end; i++)
+                {
+                    double value = data[i];
+                    if(!(value >= min && value <= max))
+                        continue; // Out of range (or NaN)
+
+                    // The maximum goes in the last bin rather than one past it
+                    unsigned int bin = std::min(static_cast<unsigned int>((value - min) * scale), bins - 1);
+                    partial[bin]++;
+                }
+                return partial;
+            },
+            [bins](const std::vector<unsigned int>& left, const std::vector<unsigned int>& right)
+            {
+                std::vector<unsigned int> combined = left;
+                for(unsigned int bin = 0; bin < bins; bin++)
+                {
+                    combined[bin] += right[bin];
+                }
+                return combined;
+            });
+
+        output.resize_attribute(AttributeInfo(bins, boost::str(boost::format("[1d][histogram][%1%]") % bins)));
+        output.set_attribute_all_raw(*histogram_socket_, histogram_socket_->data_type(), reinterpret_cast<const unsigned char*>(histogram.data()),
+                                      bins * sizeof(unsigned int));
+    }
+
+    void Histogram::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
+    {
+        const ConnectionDataType& data_type = input_socket_->connection()->get().data_type();
+
+        if(data_type.is<int>())
+        {
+            count<int>(input, output);
+        }
+        else if(data_type.is<float>())
+        {
+            count<float>(input, output);
+        }
+        else if(data_type.is<double>())
+        {
+            count<double>(input, output);
+        }
+    }
+
+    void Histogram::execute_attribute_range(const CompositeDataBuffer&, DataBuffer&, DataBuffer::size_type, DataBuffer::size_type) const
+    {
+        // Everything is done in execute_uniforms
+    }
+
+    void Histogram::validate(ValidationResults &results) const
+    {
+        auto input_connection = input_socket_->connection();
+        if(!input_connection)
+            return; // Validation will be handled by the global validator
+
+        const ConnectionDataType& data_type = input_connection->get().data_type();
+
+        for(const InputSocket* socket : { min_socket_, max_socket_ })
+        {
+            auto connection = socket->connection();
+            if(connection && connection->get().data_type() != data_type)
+            {
+                results.add("Histogram " + socket->name() + " must be the same type as Input.");
+            }
+        }
+    }
+} }
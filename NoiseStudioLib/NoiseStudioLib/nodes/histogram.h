@@ -0,0 +1,40 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "graph_node.h"
+
+namespace noises {
+namespace nodes
+{
+    // Counts how many values of a scalar attribute fall in each of Bins equal-width bins between Min and Max. The output is an
+    // unsigned int attribute with one value per bin.
+    class Histogram : public GraphNode
+    {
+    public:
+        Histogram();
+
+        std::string node_name() const;
+
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+
+        void validate(ValidationResults& results) const;
+
+        bool is_pure() const;
+
+        void set_bins(unsigned int bins);
+
+    private:
+        template<typename T>
+        void count(const CompositeDataBuffer& input, DataBuffer& output) const;
+
+        InputSocket* input_socket_;
+        InputSocket* min_socket_;
+        InputSocket* max_socket_;
+        OutputSocket* histogram_socket_;
+
+        Property* bins_property_;
+    };
+} }
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,50 @@
+#ifndef GRID_ROWS_H
+#define GRID_ROWS_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "attribute_info.h"
+
+namespace noises {
+namespace nodes {
+namespace mappings {
+
+    /** Splits the elements [begin, end) of an attribute holding (part of) {grid} into runs along the first axis and calls
+     *  row(offset, count, position) for each, where offset is the run's first element in the attribute and position is that element's
+     *  coordinates in the grid. Only the first position needs dividing out, after that it is counted up from row to row. **/
+    template<typename RowFunction>
+    void for_each_grid_row(const GridInfo& grid, std::size_t begin, std::size_t end, RowFunction row)
+    {
+        if(begin >= end)
+            return;
+
+        std::array<std::size_t, GridInfo::max_rank> position {};
+        std::size_t index = grid.origin() + begin;
+        for(std::size_t axis = 0; axis < grid.rank(); axis++)
+        {
+            position[axis] = index % grid.extent(axis);
+            index /= grid.extent(axis);
+        }
+
+        while(begin < end)
+        {
+            std::size_t count = std::min(grid.extent(0) - position[0], end - begin);
+            row(begin, count, position);
+            begin += count;
+
+            position[0] = 0;
+            for(std::size_t axis = 1; axis < grid.rank(); axis++)
+            {
+                if(++position[axis] < grid.extent(axis))
+                    break;
+
+                position[axis] = 0;
+            }
+        }
+    }
+
+}}}
+
+#endif // GRID_ROWS_H
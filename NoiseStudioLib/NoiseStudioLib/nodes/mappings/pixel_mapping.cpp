@@ -1,8 +1,6 @@
 #include "pixel_mapping.h"
 
-#include <array>
-#include <boost/lexical_cast.hpp>
-#include <boost/regex.hpp>
+#include "grid_rows.h"
 
 namespace noises {
 namespace nodes {
@@ -21,31 +19,42 @@ namespace mappings {
 
     void PixelMapping::execute_uniforms(const CompositeDataBuffer&, DataBuffer &output) const
     {
-        //TODO put this in utils
-        //extracts the width and height out of the tag and puts them in the scratch buffer for execute_atttributes to use
-
-        static const boost::regex finder("\\[([0-9]+),([0-9]+)\\]");
+        AttributeInfo info = output.attribute_info();
+        if(info.grid().rank() != 2 || info.grid().origin() + info.length() > info.grid().size())
+            throw std::logic_error("PixelMapping requires a 2D grid, e.g. from BlankGrid");
+    }
 
-        std::string tag = output.attribute_info().tag();
-        std::string::const_iterator start = tag.begin(), end = tag.end();
-        boost::match_results<std::string::const_iterator> what;
+    void PixelMapping::execute_attribute_range(const CompositeDataBuffer&, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        const GridInfo grid = output.attribute_info().grid();
+        const int stride = static_cast<int>(grid.stride());
+        int* mapped = reinterpret_cast<int*>(output.get_attribute_all_raw(*output_, ConnectionDataType::value<int, 2>()));
 
-        if(!boost::regex_search(start, end, what, finder, boost::match_default))
-            throw std::logic_error("PixelMapping requires a tag to identify the data, or tag is missing [width,height]");
+        // Positions are in the full grid's pixels when only every stride-th pixel is calculated
+        for_each_grid_row(grid, begin, end,
+                          [mapped, stride](std::size_t offset, std::size_t count, const std::array<std::size_t, GridInfo::max_rank>& position)
+        {
+            int* out = mapped + offset * 2;
+            const int column = static_cast<int>(position[0]);
+            const int row = static_cast<int>(position[1]) * stride;
 
-        int width = boost::lexical_cast<int>(static_cast<std::string>(what[1]));
-        int height = boost::lexical_cast<int>(static_cast<std::string>(what[2]));
+            for(int i = 0; i < static_cast<int>(count); i++)
+            {
+                out[i * 2] = (column + i) * stride;
+                out[i * 2 + 1] = row;
+            }
+        });
+    }
 
-        std::array<int, 2> dimensions { width, height };
-        output.set_scratch<std::array<int, 2>>(0, dimensions);
+    void PixelMapping::execute_attributes(const CompositeDataBuffer& input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
     }
 
-    void PixelMapping::execute_attributes(const CompositeDataBuffer&, DataBuffer &output, DataBuffer::size_type index) const
+    bool PixelMapping::is_elementwise() const
     {
-        std::array<int, 2> dimensions = output.get_scratch<std::array<int, 2>>(0);
-        std::div_t row_column = std::div(index, dimensions[0]);
-        std::array<int, 2> row_column_array { row_column.rem, row_column.quot };
-        output.set_attribute<int, 2>(*output_, index, row_column_array);
+        // Works out positions from the output's GridInfo, which has the origin of each chunk
+        return true;
     }
 
     std::string PixelMapping::node_name() const
@@ -0,0 +1,70 @@
+#include "unit_cube_mapping.h"
+
+#include "grid_rows.h"
+
+namespace noises {
+namespace nodes {
+namespace mappings {
+
+    UnitCubeMapping::UnitCubeMapping()
+    {
+        inputs().add("Grid", SocketType::attribute);
+
+        outputs().add("Mapped", ConnectionDataType::value<float, 3>(), SocketType::attribute);
+
+        input("Grid").set_accepts(ConnectionDataType::any());
+
+        output_ = &output("Mapped");
+    }
+
+    std::string UnitCubeMapping::node_name() const
+    {
+        return "Unit Cube Mapping";
+    }
+
+    void UnitCubeMapping::execute_uniforms(const CompositeDataBuffer&, DataBuffer &output) const
+    {
+        AttributeInfo info = output.attribute_info();
+        if(info.grid().rank() != 3 || info.grid().origin() + info.length() > info.grid().size())
+            throw std::logic_error("UnitCubeMapping requires a 3D grid, e.g. from BlankGrid with a depth");
+    }
+
+    void UnitCubeMapping::execute_attribute_range(const CompositeDataBuffer&, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        const GridInfo grid = output.attribute_info().grid();
+        // A strided grid goes over the same cube as the full grid, like UnitSquareMapping
+        const int stride = static_cast<int>(grid.stride());
+        const float width = static_cast<float>(grid.full_extent(0));
+        const float height = static_cast<float>(grid.full_extent(1));
+        const float depth = static_cast<float>(grid.full_extent(2));
+        float* mapped = reinterpret_cast<float*>(output.get_attribute_all_raw(*output_, ConnectionDataType::value<float, 3>()));
+
+        for_each_grid_row(grid, begin, end,
+                          [mapped, stride, width, height, depth](std::size_t offset, std::size_t count, const std::array<std::size_t, GridInfo::max_rank>& position)
+        {
+            float* out = mapped + offset * 3;
+            const int column = static_cast<int>(position[0]);
+            const float y = (static_cast<float>(position[1] * stride) / height) * 2 - 1; //-1 to 1
+            const float z = (static_cast<float>(position[2] * stride) / depth) * 2 - 1;
+
+            for(int i = 0; i < static_cast<int>(count); i++)
+            {
+                out[i * 3] = (static_cast<float>((column + i) * stride) / width) * 2 - 1;
+                out[i * 3 + 1] = y;
+                out[i * 3 + 2] = z;
+            }
+        });
+    }
+
+    void UnitCubeMapping::execute_attributes(const CompositeDataBuffer& input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
+
+    bool UnitCubeMapping::is_elementwise() const
+    {
+        // Works out positions from the output's GridInfo, which has the origin of each chunk
+        return true;
+    }
+
+}}}
@@ -0,0 +1,32 @@
+#ifndef UNIT_CUBE_MAPPING_H
+#define UNIT_CUBE_MAPPING_H
+
+#include "graph_node.h"
+
+namespace noises {
+    class OutputSocket;
+
+namespace nodes {
+namespace mappings {
+
+    // Maps a 3D grid to the unit cube, (-1, -1, -1) to (1, 1, 1), the same way UnitSquareMapping maps a 2D one
+    class UnitCubeMapping : public GraphNode
+    {
+    public:
+        UnitCubeMapping();
+
+        std::string node_name() const;
+
+        void execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const;
+        void execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+        void execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const;
+
+        bool is_elementwise() const;
+
+    private:
+        OutputSocket* output_;
+    };
+
+}}}
+
+#endif // UNIT_CUBE_MAPPING_H
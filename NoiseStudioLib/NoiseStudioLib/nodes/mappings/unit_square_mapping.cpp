@@ -1,8 +1,6 @@
 #include "unit_square_mapping.h"
 
-#include <array>
-#include <boost/lexical_cast.hpp>
-#include <boost/regex.hpp>
+#include "grid_rows.h"
 
 namespace noises {
 namespace nodes {
@@ -26,41 +24,44 @@ namespace mappings {
 
     void UnitSquareMapping::execute_uniforms(const CompositeDataBuffer&, DataBuffer &output) const
     {
-        //TODO put this in utils
-        //extracts the width and height out of the tag and puts them in the scratch buffer for execute_atttributes to use
-
-        static const boost::regex finder("\\[([0-9]+),([0-9]+)\\]");
-
-        std::string tag = output.attribute_info().tag();
-        std::string::const_iterator start = tag.begin(), end = tag.end();
-        boost::match_results<std::string::const_iterator> what;
-
-        if(!boost::regex_search(start, end, what, finder, boost::match_default))
-            throw std::logic_error("PixelMapping requires a tag to identify the data, or tag is missing [width,height]");
-
-        int width = boost::lexical_cast<int>(static_cast<std::string>(what[1]));
-        int height = boost::lexical_cast<int>(static_cast<std::string>(what[2]));
-
-        std::array<int, 2> dimensions { width, height };
-        output.set_scratch<std::array<int, 2>>(0, dimensions);
+        AttributeInfo info = output.attribute_info();
+        if(info.grid().rank() != 2 || info.grid().origin() + info.length() > info.grid().size())
+            throw std::logic_error("UnitSquareMapping requires a 2D grid, e.g. from BlankGrid");
     }
 
-    void UnitSquareMapping::execute_attributes(const CompositeDataBuffer&, DataBuffer &output, DataBuffer::size_type index) const
+    void UnitSquareMapping::execute_attribute_range(const CompositeDataBuffer&, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
     {
-        std::array<int, 2> dimensions = output.get_scratch<std::array<int, 2>>(0);
-        std::div_t row_column = std::div(index, dimensions[0]);
-
-        float x = static_cast<float>(row_column.rem) / static_cast<float>(dimensions[0]);
-        x = (x * 2) - 1; //-1 to 1
-
-        float y = static_cast<float>(row_column.quot) / static_cast<float>(dimensions[1]);
-        y = (y * 2) - 1;
+        const GridInfo grid = output.attribute_info().grid();
+        // A strided grid goes over the same square as the full grid, so previews and levels of detail line up with it
+        const int stride = static_cast<int>(grid.stride());
+        const float width = static_cast<float>(grid.full_extent(0));
+        const float height = static_cast<float>(grid.full_extent(1));
+        float* mapped = reinterpret_cast<float*>(output.get_attribute_all_raw(*output_, ConnectionDataType::value<float, 2>()));
+
+        for_each_grid_row(grid, begin, end,
+                          [mapped, stride, width, height](std::size_t offset, std::size_t count, const std::array<std::size_t, GridInfo::max_rank>& position)
+        {
+            float* out = mapped + offset * 2;
+            const int column = static_cast<int>(position[0]);
+            const float y = (static_cast<float>(position[1] * stride) / height) * 2 - 1; //-1 to 1
+
+            for(int i = 0; i < static_cast<int>(count); i++)
+            {
+                out[i * 2] = (static_cast<float>((column + i) * stride) / width) * 2 - 1;
+                out[i * 2 + 1] = y;
+            }
+        });
+    }
 
-        std::array<float, 2> x_y_array { x, y };
+    void UnitSquareMapping::execute_attributes(const CompositeDataBuffer& input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
 
-        output.set_attribute<float, 2>(*output_, index, x_y_array);
+    bool UnitSquareMapping::is_elementwise() const
+    {
+        // Works out positions from the output's GridInfo, which has the origin of each chunk
+        return true;
     }
 
 }}}
-
-
@@ -18,8 +18,11 @@ namespace mappings {
         std::string node_name() const;
 
         void execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const;
+        void execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
         void execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const;
 
+        bool is_elementwise() const;
+
     private:
         OutputSocket* output_;
     };
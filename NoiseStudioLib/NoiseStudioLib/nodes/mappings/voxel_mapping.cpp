@@ -0,0 +1,67 @@
+#include "voxel_mapping.h"
+
+#include "grid_rows.h"
+
+namespace noises {
+namespace nodes {
+namespace mappings {
+
+    VoxelMapping::VoxelMapping()
+    {
+        inputs().add("Grid", SocketType::attribute);
+
+        outputs().add("Mapped", ConnectionDataType::value<int, 3>(), SocketType::attribute);
+
+        input("Grid").set_accepts(ConnectionDataType::any());
+
+        output_ = &output("Mapped");
+    }
+
+    void VoxelMapping::execute_uniforms(const CompositeDataBuffer&, DataBuffer &output) const
+    {
+        AttributeInfo info = output.attribute_info();
+        if(info.grid().rank() != 3 || info.grid().origin() + info.length() > info.grid().size())
+            throw std::logic_error("VoxelMapping requires a 3D grid, e.g. from BlankGrid with a depth");
+    }
+
+    void VoxelMapping::execute_attribute_range(const CompositeDataBuffer&, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        const GridInfo grid = output.attribute_info().grid();
+        const int stride = static_cast<int>(grid.stride());
+        int* mapped = reinterpret_cast<int*>(output.get_attribute_all_raw(*output_, ConnectionDataType::value<int, 3>()));
+
+        // Positions are in the full grid's voxels when only every stride-th voxel is calculated
+        for_each_grid_row(grid, begin, end,
+                          [mapped, stride](std::size_t offset, std::size_t count, const std::array<std::size_t, GridInfo::max_rank>& position)
+        {
+            int* out = mapped + offset * 3;
+            const int column = static_cast<int>(position[0]);
+            const int row = static_cast<int>(position[1]) * stride;
+            const int slice = static_cast<int>(position[2]) * stride;
+
+            for(int i = 0; i < static_cast<int>(count); i++)
+            {
+                out[i * 3] = (column + i) * stride;
+                out[i * 3 + 1] = row;
+                out[i * 3 + 2] = slice;
+            }
+        });
+    }
+
+    void VoxelMapping::execute_attributes(const CompositeDataBuffer& input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
+
+    bool VoxelMapping::is_elementwise() const
+    {
+        // Works out positions from the output's GridInfo, which has the origin of each chunk
+        return true;
+    }
+
+    std::string VoxelMapping::node_name() const
+    {
+        return "Voxel Mapping";
+    }
+
+}}}
@@ -0,0 +1,32 @@
+#ifndef VOXEL_MAPPING_H
+#define VOXEL_MAPPING_H
+
+#include "graph_node.h"
+
+namespace noises {
+    class OutputSocket;
+
+namespace nodes {
+namespace mappings {
+
+    //Maps a 3D grid 1:1, like PixelMapping, so the first voxel is 0, 0, 0 and the last is width-1,height-1,depth-1
+    class VoxelMapping : public GraphNode
+    {
+    public:
+        VoxelMapping();
+
+        std::string node_name() const;
+
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+        void execute_attributes(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type index) const;
+
+        bool is_elementwise() const;
+
+    private:
+        OutputSocket* output_;
+    };
+
+} } }
+
+#endif // VOXEL_MAPPING_H
@@ -1,6 +1,10 @@
 #include "math.h"
 
+#include <functional>
+#include <type_traits>
+
 #include "composite_data_buffer.h"
+#include "fast_math.h"
 #include "validation_results.h"
 #include "output_socket.h"
 
@@ -9,439 +13,348 @@ namespace
     using namespace noises;
     using namespace nodes;
 
+    /** Where an operand's values live. Attributes advance by element_stride per index, uniforms have an element_stride of 0.
+     *  Scalars have a component_stride of 0 so they broadcast across every component of a vector. **/
     template<typename T>
-    T scalar_binary_math_operation(MathOperation operation, T a, T b)
+    struct MathOperand
     {
-        switch(operation)
+        const T* data;
+        std::size_t element_stride;
+        std::size_t component_stride;
+
+        bool is_contiguous(std::size_t dimensions) const
         {
-            case MathOperation::add:
-                return a + b;
-            case MathOperation::subtract:
-                return a - b;
-            case MathOperation::multiply:
-                return a * b;
-            case MathOperation::divide:
-                if(b == static_cast<T>(0))
-                    return static_cast<T>(0);
-                return b;
-            case MathOperation::mod:
-                return static_cast<int>(a) % static_cast<int>(b);
-            case MathOperation::logorithm:
-                return std::log(a) / std::log(b);
-
-            default: return static_cast<T>(0);
+            return element_stride == dimensions && (component_stride == 1 || dimensions == 1);
         }
-    }
 
-    template<typename T>
-    T scalar_unary_math_operation(MathOperation operation, T a)
-    {
-        switch(operation)
+        bool is_broadcast_scalar() const
         {
-            case MathOperation::negate:
-                return -a;
-            case MathOperation::square_root:
-                return std::sqrt(a);
-            case MathOperation::cube_root:
-                return std::cbrt(a);
-            case MathOperation::log_e:
-                return std::log(a);
-            case MathOperation::log_10:
-                return std::log10(a);
-            case MathOperation::log_2:
-                return std::log2(a);
-            case MathOperation::ceiling:
-                return std::ceil(a);
-            case MathOperation::floor:
-                return std::floor(a);
-            case MathOperation::round:
-                return std::round(a);
-            case MathOperation::sin:
-                return std::sin(a);
-            case MathOperation::cos:
-                return std::cos(a);
-            case MathOperation::tan:
-                return std::tan(a);
-            case MathOperation::asin:
-                return std::asin(a);
-            case MathOperation::acos:
-                return std::acos(a);
-            case MathOperation::atan:
-                return std::atan(a);
-
-            default: return static_cast<T>(0);
+            return element_stride == 0 && component_stride == 0;
         }
-    }
+    };
 
     template<typename T>
-    std::vector<T> vector_binary_math_operation(MathOperation operation, const ConnectionDataType& data_type, const T* a, const T* b)
+    struct MathKernelArgs
     {
-        std::vector<T> out(data_type.dimensions());
-        bool go_out = false;
+        MathOperand<T> a;
+        MathOperand<T> b;
+        T* out;
+        std::size_t dimensions;
+        std::size_t begin;
+        std::size_t end;
+    };
 
-        bool should_break = false;
-        for(int i = 0; i < data_type.dimensions(); i++)
+    template<typename T>
+    using MathKernel = void (*)(const MathKernelArgs<T>&);
+
+#define MATH_BINARY_OPERATION(NAME, EXPRESSION) \
+    template<typename T> struct NAME { static inline T apply(T a, T b) { return static_cast<T>(EXPRESSION); } }
+
+#define MATH_UNARY_OPERATION(NAME, EXPRESSION) \
+    template<typename T> struct NAME { static inline T apply(T a) { return static_cast<T>(EXPRESSION); } }
+
+    MATH_BINARY_OPERATION(AddOperation, a + b);
+    MATH_BINARY_OPERATION(SubtractOperation, a - b);
+    //vectors can't be multiplied...but might as well allow the hammard product as well as other operations on individual components
+    MATH_BINARY_OPERATION(MultiplyOperation, a * b);
+    MATH_BINARY_OPERATION(DivideOperation, b == static_cast<T>(0) ? static_cast<T>(0) : a / b);
+    MATH_BINARY_OPERATION(ExponentOperation, std::pow(a, b));
+    MATH_BINARY_OPERATION(LogarithmOperation, std::log(a) / std::log(b));
+    MATH_BINARY_OPERATION(ModOperation, static_cast<int>(b) == 0 ? 0 : static_cast<int>(a) % static_cast<int>(b));
+    MATH_BINARY_OPERATION(Atan2Operation, std::atan2(a, b));
+
+    MATH_UNARY_OPERATION(NegateOperation, -a);
+    MATH_UNARY_OPERATION(SquareRootOperation, std::sqrt(a));
+    MATH_UNARY_OPERATION(CubeRootOperation, std::cbrt(a));
+    MATH_UNARY_OPERATION(LogEOperation, std::log(a));
+    MATH_UNARY_OPERATION(Log10Operation, std::log10(a));
+    MATH_UNARY_OPERATION(Log2Operation, std::log2(a));
+    MATH_UNARY_OPERATION(CeilingOperation, std::ceil(a));
+    MATH_UNARY_OPERATION(FloorOperation, std::floor(a));
+    MATH_UNARY_OPERATION(RoundOperation, std::round(a));
+    MATH_UNARY_OPERATION(SinOperation, std::sin(a));
+    MATH_UNARY_OPERATION(CosOperation, std::cos(a));
+    MATH_UNARY_OPERATION(TanOperation, std::tan(a));
+    MATH_UNARY_OPERATION(AsinOperation, std::asin(a));
+    MATH_UNARY_OPERATION(AcosOperation, std::acos(a));
+    MATH_UNARY_OPERATION(AtanOperation, std::atan(a));
+
+    MATH_BINARY_OPERATION(FastExponentOperation, fast_math::pow(a, b));
+    MATH_BINARY_OPERATION(FastLogarithmOperation, fast_math::log(a) / fast_math::log(b));
+    MATH_BINARY_OPERATION(FastAtan2Operation, fast_math::atan2(a, b));
+
+    MATH_UNARY_OPERATION(FastLogEOperation, fast_math::log(a));
+    MATH_UNARY_OPERATION(FastLog10Operation, fast_math::log10(a));
+    MATH_UNARY_OPERATION(FastLog2Operation, fast_math::log2(a));
+    MATH_UNARY_OPERATION(FastSinOperation, fast_math::sin(a));
+    MATH_UNARY_OPERATION(FastCosOperation, fast_math::cos(a));
+
+#undef MATH_BINARY_OPERATION
+#undef MATH_UNARY_OPERATION
+
+    // The common layouts (matching attributes, attribute with a uniform scalar) get flat loops over every component
+    // in the range so the compiler can vectorize them; anything else falls back to the strided loop.
+    template<typename T, typename Operation>
+    void binary_kernel(const MathKernelArgs<T>& args)
+    {
+        const std::size_t dimensions = args.dimensions;
+        const std::size_t first = args.begin * dimensions;
+        const std::size_t last = args.end * dimensions;
+        const T* a = args.a.data;
+        const T* b = args.b.data;
+        T* out = args.out;
+
+        if(args.a.is_contiguous(dimensions) && args.b.is_contiguous(dimensions))
         {
-            switch(operation)
-            {
-                case MathOperation::add:
-                    out[i] = a[i] + b[i];
-                    break;
-                case MathOperation::subtract:
-                    out[i] = a[i] - b[i];
-                    break;
-                case MathOperation::multiply:
-                    //vectors can't be multiplied...but might as well allow the hammard product as well as other operations on individual components
-                    out[i] = a[i] * b[i];
-                    break;
-                case MathOperation::divide:
-                    if(b[i] == 0)
-                        out[i] = 0;
-                    else
-                        out[i] = a[i] / b[i];
-                    break;
-                case MathOperation::exponent:
-                    out[i] = std::pow(a[i], b[i]);
-                    break;
-                case MathOperation::logorithm:
-                    out[i] = std::log(a[i]) / std::log(b[i]);
-                    break;
-                case MathOperation::mod:
-                    out[i] = static_cast<int>(a[i]) % static_cast<int>(b[i]);
-                    break;
-                case MathOperation::atan2:
-                    //how does this even make sense!?
-                    out[i] = std::atan2(a[i], b[i]);
-                    break;
-
-                default: should_break = true; break;
-            }
-
-            if(should_break)
-                break;
-
-            go_out = true;
+            for(std::size_t i = first; i < last; i++)
+                out[i] = Operation::apply(a[i], b[i]);
         }
-
-        if(go_out)
-            return out;
-
-        if(operation == MathOperation::cross)
+        else if(args.a.is_contiguous(dimensions) && args.b.is_broadcast_scalar())
         {
-            //TODO! only works for 3-dimensional vectors
-            return out;
+            const T b_value = *b;
+            for(std::size_t i = first; i < last; i++)
+                out[i] = Operation::apply(a[i], b_value);
         }
-        else if(operation == MathOperation::dot)
+        else if(args.a.is_broadcast_scalar() && args.b.is_contiguous(dimensions))
         {
-            T sum = static_cast<T>(0);
-            for(int i = 0; i < data_type.dimensions(); i++)
+            const T a_value = *a;
+            for(std::size_t i = first; i < last; i++)
+                out[i] = Operation::apply(a_value, b[i]);
+        }
+        else
+        {
+            for(std::size_t index = args.begin; index < args.end; index++)
             {
-                sum += a[i] * b[i];
+                const T* a_element = a + index * args.a.element_stride;
+                const T* b_element = b + index * args.b.element_stride;
+                T* out_element = out + index * dimensions;
+
+                for(std::size_t component = 0; component < dimensions; component++)
+                {
+                    out_element[component] = Operation::apply(a_element[component * args.a.component_stride],
+                                                              b_element[component * args.b.component_stride]);
+                }
             }
-            out[0] = sum; //just put it in 0, the node will handle it
         }
-
-        return out;
     }
 
-    template<typename T>
-    std::vector<T> vector_scalar_binary_math_operation(MathOperation operation, const ConnectionDataType& data_type, const T* a, const T b)
+    template<typename T, typename Operation>
+    void unary_kernel(const MathKernelArgs<T>& args)
     {
-        std::vector<T> out(data_type.dimensions());
-
-        bool should_break = false;
+        const std::size_t dimensions = args.dimensions;
+        const T* a = args.a.data;
+        T* out = args.out;
 
-        for(int i = 0; i < data_type.dimensions(); i++)
+        if(args.a.is_contiguous(dimensions))
+        {
+            for(std::size_t i = args.begin * dimensions; i < args.end * dimensions; i++)
+                out[i] = Operation::apply(a[i]);
+        }
+        else
         {
-            switch(operation)
+            for(std::size_t index = args.begin; index < args.end; index++)
             {
-                case MathOperation::add:
-                    out[i] = a[i] + b;
-                    break;
-                case MathOperation::subtract:
-                    out[i] = a[i] - b;
-                    break;
-                case MathOperation::multiply:
-                    out[i] = a[i] * b;
-                    break;
-                case MathOperation::divide:
-                    if(b == 0)
-                        out[i] = 0;
-                    else
-                        out[i] = a[i] / b;
-                    break;
-                case MathOperation::exponent:
-                    out[i] = std::pow(a[i], b);
-                    break;
-                case MathOperation::logorithm:
-                    out[i] = std::log(a[i]) / std::log(b);
-                    break;
-                case MathOperation::mod:
-                    out[i] = static_cast<int>(a[i]) % static_cast<int>(b);
-                    break;
-                case MathOperation::atan2:
-                    out[i] = std::atan2(a[i], b);
-                    break;
-
-                default: should_break = true; break;
-            }
+                const T* a_element = a + index * args.a.element_stride;
+                T* out_element = out + index * dimensions;
 
-            if(should_break)
-                break;
+                for(std::size_t component = 0; component < dimensions; component++)
+                    out_element[component] = Operation::apply(a_element[component * args.a.component_stride]);
+            }
         }
-
-        return out;
     }
 
-    template<typename T>
-    std::vector<T> vector_unary_math_operation(MathOperation operation, const ConnectionDataType& data_type, const T* a)
+    // fast_math's sin and cos lose the angle past max_trig_argument, so the few elements out there are redone exactly afterwards.
+    // Checking in the loop above would need a branch around a library call, which stops it vectorizing.
+    template<typename T, typename Operation, typename ExactOperation>
+    void fast_trig_kernel(const MathKernelArgs<T>& args)
     {
-        std::vector<T> out(data_type.dimensions());
+        unary_kernel<T, Operation>(args);
 
-        bool should_break = false;
+        const std::size_t dimensions = args.dimensions;
+        const T* a = args.a.data;
+        T* out = args.out;
 
-        for(int i = 0; i < data_type.dimensions(); i++)
+        for(std::size_t index = args.begin; index < args.end; index++)
         {
-            switch(operation)
+            const T* a_element = a + index * args.a.element_stride;
+            T* out_element = out + index * dimensions;
+
+            for(std::size_t component = 0; component < dimensions; component++)
             {
-                case MathOperation::negate:
-                    out[i] = -a[i];
-                    break;
-                case MathOperation::square_root:
-                    out[i] = std::sqrt(a[i]);
-                    break;
-                case MathOperation::cube_root:
-                    out[i] = std::cbrt(a[i]);
-                    break;
-                case MathOperation::log_e:
-                    out[i] = std::log(a[i]);
-                    break;
-                case MathOperation::log_10:
-                    out[i] = std::log10(a[i]);
-                    break;
-                case MathOperation::log_2:
-                    out[i] = std::log2(a[i]);
-                    break;
-                case MathOperation::ceiling:
-                    out[i] = std::ceil(a[i]);
-                    break;
-                case MathOperation::floor:
-                    out[i] = std::floor(a[i]);
-                    break;
-                case MathOperation::round:
-                    out[i] = std::round(a[i]);
-
-                default: should_break = true; break;
+                T value = a_element[component * args.a.component_stride];
+                if(!fast_math::is_trig_argument_in_range(value))
+                    out_element[component] = ExactOperation::apply(value);
             }
-
-            if(should_break)
-                break;
         }
-
-        return out;
     }
 
     template<typename T>
-    void execute_math_operation_binary(MathOperation operation,
-                                const InputSocket& a, const InputSocket& b,
-                                const OutputSocket& output_socket,
-                                const CompositeDataBuffer& input, DataBuffer& output,
-                                DataBuffer::size_type index = 0)
+    void dot_kernel(const MathKernelArgs<T>& args)
     {
-        const ConnectionDataType& a_type = a.connection()->get().data_type();
-        const ConnectionDataType& b_type = b.connection()->get().data_type();
+        const std::size_t dimensions = args.dimensions;
 
-        SocketType a_socket_type = a.connection()->get().output().type();
-        SocketType b_socket_type = b.connection()->get().output().type();
-
-        // two scalars
-        if(a_type.dimensions() == 1 && b_type.dimensions() == 1)
+        for(std::size_t index = args.begin; index < args.end; index++)
         {
+            const T* a_element = args.a.data + index * args.a.element_stride;
+            const T* b_element = args.b.data + index * args.b.element_stride;
+            T* out_element = args.out + index * dimensions;
 
-            ptr_array<T, 1> a_value;
-            ptr_array<T, 1> b_value;
-
-            if(a_socket_type == SocketType::attribute)
-            {
-                a_value = input.get_attribute<T, 1>(a, index);
-            }
-            else
-            {
-                a_value = input.get_uniform<T, 1>(a);
-            }
-
-            if(b_socket_type == SocketType::attribute)
-            {
-                b_value = input.get_attribute<T, 1>(b, index);
-            }
-            else
+            T sum = static_cast<T>(0);
+            for(std::size_t component = 0; component < dimensions; component++)
             {
-                b_value = input.get_uniform<T, 1>(b);
+                sum += a_element[component * args.a.component_stride] * b_element[component * args.b.component_stride];
+                out_element[component] = static_cast<T>(0);
             }
 
-            T result = scalar_binary_math_operation(operation, a_value.value(), b_value.value());
-
-            if(output_socket.type() == SocketType::attribute)
-            {
-                output.set_attribute<T, 1>(output_socket, index, &result);
-            }
-            else
-            {
-                output.set_uniform<T, 1>(output_socket, &result);
-            }
+            out_element[0] = sum; //just put it in 0, the node will handle it
         }
-        // scalar and a vector
-        else if((a_type.dimensions() > 1 && b_type.dimensions() == 1) || (a_type.dimensions() == 1 && b_type.dimensions() > 1))
-        {
-            // a and b are arbitrary here
-            const T* a_value;
-            ptr_array<T, 1> b_value;
-
-            // This large if mess is just getting data into a_value and b_value
-            if(a_type.dimensions() == 1)
-            {
-                if(a_socket_type == SocketType::attribute)
-                {
-                    b_value = input.get_attribute<T, 1>(a, index);
-                }
-                else
-                {
-                    b_value = input.get_uniform<T, 1>(a);
-                }
-
-                if(b_socket_type == SocketType::attribute)
-                {
-                    a_value = reinterpret_cast<const T*>(input.get_attribute_raw(b, b_type, index));
-                }
-                else
-                {
-                    a_value = reinterpret_cast<const T*>(input.get_uniform_raw(b, b_type));
-                }
-
-                std::vector<T> result = vector_scalar_binary_math_operation(operation, b_type, a_value, b_value.value());
-
-                if(output_socket.type() == SocketType::attribute)
-                {
-                    output.set_attribute_raw(output_socket, b_type, index, reinterpret_cast<unsigned char*>(&result[0]));
-                }
-                else
-                {
-                    output.set_uniform_raw(output_socket, b_type, reinterpret_cast<unsigned char*>(&result[0]));
-                }
-            }
-            else
-            {
-                if(b_socket_type == SocketType::attribute)
-                {
-                    b_value = input.get_attribute<T, 1>(b, index);
-                }
-                else
-                {
-                    b_value = input.get_uniform<T, 1>(b);
-                }
-
-                if(a_socket_type == SocketType::attribute)
-                {
-                    a_value = reinterpret_cast<const T*>(input.get_attribute_raw(a, a_type, index));
-                }
-                else
-                {
-                    a_value = reinterpret_cast<const T*>(input.get_uniform_raw(a, a_type));
-                }
-
-                std::vector<T> result = vector_scalar_binary_math_operation(operation, a_type, a_value, b_value.value());
+    }
 
-                if(output_socket.type() == SocketType::attribute)
-                {
-                    output.set_attribute_raw(output_socket, a_type, index, reinterpret_cast<unsigned char*>(&result[0]));
-                }
-                else
-                {
-                    output.set_uniform_raw(output_socket, a_type, reinterpret_cast<unsigned char*>(&result[0]));
-                }
-            }
-        }
-        // two vectors
-        else if(a_type.dimensions() > 1 && b_type.dimensions() > 1)
+    template<typename T>
+    void cross_kernel(const MathKernelArgs<T>& args)
+    {
+        // Validation makes sure both sides are 3-dimensional vectors
+        for(std::size_t index = args.begin; index < args.end; index++)
         {
-            const T* a_value;
-            const T* b_value;
+            const T* a = args.a.data + index * args.a.element_stride;
+            const T* b = args.b.data + index * args.b.element_stride;
+            T* out = args.out + index * 3;
 
-            if(a_socket_type == SocketType::attribute)
-            {
-                a_value = reinterpret_cast<const T*>(input.get_attribute_raw(a, a_type, index));
-            }
-            else
-            {
-                a_value = reinterpret_cast<const T*>(input.get_uniform_raw(a, a_type));
-            }
-
-            if(b_socket_type == SocketType::attribute)
-            {
-                b_value = reinterpret_cast<const T*>(input.get_attribute_raw(b, b_type, index));
-            }
-            else
-            {
-                b_value = reinterpret_cast<const T*>(input.get_uniform_raw(b, b_type));
-            }
-
-            std::vector<T> result = vector_binary_math_operation(operation, a_type, a_value, b_value);
+            out[0] = a[1] * b[2] - a[2] * b[1];
+            out[1] = a[2] * b[0] - a[0] * b[2];
+            out[2] = a[0] * b[1] - a[1] * b[0];
+        }
+    }
 
-            if(output_socket.type() == SocketType::attribute)
-            {
-                output.set_attribute_raw(output_socket, a_type, index, reinterpret_cast<unsigned char*>(&result[0]));
-            }
-            else
-            {
-                output.set_uniform_raw(output_socket, a_type, reinterpret_cast<unsigned char*>(&result[0]));
-            }
+    // Returns nullptr if the operation has no approximation, so the exact kernel is used
+    template<typename T>
+    MathKernel<T> select_fast_kernel(MathOperation operation, std::true_type /* is_floating_point */)
+    {
+        switch(operation)
+        {
+            case MathOperation::exponent: return &binary_kernel<T, FastExponentOperation<T>>;
+            case MathOperation::logorithm: return &binary_kernel<T, FastLogarithmOperation<T>>;
+            case MathOperation::atan2: return &binary_kernel<T, FastAtan2Operation<T>>;
+            case MathOperation::log_e: return &unary_kernel<T, FastLogEOperation<T>>;
+            case MathOperation::log_10: return &unary_kernel<T, FastLog10Operation<T>>;
+            case MathOperation::log_2: return &unary_kernel<T, FastLog2Operation<T>>;
+            case MathOperation::sin: return &fast_trig_kernel<T, FastSinOperation<T>, SinOperation<T>>;
+            case MathOperation::cos: return &fast_trig_kernel<T, FastCosOperation<T>, CosOperation<T>>;
+            default: return nullptr;
         }
-        else throw std::logic_error("What happened?");
     }
 
     template<typename T>
-    void execute_math_operation_unary(MathOperation operation,
-                                      const InputSocket& a,
-                                      const OutputSocket& output_socket,
-                                      const CompositeDataBuffer& input, DataBuffer& output,
-                                      DataBuffer::size_type index = 0)
+    MathKernel<T> select_fast_kernel(MathOperation, std::false_type /* is_floating_point */)
     {
-        const ConnectionDataType& a_type = a.connection()->get().data_type();
-        SocketType a_socket_type = a.connection()->get().output().type();
-        bool is_attribute = a_socket_type == SocketType::attribute;
+        return nullptr;
+    }
 
-        if(a_type.dimensions() == 1)
+    template<typename T>
+    MathKernel<T> select_kernel(MathOperation operation, MathPrecision precision)
+    {
+        if(precision == MathPrecision::fast)
         {
-            ptr_array<T, 1> a_value;
+            MathKernel<T> fast_kernel = select_fast_kernel<T>(operation, typename std::is_floating_point<T>::type());
+            if(fast_kernel)
+                return fast_kernel;
+        }
 
-            if(is_attribute)
-                a_value = input.get_attribute<T, 1>(a, index);
-            else
-                a_value = input.get_uniform<T, 1>(a);
+        switch(operation)
+        {
+            case MathOperation::add: return &binary_kernel<T, AddOperation<T>>;
+            case MathOperation::subtract: return &binary_kernel<T, SubtractOperation<T>>;
+            case MathOperation::multiply: return &binary_kernel<T, MultiplyOperation<T>>;
+            case MathOperation::divide: return &binary_kernel<T, DivideOperation<T>>;
+            case MathOperation::exponent: return &binary_kernel<T, ExponentOperation<T>>;
+            case MathOperation::logorithm: return &binary_kernel<T, LogarithmOperation<T>>;
+            case MathOperation::mod: return &binary_kernel<T, ModOperation<T>>;
+            case MathOperation::dot: return &dot_kernel<T>;
+            case MathOperation::cross: return &cross_kernel<T>;
+            case MathOperation::atan2: return &binary_kernel<T, Atan2Operation<T>>;
+
+            case MathOperation::negate: return &unary_kernel<T, NegateOperation<T>>;
+            case MathOperation::square_root: return &unary_kernel<T, SquareRootOperation<T>>;
+            case MathOperation::cube_root: return &unary_kernel<T, CubeRootOperation<T>>;
+            case MathOperation::log_e: return &unary_kernel<T, LogEOperation<T>>;
+            case MathOperation::log_10: return &unary_kernel<T, Log10Operation<T>>;
+            case MathOperation::log_2: return &unary_kernel<T, Log2Operation<T>>;
+            case MathOperation::ceiling: return &unary_kernel<T, CeilingOperation<T>>;
+            case MathOperation::floor: return &unary_kernel<T, FloorOperation<T>>;
+            case MathOperation::round: return &unary_kernel<T, RoundOperation<T>>;
+            case MathOperation::sin: return &unary_kernel<T, SinOperation<T>>;
+            case MathOperation::cos: return &unary_kernel<T, CosOperation<T>>;
+            case MathOperation::tan: return &unary_kernel<T, TanOperation<T>>;
+            case MathOperation::asin: return &unary_kernel<T, AsinOperation<T>>;
+            case MathOperation::acos: return &unary_kernel<T, AcosOperation<T>>;
+            case MathOperation::atan: return &unary_kernel<T, AtanOperation<T>>;
+        }
 
-            T result = scalar_unary_math_operation(operation, a_value.value());
+        throw std::logic_error("Unknown math operation.");
+    }
 
-            if(is_attribute)
-                output.set_attribute<T, 1>(output_socket, index, &result);
-            else
-                output.set_uniform<T, 1>(output_socket, &result);
+    template<typename T>
+    MathOperand<T> resolve_operand(const InputSocket& socket, const CompositeDataBuffer& input)
+    {
+        const Connection& connection = socket.connection()->get();
+        const ConnectionDataType& data_type = connection.data_type();
+        std::size_t dimensions = data_type.dimensions();
+
+        MathOperand<T> operand;
+        operand.component_stride = dimensions > 1 ? 1 : 0;
+
+        if(connection.output().type() == SocketType::attribute)
+        {
+            operand.data = reinterpret_cast<const T*>(std::get<0>(input.get_attribute_all_raw(socket, data_type)));
+            operand.element_stride = dimensions;
         }
         else
         {
-            const T* a_value;
+            operand.data = reinterpret_cast<const T*>(input.get_uniform_raw(socket, data_type));
+            operand.element_stride = 0;
+        }
 
-            if(is_attribute)
-                a_value = reinterpret_cast<const T*>(input.get_attribute_raw(a, a_type, index));
-            else
-                a_value = reinterpret_cast<const T*>(input.get_uniform_raw(a, a_type));
+        return operand;
+    }
 
-            std::vector<T> result = vector_unary_math_operation(operation, a_type, a_value);
+    /** Runs the resolved kernel over [begin, end) of the output. Uniform outputs are always run over [0, 1). **/
+    typedef std::function<void(const CompositeDataBuffer&, DataBuffer&, DataBuffer::size_type, DataBuffer::size_type)> MathPlan;
 
-            if(is_attribute)
-                output.set_attribute_raw(output_socket, a_type, index, reinterpret_cast<const unsigned char*>(&result[0]));
+    // Everything that depends on the operation, the data type and whether the inputs are uniforms or attributes is
+    // resolved here once per execution, so the per-range work is just fetching the buffers and running the loop.
+    template<typename T>
+    MathPlan make_math_plan(MathOperation operation, MathPrecision precision, const InputSocket& a_socket, const InputSocket* b_socket, const OutputSocket& output_socket)
+    {
+        MathKernel<T> kernel = select_kernel<T>(operation, precision);
+        const ConnectionDataType& output_type = output_socket.data_type();
+        std::size_t dimensions = output_type.dimensions();
+        bool output_is_attribute = output_socket.type() == SocketType::attribute;
+
+        return [kernel, &a_socket, b_socket, &output_socket, &output_type, dimensions, output_is_attribute]
+            (const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end)
+        {
+            MathKernelArgs<T> args;
+            args.a = resolve_operand<T>(a_socket, input);
+            args.b = b_socket ? resolve_operand<T>(*b_socket, input) : args.a;
+            args.dimensions = dimensions;
+            args.begin = begin;
+            args.end = end;
+
+            if(output_is_attribute)
+            {
+                args.out = reinterpret_cast<T*>(output.get_attribute_all_raw(output_socket, output_type));
+                kernel(args);
+            }
             else
-                output.set_uniform_raw(output_socket, a_type, reinterpret_cast<const unsigned char*>(&result[0]));
-        }
+            {
+                std::vector<T> result(dimensions);
+                args.out = result.data();
+                args.begin = 0;
+                args.end = 1;
+                kernel(args);
+                output.set_uniform_raw(output_socket, output_type, reinterpret_cast<const unsigned char*>(result.data()));
+            }
+        };
     }
 }
 
@@ -453,6 +366,10 @@ namespace nodes {
         int default_operation = (int)MathOperation::add;
         operation.set_default_value<int, 1>(&default_operation);
 
+        Property& precision = add_property<int, 1>("Precision");
+        int default_precision = (int)MathPrecision::exact;
+        precision.set_default_value<int, 1>(&default_precision);
+
         inputs().add("A", SocketType::either);
         inputs().add("B", SocketType::either);
 
@@ -541,8 +458,12 @@ namespace nodes {
             const Connection& b_connection_val = *b_connection;
 
             // if *either* connection is an attribute, the result is an attribute
-            if(a_connection_val.output().type() == SocketType::uniform ||
-               b_connection_val.output().type() == SocketType::uniform)
+            if(a_connection_val.output().type() == SocketType::attribute ||
+               b_connection_val.output().type() == SocketType::attribute)
+            {
+                output("Output").set_type(SocketType::attribute);
+            }
+            else
             {
                 output("Output").set_type(SocketType::uniform);
             }
@@ -579,100 +500,60 @@ namespace nodes {
 
     void Math::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
     {
-        if(this->output("Output").type() == SocketType::attribute)
-            return; // Handled in execute_attributes
-
         const Property& operation_prop = property("Operation");
 
         MathOperation operation = static_cast<MathOperation>(operation_prop.value_or_default<int, 1>().value());
+        MathPrecision precision = static_cast<MathPrecision>(property("Precision").value_or_default<int, 1>().value());
 
         const OutputSocket& output_socket = this->output("Output");
-
         const InputSocket& a_socket = this->input("A");
         const ConnectionDataType& a_type = a_socket.connection()->get().data_type();
 
+        const InputSocket* b_socket = nullptr;
         if(inputs().get_by_name("B"))
-        {
-            const InputSocket& b_socket = this->input("B");
+            b_socket = &this->input("B");
 
-            if(a_type.is<int>())
-            {
-                execute_math_operation_binary<int>(operation, a_socket, b_socket, output_socket, input, output);
-            }
-            else if(a_type.is<float>())
-            {
-                execute_math_operation_binary<float>(operation, a_socket, b_socket, output_socket, input, output);
-            }
-            else if(a_type.is<double>())
-            {
-                execute_math_operation_binary<double>(operation, a_socket, b_socket, output_socket, input, output);
-            }
+        MathPlan plan;
+
+        if(a_type.is<int>())
+        {
+            plan = make_math_plan<int>(operation, precision, a_socket, b_socket, output_socket);
         }
-        else
+        else if(a_type.is<float>())
         {
-            if(a_type.is<int>())
-            {
-                execute_math_operation_unary<int>(operation, a_socket, output_socket, input, output);
-            }
-            else if(a_type.is<float>())
-            {
-                execute_math_operation_unary<float>(operation, a_socket, output_socket, input, output);
-            }
-            else if(a_type.is<double>())
-            {
-                execute_math_operation_unary<double>(operation, a_socket, output_socket, input, output);
-            }
+            plan = make_math_plan<float>(operation, precision, a_socket, b_socket, output_socket);
+        }
+        else if(a_type.is<double>())
+        {
+            plan = make_math_plan<double>(operation, precision, a_socket, b_socket, output_socket);
         }
+
+        if(output_socket.type() == SocketType::uniform)
+        {
+            plan(input, output, 0, 1);
+            return;
+        }
+
+        output.set_scratch(0, plan); // Attributes are handled in execute_attribute_range
     }
 
-    void Math::execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const
+    void Math::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
     {
         if(this->output("Output").type() == SocketType::uniform)
             return; //Handled in execute_uniforms
 
-        const Property& operation_prop = property("Operation");
-
-        MathOperation operation = static_cast<MathOperation>(operation_prop.value_or_default<int, 1>().value());
-
-        const OutputSocket& output_socket = this->output("Output");
-
-        const InputSocket& a_socket = this->input("A");
-        const InputSocket& b_socket = this->input("B");
-
-        const ConnectionDataType& a_type = a_socket.connection()->get().data_type();
-
-        if(inputs().get_by_name("B"))
-        {
-            if(a_type.is<int>())
-            {
-                execute_math_operation_binary<int>(operation, a_socket, b_socket, output_socket, input, output, index);
-            }
-            else if(a_type.is<float>())
-            {
-                execute_math_operation_binary<float>(operation, a_socket, b_socket, output_socket, input, output, index);
-            }
-            else if(a_type.is<double>())
-            {
-                execute_math_operation_binary<double>(operation, a_socket, b_socket, output_socket, input, output, index);
-            }
-        }
-        else
-        {
-            if(a_type.is<int>())
-            {
-                execute_math_operation_unary<int>(operation, a_socket, output_socket, input, output, index);
-            }
-            else if(a_type.is<float>())
-            {
-                execute_math_operation_unary<float>(operation, a_socket, output_socket, input, output, index);
-            }
-            else if(a_type.is<double>())
-            {
-                execute_math_operation_unary<double>(operation, a_socket, output_socket, input, output, index);
-            }
-        }
+        const MathPlan& plan = output.get_scratch_ref<MathPlan>(0);
+        plan(input, output, begin, end);
+    }
 
+    void Math::execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
 
+    bool Math::is_elementwise() const
+    {
+        return true;
     }
 
     std::string Math::node_name() const
@@ -716,6 +597,19 @@ namespace nodes {
             {
                 results.add("Math node supports math operations on two scalars, two same-sized vectors, or one vector and one scalar.");
             }
+
+            const Property& operation_prop = property("Operation");
+            MathOperation operation = static_cast<MathOperation>(operation_prop.value_or_default<int, 1>().value());
+
+            if(operation == MathOperation::dot && (a_type.dimensions() != b_type.dimensions() || a_type.dimensions() < 2))
+            {
+                results.add("Dot product requires two same-sized vectors.");
+            }
+
+            if(operation == MathOperation::cross && (a_type.dimensions() != 3 || b_type.dimensions() != 3))
+            {
+                results.add("Cross product requires two 3-dimensional vectors.");
+            }
         }
         else
         {
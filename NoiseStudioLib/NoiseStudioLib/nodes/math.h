@@ -46,6 +46,16 @@ namespace nodes {
         atan
     };
 
+    enum class MathPrecision
+    {
+        // The standard library functions
+        exact,
+
+        // Polynomial approximations (see fast_math.h) for exponent, logorithm, atan2, the logs, sin and cos on float and double.
+        // About 1e-5 relative error, more for exponent with large results. Other operations and ints are unaffected.
+        fast
+    };
+
     class Math : public GraphNode
     {
     public:
@@ -56,6 +66,8 @@ namespace nodes {
         void recalculate_sockets();
         void execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const;
         void execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const;
+        void execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+        bool is_elementwise() const;
 
         void validate(ValidationResults& results) const;
 
@@ -0,0 +1,231 @@
+#include "normal_map.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "composite_data_buffer.h"
+#include "validation_results.h"
+#include "parallel.h"
+#include "whole_grid.h"
+
+namespace
+{
+    // Calls store(x, dh/dx, dh/dy) for each pixel of a row. {up} and {down} are the rows either side (clamped to the grid), and
+    // {x_scale} is half the reciprocal of the spacing, for the central difference. The interior doesn't need any clamping, so the
+    // compiler vectorizes it.
+    template<typename Store>
+    void gradient_row(const float* up, const float* row, const float* down, std::size_t width, float x_scale, float y_scale, Store store)
+    {
+        store(0, (row[std::min<std::size_t>(1, width - 1)] - row[0]) * x_scale * 2.0f, (down[0] - up[0]) * y_scale);
+
+        for(std::size_t x = 1; x + 1 < width; x++)
+        {
+            store(x, (row[x + 1] - row[x - 1]) * x_scale, (down[x] - up[x]) * y_scale);
+        }
+
+        if(width > 1)
+        {
+            std::size_t x = width - 1;
+            store(x, (row[x] - row[x - 1]) * x_scale * 2.0f, (down[x] - up[x]) * y_scale);
+        }
+    }
+
+    // Second differences along x and y summed. Along y they are taken around {centre}, which is the row itself away from the first and
+    // last rows and the nearest interior row on them, so a plane has no curvature anywhere. The same goes for the columns of {row}.
+    void curvature_row(const float* above, const float* centre, const float* below, const float* row, float* out, std::size_t width, float scale)
+    {
+        for(std::size_t x = 0; x < width; x++)
+        {
+            out[x] = (above[x] - 2.0f * centre[x] + below[x]) * scale;
+        }
+
+        // With fewer than 3 pixels across there is no second difference
+        if(width < 3)
+            return;
+
+        const float first = row[0] - 2.0f * row[1] + row[2];
+        const float last = row[width - 3] - 2.0f * row[width - 2] + row[width - 1];
+
+        out[0] += first * scale;
+        for(std::size_t x = 1; x + 1 < width; x++)
+        {
+            out[x] += (row[x - 1] - 2.0f * row[x] + row[x + 1]) * scale;
+        }
+        out[width - 1] += last * scale;
+    }
+}
+
+namespace noises {
+namespace nodes
+{
+    NormalMap::NormalMap() :
+        height_socket_(nullptr),
+        normal_socket_(nullptr),
+        slope_socket_(nullptr),
+        curvature_socket_(nullptr),
+        strength_property_(nullptr),
+        spacing_property_(nullptr),
+        slope_property_(nullptr),
+        curvature_property_(nullptr)
+    {
+        height_socket_ = &inputs().add("Height", SocketType::attribute);
+        height_socket_->set_accepts(ConnectionDataType::value<float, 1>());
+
+        normal_socket_ = &outputs().add("Normal", ConnectionDataType::value<float, 3>(), SocketType::attribute);
+
+        strength_property_ = &add_property<float, 1>("Strength");
+        float default_strength = 1.0f;
+        strength_property_->set_default_value<float, 1>(&default_strength);
+
+        spacing_property_ = &add_property<float, 1>("Spacing");
+        float default_spacing = 1.0f;
+        spacing_property_->set_default_value<float, 1>(&default_spacing);
+
+        slope_property_ = &add_property<int, 1>("Output Slope");
+        int default_output_slope = 0;
+        slope_property_->set_default_value<int, 1>(&default_output_slope);
+
+        curvature_property_ = &add_property<int, 1>("Output Curvature");
+        int default_output_curvature = 0;
+        curvature_property_->set_default_value<int, 1>(&default_output_curvature);
+    }
+
+    std::string NormalMap::node_name() const
+    {
+        return "Normal Map";
+    }
+
+    bool NormalMap::is_pure() const
+    {
+        return true;
+    }
+
+    void NormalMap::recalculate_sockets()
+    {
+        if(slope_property_ == nullptr || curvature_property_ == nullptr)
+            return; // Still initializing
+
+        bool output_slope = slope_property_->value_or_default<int, 1>().value() != 0;
+
+        if(output_slope && slope_socket_ == nullptr)
+        {
+            slope_socket_ = &outputs().add("Slope", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+        }
+        else if(!output_slope && slope_socket_ != nullptr)
+        {
+            outputs().remove(*slope_socket_);
+            slope_socket_ = nullptr;
+        }
+
+        bool output_curvature = curvature_property_->value_or_default<int, 1>().value() != 0;
+
+        if(output_curvature && curvature_socket_ == nullptr)
+        {
+            curvature_socket_ = &outputs().add("Curvature", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+        }
+        else if(!output_curvature && curvature_socket_ != nullptr)
+        {
+            outputs().remove(*curvature_socket_);
+            curvature_socket_ = nullptr;
+        }
+    }
+
+    void NormalMap::set_strength(float strength)
+    {
+        strength_property_->set_value<float, 1>(&strength);
+    }
+
+    void NormalMap::set_spacing(float spacing)
+    {
+        spacing_property_->set_value<float, 1>(&spacing);
+    }
+
+    void NormalMap::set_output_slope(bool output_slope)
+    {
+        int value = output_slope ? 1 : 0;
+        slope_property_->set_value<int, 1>(&value);
+    }
+
+    void NormalMap::set_output_curvature(bool output_curvature)
+    {
+        int value = output_curvature ? 1 : 0;
+        curvature_property_->set_value<int, 1>(&value);
+    }
+
+    void NormalMap::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type, DataBuffer::size_type) const
+    {
+        // The derivatives read the neighbouring pixels, so Normal Map isn't element-wise and this is called once for the whole grid
+        WholeGrid grid(output.attribute_info(), "Normal Map");
+        if(grid.empty())
+            return;
+
+        const std::size_t width = grid.width;
+        const std::size_t height = grid.height;
+
+        const float strength = strength_property_->value_or_default<float, 1>().value();
+        const float spacing = spacing_property_->value_or_default<float, 1>().value();
+        const float x_scale = strength / (2.0f * spacing);
+        const float curvature_scale = strength / (spacing * spacing);
+
+        const float* heights = reinterpret_cast<const float*>(std::get<0>(input.get_attribute_all_raw(*height_socket_, ConnectionDataType::value<float, 1>())));
+        float* normals = reinterpret_cast<float*>(output.get_attribute_all_raw(*normal_socket_, ConnectionDataType::value<float, 3>()));
+        float* slopes = slope_socket_ == nullptr ? nullptr :
+                reinterpret_cast<float*>(output.get_attribute_all_raw(*slope_socket_, ConnectionDataType::value<float, 1>()));
+        float* curvatures = curvature_socket_ == nullptr ? nullptr :
+                reinterpret_cast<float*>(output.get_attribute_all_raw(*curvature_socket_, ConnectionDataType::value<float, 1>()));
+
+        // Each row only reads the rows either side of it, so all the outputs for a row are written while those are in the cache
+        parallel_for(height, WholeGrid::rows_per_task(), [&](std::size_t begin, std::size_t end)
+        {
+            for(std::size_t y = begin; y < end; y++)
+            {
+                std::size_t up_index = clamp_index(static_cast<std::ptrdiff_t>(y) - 1, height);
+                std::size_t down_index = clamp_index(static_cast<std::ptrdiff_t>(y) + 1, height);
+
+                const float* up = heights + up_index * width;
+                const float* row = heights + y * width;
+                const float* down = heights + down_index * width;
+
+                // One-sided on the first and last rows, and no gradient at all along y with a single row
+                float y_scale = down_index == up_index ? 0.0f : strength / (spacing * static_cast<float>(down_index - up_index));
+
+                float* normal_row = normals + y * width * 3;
+                gradient_row(up, row, down, width, x_scale, y_scale, [normal_row](std::size_t x, float dx, float dy)
+                {
+                    float inverse_length = 1.0f / std::sqrt(dx * dx + dy * dy + 1.0f);
+                    normal_row[x * 3] = -dx * inverse_length;
+                    normal_row[x * 3 + 1] = -dy * inverse_length;
+                    normal_row[x * 3 + 2] = inverse_length;
+                });
+
+                if(slopes != nullptr)
+                {
+                    float* slope_row = slopes + y * width;
+                    gradient_row(up, row, down, width, x_scale, y_scale, [slope_row](std::size_t x, float dx, float dy)
+                    {
+                        slope_row[x] = std::sqrt(dx * dx + dy * dy);
+                    });
+                }
+
+                if(curvatures != nullptr)
+                {
+                    // With fewer than 3 rows the second difference along y is 0
+                    std::size_t centre_index = height < 3 ? y : std::min(std::max<std::size_t>(y, 1), height - 2);
+                    const float* centre = heights + centre_index * width;
+                    const float* above = height < 3 ? centre : centre - width;
+                    const float* below = height < 3 ? centre : centre + width;
+
+                    curvature_row(above, centre, below, row, curvatures + y * width, width, curvature_scale);
+                }
+            }
+        });
+    }
+
+    void NormalMap::validate(ValidationResults &results) const
+    {
+        if(spacing_property_->value_or_default<float, 1>().value() <= 0.0f)
+        {
+            results.add("Normal Map spacing must be greater than 0.");
+        }
+    }
+} }
@@ -0,0 +1,50 @@
+#ifndef NORMAL_MAP_H
+#define NORMAL_MAP_H
+
+#include "graph_node.h"
+
+namespace noises {
+namespace nodes
+{
+    // Turns a heightmap on a 2D grid (e.g. from BlankGrid) into surface normals, and optionally the slope and curvature. Derivatives
+    // are central differences between neighbouring pixels, one-sided along the edges of the grid.
+    class NormalMap : public GraphNode
+    {
+    public:
+        NormalMap();
+
+        std::string node_name() const;
+
+        void recalculate_sockets();
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+
+        void validate(ValidationResults& results) const;
+
+        bool is_pure() const;
+
+        /** Multiplies the heights before the derivatives are taken. **/
+        void set_strength(float strength);
+
+        /** The distance between neighbouring pixels, in the same units as the heights. **/
+        void set_spacing(float spacing);
+
+        /** Adds or removes the Slope output, the length of the height gradient (rise over run). **/
+        void set_output_slope(bool output_slope);
+
+        /** Adds or removes the Curvature output, the laplacian of the height. Positive in valleys, negative on ridges. **/
+        void set_output_curvature(bool output_curvature);
+
+    private:
+        InputSocket* height_socket_;
+        OutputSocket* normal_socket_;
+        OutputSocket* slope_socket_;
+        OutputSocket* curvature_socket_;
+
+        Property* strength_property_;
+        Property* spacing_property_;
+        Property* slope_property_;
+        Property* curvature_property_;
+    };
+} }
+
+#endif // NORMAL_MAP_H
@@ -5,22 +5,138 @@
 #include <vector>
 
 #include "composite_data_buffer.h"
+#include "validation_results.h"
 
-namespace noises {
-namespace nodes
+namespace
 {
-    struct PerlinNoiseData
+    using namespace noises;
+    using namespace nodes;
+
+    /** Perlin noise for a fixed number of dimensions, so every loop has a compile time trip count and indexes static tables. **/
+    template<unsigned int N>
+    float evaluate_lattice_fixed(const PerlinNoiseData& data, const long long* cell, const float* fraction, float* gradient)
     {
-        PerlinNoiseData() { }
+        const std::size_t num_points = HypercubeCorners<N>::count;
+        const unsigned char* corners = HypercubeCorners<N>::flattened();
+
+        unsigned int num_gradients = data.vectors.size() / N;
+        const signed char* vectors = data.vectors.data();
+
+        // Because of how the corner table is laid out, adjacent verticies are in pairs recursively
+        // There will always be an even number of points (2^n)
+        std::array<float, num_points> out;
+
+        // Partial derivatives of each entry in out, carried through the interpolation so the gradient comes out of the same pass
+        bool calculate_gradient = gradient != nullptr;
+        std::array<float, num_points * N> gradients;
+
+        // Fade curve (and its derivative) for the position inside the cell along each dimension
+        std::array<float, N> interpolated;
+        std::array<float, N> interpolated_derivative;
+
+        for(unsigned int i = 0; i < N; i++)
+        {
+            float u = fraction[i];
+            interpolated[i] = u * u * u * (u * (u * 6 - 15) + 10);
+            interpolated_derivative[i] = u * u * (u * (u * 30 - 60) + 30);
+        }
+
+        // Find dot product for every vertex.
+        // Multiply the vector from the hypercube vertex to the input point, and the gradient at the hypercube vertex
+        for(std::size_t i = 0; i < num_points; i++)
+        {
+            const unsigned char* corner = corners + i * N;
+
+            // Get the rng gradient for the vertex. Hash x/y/z to get index into gradients array
+            unsigned int sum = 0;
+            for(unsigned int j = 0; j < N; j++)
+            {
+                // Wrapping only the hashed coordinate keeps the distances to the vertex intact, so tiling costs nothing extra
+                long long wrapped = cell[j] + corner[j];
+                if(data.period > 0)
+                    wrapped = ((wrapped % data.period) + data.period) % data.period;
+
+                // Unsigned so that huge lattice coordinates wrap around instead of overflowing
+                unsigned int lattice = static_cast<unsigned int>(wrapped);
 
-        std::unique_ptr<boost::random::mt19937> rng;
+                static const unsigned int primes[] { 1699, 2237, 2671, 3571, 1949, 2221, 3469, 3083 };
+                sum += lattice * lattice * primes[j]; //Hopefully this has enough entropy and random enough results
+            }
+
+            const signed char* vertex_gradient = vectors + (sum % num_gradients) * N;
+
+            // In theory, the dot products will be -1 to 1
+            float dot = 0;
 
-        std::vector<signed char> vectors;
+            for(unsigned int j = 0; j < N; j++)
+            {
+                // vector (for this dimension) from hypercube vertex to input point. The vertex is either the cell start or one past it
+                float u = fraction[j] - corner[j];
 
-        int dimensions;
-    };
+                dot += u * vertex_gradient[j];
 
-    PerlinNoise::PerlinNoise()
+                // d(dot)/dp is just the gradient at the vertex
+                if(calculate_gradient)
+                    gradients[i * N + j] = vertex_gradient[j];
+            }
+
+            out[i] = dot;
+        }
+
+        // Collapse the dimensions down
+        unsigned int current_dimension = N;
+        for(std::size_t remaining = num_points; remaining > 1; remaining /= 2)
+        {
+            // Take the dot products two at a time and interpolate between then
+            std::size_t half_num = remaining / 2;
+            float t = interpolated[current_dimension - 1];
+
+            for(std::size_t i = 0; i < half_num; i++)
+            {
+                std::size_t index = i * 2;
+
+                float x_1 = out[index];
+                float x_2 = out[index + 1];
+
+                out[i] = (x_1 * (1.0f - t)) + (x_2 * t);
+
+                if(calculate_gradient)
+                {
+                    // Product rule: interpolate the partials, plus the derivative of the fade curve along the collapsed dimension
+                    const float* gradient_1 = &gradients[index * N];
+                    const float* gradient_2 = &gradients[(index + 1) * N];
+                    float* gradient_out = &gradients[i * N];
+
+                    for(unsigned int j = 0; j < N; j++)
+                    {
+                        gradient_out[j] = (gradient_1[j] * (1.0f - t)) + (gradient_2[j] * t);
+                    }
+
+                    gradient_out[current_dimension - 1] += (x_2 - x_1) * interpolated_derivative[current_dimension - 1];
+                }
+            }
+
+            current_dimension--;
+        }
+
+        if(calculate_gradient)
+            std::copy(gradients.begin(), gradients.begin() + N, gradient);
+
+        return out[0];
+    }
+}
+
+namespace noises {
+namespace nodes
+{
+    PerlinNoise::PerlinNoise() :
+        seed_socket_(nullptr),
+        points_socket_(nullptr),
+        offset_socket_(nullptr),
+        output_socket_(nullptr),
+        gradient_socket_(nullptr),
+        gradient_property_(nullptr),
+        period_property_(nullptr)
     {
         seed_socket_ = &inputs().add("Seed", SocketType::uniform);
         seed_socket_->set_accepts(ConnectionDataType::value<long, 1>());
@@ -32,8 +148,81 @@ namespace nodes
         points_socket_->set_accepts(ConnectionDataType::value<float, 4>());
         points_socket_->set_accepts(ConnectionDataType::value<float, 5>());
         points_socket_->set_accepts(ConnectionDataType::value<float, 6>());
+        points_socket_->set_accepts(ConnectionDataType::value<double, 2>());
+        points_socket_->set_accepts(ConnectionDataType::value<double, 3>());
+        points_socket_->set_accepts(ConnectionDataType::value<double, 4>());
+        points_socket_->set_accepts(ConnectionDataType::value<double, 5>());
+        points_socket_->set_accepts(ConnectionDataType::value<double, 6>());
+
+        // Whole lattice cells added to every point, for worlds too large to represent in the points themselves
+        offset_socket_ = &inputs().add("Offset", SocketType::uniform);
+        offset_socket_->set_accepts(ConnectionDataType::value<long long, 2>());
+        offset_socket_->set_accepts(ConnectionDataType::value<long long, 3>());
+        offset_socket_->set_accepts(ConnectionDataType::value<long long, 4>());
+        offset_socket_->set_accepts(ConnectionDataType::value<long long, 5>());
+        offset_socket_->set_accepts(ConnectionDataType::value<long long, 6>());
+        offset_socket_->set_optional(true);
 
         output_socket_ = &outputs().add("Output", ConnectionDataType::value<float, 1>(), SocketType::attribute);
+
+        gradient_property_ = &add_property<int, 1>("Output Gradient");
+        int default_output_gradient = 0;
+        gradient_property_->set_default_value<int, 1>(&default_output_gradient);
+
+        period_property_ = &add_property<int, 1>("Period");
+        int default_period = 0;
+        period_property_->set_default_value<int, 1>(&default_period);
+    }
+
+    void PerlinNoise::recalculate_sockets()
+    {
+        if(points_socket_ == nullptr || output_socket_ == nullptr || gradient_property_ == nullptr)
+            return; // Still initializing
+
+        bool output_gradient = gradient_property_->value_or_default<int, 1>().value() != 0;
+
+        if(!output_gradient)
+        {
+            if(gradient_socket_ != nullptr)
+            {
+                outputs().remove(*gradient_socket_);
+                gradient_socket_ = nullptr;
+            }
+            return;
+        }
+
+        if(gradient_socket_ == nullptr)
+            gradient_socket_ = &outputs().add("Gradient", ConnectionDataType::undefined(), SocketType::attribute);
+
+        // The gradient has one component per input dimension
+        auto points_connection = points_socket_->connection();
+        if(points_connection)
+            gradient_socket_->set_data_type(ConnectionDataType::dynamic<float>(points_connection->get().data_type().dimensions()));
+        else
+            gradient_socket_->set_data_type(ConnectionDataType::undefined());
+    }
+
+    bool PerlinNoise::is_elementwise() const
+    {
+        return true;
+    }
+
+    void PerlinNoise::validate(ValidationResults &results) const
+    {
+        auto points_connection = points_socket_->connection();
+        auto offset_connection = offset_socket_->connection();
+
+        if(!points_connection || !offset_connection)
+            return; // Validation will be handled by the global validator
+
+        if(points_connection->get().data_type().dimensions() != offset_connection->get().data_type().dimensions())
+            results.add("Perlin noise Offset must have the same number of dimensions as Points.");
+    }
+
+    void PerlinNoise::set_output_gradient(bool output_gradient)
+    {
+        int value = output_gradient ? 1 : 0;
+        gradient_property_->set_value<int, 1>(&value);
     }
 
     std::string PerlinNoise::node_name() const
@@ -41,24 +230,47 @@ namespace nodes
         return "Perlin Noise";
     }
 
+    void PerlinNoise::set_period(int period)
+    {
+        period_property_->set_value<int, 1>(&period);
+    }
+
     void PerlinNoise::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
     {
         long seed = input.get_uniform<long, 1>(*seed_socket_);
 
         std::shared_ptr<PerlinNoiseData> data(new PerlinNoiseData);
 
-        data->rng.reset(new boost::random::mt19937);
-        data->rng->seed(seed);
-
         int dimensions = points_socket_->connection()->get().data_type().dimensions();
-        load_hypercube_edge_vectors(*data, dimensions);
+        int period = period_property_->value_or_default<int, 1>().value();
+        load_data(*data, seed, dimensions, period);
 
-        utils::shuffle_group(data->vectors, *data->rng, dimensions);
+        if(offset_socket_->connection())
+        {
+            const ConnectionDataType& offset_type = offset_socket_->connection()->get().data_type();
+            const long long* offset = reinterpret_cast<const long long*>(input.get_uniform_raw(*offset_socket_, offset_type));
+            std::copy(offset, offset + dimensions, data->offset.begin());
+        }
 
         output.set_scratch(0, std::move(data));
     }
 
-    void PerlinNoise::load_hypercube_edge_vectors(PerlinNoiseData &data, int dimensions) const
+    void PerlinNoise::load_data(PerlinNoiseData& data, long seed, int dimensions, int period)
+    {
+        if(period < 0)
+            throw std::invalid_argument("Perlin noise period cannot be negative.");
+        data.period = period;
+        data.offset.assign(dimensions, 0);
+
+        data.rng.reset(new boost::random::mt19937);
+        data.rng->seed(seed);
+
+        load_hypercube_edge_vectors(data, dimensions);
+
+        utils::shuffle_group(data.vectors, *data.rng, dimensions);
+    }
+
+    void PerlinNoise::load_hypercube_edge_vectors(PerlinNoiseData &data, int dimensions)
     {
         switch(dimensions)
         {
@@ -88,140 +300,68 @@ namespace nodes
     void PerlinNoise::execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const
     {
         PerlinNoiseData& data = *output.get_scratch_ref<std::shared_ptr<PerlinNoiseData>>(0);
-        int dimensions = data.dimensions;
-
-        const float* attribute_point = get_input_point_attribute(index, input, dimensions);
-
-        std::vector<int> dimension_starts(dimensions);
-        std::vector<std::vector<int>> points;
-        std::vector<int> gradient_indexes;
-
-        int num_gradients = data.vectors.size() / dimensions;
 
-        // Get floor(x), floor(y), floor(z) etc
-        for(int i = 0; i < dimensions; i++)
-        {
-            dimension_starts[i] = std::floor(attribute_point[i]);
-        }
-
-        // Get all points in the hypercube surrounding the input point
-        get_point_permutations(dimension_starts, dimensions, std::vector<int>(), points);
-
-        // Get all rng gradients for each point. Hash x/y/z to get index into gradients array
-        for(unsigned int i = 0; i < points.size(); i++)
-        {
-            std::vector<int>& point = points[i];
-            unsigned int sum = 0;
-            for(int j = 0; j < dimensions; j++)
-            {
-                static const unsigned int primes[] { 1699, 2237, 2671, 3571, 1949, 2221, 3469, 3083 };
-                sum += point[j] * point[j] * primes[j]; //Hopefully this has enough entropy and random enough results
-            }
+        const ConnectionDataType& points_type = input.get_attribute_type(points_socket_->index());
+        const unsigned char* attribute_point = input.get_attribute_raw(*points_socket_, points_type, index);
 
-            gradient_indexes.push_back(sum % num_gradients);
-        }
+        std::array<float, max_dimensions> gradient;
+        float* gradient_ptr = gradient_socket_ == nullptr ? nullptr : &gradient[0];
 
-        // Because of how the get_point_permutations algorithm works, adjacent verticies are in pairs recursively
-        // There will always be an even number of points (2^n)
-        std::vector<float> out(points.size());
-
-        // vector from the first hypercube vertex to the input point (main diagonal) i.e. uv
-        std::vector<float> uvs(dimensions);
-
-        for(int i = 0; i < dimensions; i++)
-        {
-            uvs[i] = attribute_point[i] - points[0][i];
-        }
-
-        // Number of vertexes for an n-dimensional hypercube is 2^n
-        int num_points = std::pow(2, dimensions);
-
-        // Find dot product for every vertex.
-        // Multiply the vector from the hypercube vertex to the input point, and the gradient at the hypercube vertex
-        for(int i = 0; i < num_points; i++)
-        {
-            std::vector<int>& point = points[i];
-            int gradient_index = gradient_indexes[i] * dimensions;
-
-            // In theory, the dot products will be -1 to 1
-            float dot = 0;
+        float value;
+        if(points_type.is<double>())
+            value = evaluate(data, reinterpret_cast<const double*>(attribute_point), gradient_ptr);
+        else
+            value = evaluate(data, reinterpret_cast<const float*>(attribute_point), gradient_ptr);
 
-            for(int j = 0; j < dimensions; j++)
-            {
-                // gradient value (for this dimension) at hypercube vertex
-                signed char gradient_u = data.vectors[gradient_index + j];
+        output.set_attribute<float, 1>(*output_socket_, index, &value);
 
-                // input point (in this dimension)
-                float attr_p = attribute_point[j];
+        if(gradient_ptr != nullptr)
+            output.set_attribute_raw(*gradient_socket_, gradient_socket_->data_type(), index, reinterpret_cast<const unsigned char*>(gradient_ptr));
+    }
 
-                // vector (for this dimension) from hypercube vertex to input point
-                float u = attr_p - point[j];
+    float PerlinNoise::evaluate(const PerlinNoiseData& data, const float* point, float* gradient)
+    {
+        return evaluate_split(data, point, gradient);
+    }
 
-                dot += u * gradient_u;
-            }
+    float PerlinNoise::evaluate(const PerlinNoiseData& data, const double* point, float* gradient)
+    {
+        return evaluate_split(data, point, gradient);
+    }
 
-            out[i] = dot;
-        }
+    template<typename T>
+    float PerlinNoise::evaluate_split(const PerlinNoiseData& data, const T* point, float* gradient)
+    {
+        // Split into the lattice cell and the position inside it at the input's precision, then add the offset to the cell.
+        // Only the (small) fractional part is ever converted to float, so large world coordinates don't collapse.
+        std::array<long long, max_dimensions> cell;
+        std::array<float, max_dimensions> fraction;
 
-        // Collapse the dimensions down
-        int current_dimension = dimensions;
-        for(; num_points > 1; num_points /= 2)
+        for(int i = 0; i < data.dimensions; i++)
         {
-            // Take the dot products two at a time and interpolate between then
-            int half_num = num_points / 2;
-            for(int i = 0; i < half_num; i++)
-            {
-                int index = i * 2;
-
-                float x_1 = out[index];
-                float x_2 = out[index + 1];
-
-                float u = uvs[current_dimension - 1];
-                float interpolated = 6 * std::pow(u, 5) - (15 * std::pow(u, 4)) + (10 * std::pow(u, 3));
-
-                out[i] = (x_1 * (1.0f - interpolated)) + (x_2 * interpolated);
-            }
-
-            current_dimension--;
+            T start = std::floor(point[i]);
+            cell[i] = static_cast<long long>(start) + data.offset[i];
+            fraction[i] = static_cast<float>(point[i] - start);
         }
 
-        output.set_attribute<float, 1>(*output_socket_, index, &out[0]);
+        return evaluate_lattice(data, &cell[0], &fraction[0], gradient);
     }
 
-    const float* PerlinNoise::get_input_point_attribute(DataBuffer::size_type index, const CompositeDataBuffer& input, int dimensions) const
+    float PerlinNoise::evaluate_lattice(const PerlinNoiseData& data, const long long* cell, const float* fraction, float* gradient)
     {
-        switch(dimensions)
+        switch(data.dimensions)
         {
             case 2:
-                return &input.get_attribute<float, 2>(*points_socket_, index);
+                return evaluate_lattice_fixed<2>(data, cell, fraction, gradient);
             case 3:
-                return &input.get_attribute<float, 3>(*points_socket_, index);
+                return evaluate_lattice_fixed<3>(data, cell, fraction, gradient);
             case 4:
-                return &input.get_attribute<float, 4>(*points_socket_, index);
+                return evaluate_lattice_fixed<4>(data, cell, fraction, gradient);
             case 5:
-                return &input.get_attribute<float, 5>(*points_socket_, index);
+                return evaluate_lattice_fixed<5>(data, cell, fraction, gradient);
             case 6:
-                return &input.get_attribute<float, 7>(*points_socket_, index);
+                return evaluate_lattice_fixed<6>(data, cell, fraction, gradient);
         }
         throw std::logic_error("Not supported");
     }
-
-    void PerlinNoise::get_point_permutations(std::vector<int>& dimension_starts, int dimensions, std::vector<int> point, std::vector<std::vector<int>>& points)
-    {
-        int dimension = point.size();
-        if(dimension == dimensions)
-        {
-            points.push_back(point);
-        }
-        else
-        {
-            int start = dimension_starts[dimension];
-
-            point.push_back(start);
-            get_point_permutations(dimension_starts, dimensions, point, points);
-
-            point[dimension] = start + 1;
-            get_point_permutations(dimension_starts, dimensions, point, points);
-        }
-    }
 } }
@@ -2,122 +2,181 @@
 #define PERLIN_NOISE_H
 
 #include "graph_node.h"
+#include <array>
 #include <memory>
+#include <boost/random/mersenne_twister.hpp>
 #include "input_socket.h"
 #include "output_socket.h"
+#include "utils.h"
 
 namespace noises {
 namespace nodes
 {
-    struct PerlinNoiseData;
+    /** Seeded gradient table shared by every point a noise node evaluates. Built once per execution in execute_uniforms. **/
+    struct PerlinNoiseData
+    {
+        PerlinNoiseData() : dimensions(0), period(0) { }
+
+        std::unique_ptr<boost::random::mt19937> rng;
+
+        std::vector<signed char> vectors;
+
+        int dimensions;
+
+        // Lattice coordinates are wrapped modulo this before hashing so the noise tiles. 0 doesn't wrap.
+        int period;
+
+        // Whole lattice cells added to each point (one per dimension) before it is split into cell and fraction
+        std::vector<long long> offset;
+    };
 
     class PerlinNoise : public GraphNode
     {
     public:
+        /** The largest number of dimensions of Points. **/
+        static const int max_dimensions = 6;
+
         PerlinNoise();
 
         std::string node_name() const;
 
         void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
         void execute_attributes(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type index) const;
+        bool is_elementwise() const;
+
+        void recalculate_sockets();
+        void validate(ValidationResults& results) const;
+
+        /** Adds or removes the Gradient output, which holds the analytic derivative of the noise at each point. **/
+        void set_output_gradient(bool output_gradient);
+
+        void set_period(int period);
+
+        /** Seeds and shuffles the gradient table for {dimensions}-dimensional noise. A non-zero {period} makes the noise repeat every {period} units on each axis. **/
+        static void load_data(PerlinNoiseData& data, long seed, int dimensions, int period = 0);
+
+        /** Evaluates the noise at {point}, which has data.dimensions components. If {gradient} is not null the analytic derivative is written to it. **/
+        static float evaluate(const PerlinNoiseData& data, const float* point, float* gradient = nullptr);
+        static float evaluate(const PerlinNoiseData& data, const double* point, float* gradient = nullptr);
+
+        /** Evaluates the noise at a point already split into its lattice {cell} (data.offset is not added) and the {fraction} (0 to 1) inside that cell. **/
+        static float evaluate_lattice(const PerlinNoiseData& data, const long long* cell, const float* fraction, float* gradient = nullptr);
 
     private:
-        void load_hypercube_edge_vectors(PerlinNoiseData& data, int dimensions) const;
+        template<typename T>
+        static float evaluate_split(const PerlinNoiseData& data, const T* point, float* gradient);
 
-        static void get_point_permutations(std::vector<int>& dimension_starts, int dimensions, std::vector<int> point, std::vector<std::vector<int>>& points);
-        const float* get_input_point_attribute(DataBuffer::size_type index, const CompositeDataBuffer& input, int dimensions) const;
+        static void load_hypercube_edge_vectors(PerlinNoiseData& data, int dimensions);
 
         InputSocket* seed_socket_;
         InputSocket* points_socket_;
+        InputSocket* offset_socket_;
         OutputSocket* output_socket_;
+        OutputSocket* gradient_socket_;
+        Property* gradient_property_;
+        Property* period_property_;
     };
 
+    /** Vectors which point to every edge of an N-Dimensional hypercube, generated at compile time.
+        Edges are grouped by which component is 0, then the other components count through -1/1 with the first being the most significant. **/
     template<unsigned int N>
     class HypercubeEdges
     {
     public:
+        /** Number of edges (N * 2^(N-1)). **/
+        static constexpr std::size_t count = N * (std::size_t(1) << (N - 1));
+
+        /** Component {component} of edge {edge}. **/
+        static constexpr signed char value(std::size_t edge, unsigned int component)
+        {
+            return component == edge / (std::size_t(1) << (N - 1)) ? 0 :
+                   (((edge % (std::size_t(1) << (N - 1))) >> (N - 2 - (component < edge / (std::size_t(1) << (N - 1)) ? component : component - 1))) & 1) ? 1 : -1;
+        }
+
+        /** Entry {index} of the edges laid end to end (xyzxyzxyz). **/
+        static constexpr signed char flattened_value(std::size_t index)
+        {
+            return value(index / N, index % N);
+        }
+
+        /** The edges laid end to end, count * N long. **/
+        static const signed char* flattened();
+
         static std::vector<signed char> edge_vectors_flattened();
         static std::vector<std::array<signed char, N>> edge_vectors();
-        static std::vector<std::array<signed char, N>> get_permutations_no_zero();
     };
 
-    template<unsigned int N, unsigned int NCurrent>
-    class HypercubeEdges_Permutations
+    /** Offsets (0 or 1 per component) of every vertex of an N-Dimensional hypercube, generated at compile time.
+        Adjacent vertices differ in the last component, pairs of pairs in the second to last, and so on. **/
+    template<unsigned int N>
+    class HypercubeCorners
     {
     public:
-        static void add_permutations(std::array<signed char, N> a,  std::vector<std::array<signed char, N>>& out)
+        /** Number of vertices (2^N). **/
+        static constexpr std::size_t count = std::size_t(1) << N;
+
+        static constexpr unsigned char value(std::size_t corner, unsigned int component)
         {
-            a[N - NCurrent] = -1;
-            HypercubeEdges_Permutations<N, NCurrent - 1>::add_permutations(a, out);
+            return (corner >> (N - 1 - component)) & 1;
+        }
 
-            a[N - NCurrent] = 1;
-            HypercubeEdges_Permutations<N, NCurrent - 1>::add_permutations(a, out);
+        static constexpr unsigned char flattened_value(std::size_t index)
+        {
+            return value(index / N, index % N);
         }
+
+        /** The vertex offsets laid end to end, count * N long. **/
+        static const unsigned char* flattened();
     };
 
-    template<unsigned int N>
-    class HypercubeEdges_Permutations<N, 0>
+    template<typename Table, typename T, typename Sequence>
+    struct HypercubeTableStorage;
+
+    template<typename Table, typename T, std::size_t... Indexes>
+    struct HypercubeTableStorage<Table, T, utils::index_sequence<Indexes...>>
     {
-    public:
-        static void add_permutations(std::array<signed char, N> a, std::vector<std::array<signed char, N>>& out)
-        {
-            out.push_back(a);
-        }
+        static constexpr T values[sizeof...(Indexes)] = { Table::flattened_value(Indexes)... };
     };
 
+    template<typename Table, typename T, std::size_t... Indexes>
+    constexpr T HypercubeTableStorage<Table, T, utils::index_sequence<Indexes...>>::values[sizeof...(Indexes)];
+
     template<unsigned int N>
-    std::vector<signed char> HypercubeEdges<N>::edge_vectors_flattened()
+    constexpr std::size_t HypercubeEdges<N>::count;
+
+    template<unsigned int N>
+    constexpr std::size_t HypercubeCorners<N>::count;
+
+    template<unsigned int N>
+    const signed char* HypercubeEdges<N>::flattened()
     {
-        std::vector<std::array<signed char, N>> vectors(HypercubeEdges<N>::edge_vectors());
-        std::vector<signed char> out;
+        return HypercubeTableStorage<HypercubeEdges<N>, signed char, utils::make_index_sequence<count * N>>::values;
+    }
 
-        for(auto it = vectors.begin(); it != vectors.end(); it++)
-        {
-            out.insert(out.end(), it->begin(), it->end());
-        }
+    template<unsigned int N>
+    const unsigned char* HypercubeCorners<N>::flattened()
+    {
+        return HypercubeTableStorage<HypercubeCorners<N>, unsigned char, utils::make_index_sequence<count * N>>::values;
+    }
 
-        return out;
+    template<unsigned int N>
+    std::vector<signed char> HypercubeEdges<N>::edge_vectors_flattened()
+    {
+        return std::vector<signed char>(flattened(), flattened() + count * N);
     }
 
-    /** Gets vectors which point to every edge of an N-Dimensional hypercube.  */
     template<unsigned int N>
     std::vector<std::array<signed char, N>> HypercubeEdges<N>::edge_vectors()
     {
-        std::vector<std::array<signed char, N>> out;
+        std::vector<std::array<signed char, N>> out(count);
 
-        std::vector<std::array<signed char, N - 1>> without_zero = HypercubeEdges<N - 1>::get_permutations_no_zero();
-
-        // Put the 0 at each position in the array
-        for(unsigned int i = 0; i < N; i++)
+        for(std::size_t i = 0; i < count; i++)
         {
-            // Using all permutations without the zero
-            for(std::size_t j = 0; j < without_zero.size(); j++)
-            {
-                std::array<signed char, N - 1>& without = without_zero[j];
-                std::array<signed char, N> a;
-                a[i] = 0;
-
-                for(unsigned int q = 0, p = 0; q < N - 1; q++, p++)
-                {
-                    if(q == i)
-                        p++;
-                    a[p] = without[q];
-                }
-
-                out.push_back(a);
-            }
+            std::copy(flattened() + i * N, flattened() + (i + 1) * N, out[i].begin());
         }
 
         return out;
     }
-
-    template<unsigned int N>
-    std::vector<std::array<signed char, N>> HypercubeEdges<N>::get_permutations_no_zero()
-    {
-        std::vector<std::array<signed char, N>> out;
-        HypercubeEdges_Permutations<N, N>::add_permutations(std::array<signed char, N>(), out);
-        return out;
-    }
 } }
 
 #endif // PERLIN_NOISE_H
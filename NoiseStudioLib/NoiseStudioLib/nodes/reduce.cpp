@@ -0,0 +1,189 @@
+#include "reduce.h"
+
+#include <type_traits>
+#include <vector>
+
+#include "composite_data_buffer.h"
+#include "validation_results.h"
+#include "parallel.h"
+
+namespace
+{
+    template<typename T>
+    struct ReducePartial
+    {
+        // Sums are accumulated as double (long long for integer types) so large attributes don't lose precision
+        typedef typename std::conditional<std::is_integral<T>::value, long long, double>::type Accumulator;
+
+        std::size_t count;
+        std::vector<T> min;
+        std::vector<T> max;
+        std::vector<Accumulator> sum;
+    };
+
+    template<typename T>
+    ReducePartial<T> reduce_range(const T* data, std::size_t dimensions, std::size_t begin, std::size_t end)
+    {
+        ReducePartial<T> partial;
+        partial.count = end - begin;
+        partial.min.assign(data + begin * dimensions, data + (begin + 1) * dimensions);
+        partial.max = partial.min;
+        partial.sum.assign(dimensions, 0);
+
+        for(std::size_t index = begin; index < end; index++)
+        {
+            const T* element = data + index * dimensions;
+
+            for(std::size_t component = 0; component < dimensions; component++)
+            {
+                T value = element[component];
+                partial.min[component] = value < partial.min[component] ? value : partial.min[component];
+                partial.max[component] = value > partial.max[component] ? value : partial.max[component];
+                partial.sum[component] += value;
+            }
+        }
+
+        return partial;
+    }
+
+    template<typename T>
+    ReducePartial<T> combine(const ReducePartial<T>& left, const ReducePartial<T>& right)
+    {
+        if(left.count == 0)
+            return right;
+        if(right.count == 0)
+            return left;
+
+        ReducePartial<T> combined = left;
+        combined.count += right.count;
+
+        for(std::size_t component = 0; component < combined.min.size(); component++)
+        {
+            combined.min[component] = right.min[component] < combined.min[component] ? right.min[component] : combined.min[component];
+            combined.max[component] = right.max[component] > combined.max[component] ? right.max[component] : combined.max[component];
+            combined.sum[component] += right.sum[component];
+        }
+
+        return combined;
+    }
+}
+
+namespace noises {
+namespace nodes
+{
+    const std::size_t Reduce::chunk_size;
+
+    Reduce::Reduce() :
+        input_socket_(nullptr), min_socket_(nullptr), max_socket_(nullptr), sum_socket_(nullptr), mean_socket_(nullptr)
+    {
+        input_socket_ = &inputs().add("Input", SocketType::attribute);
+        input_socket_->set_accepts(ConnectionDataType::any()); // Checked in validate
+
+        min_socket_ = &outputs().add("Min", ConnectionDataType::undefined(), SocketType::uniform);
+        max_socket_ = &outputs().add("Max", ConnectionDataType::undefined(), SocketType::uniform);
+        sum_socket_ = &outputs().add("Sum", ConnectionDataType::undefined(), SocketType::uniform);
+        mean_socket_ = &outputs().add("Mean", ConnectionDataType::undefined(), SocketType::uniform);
+    }
+
+    std::string Reduce::node_name() const
+    {
+        return "Reduce";
+    }
+
+    bool Reduce::is_pure() const
+    {
+        return true;
+    }
+
+    void Reduce::recalculate_sockets()
+    {
+        if(mean_socket_ == nullptr)
+            return; // Still initializing
+
+        auto connection = input_socket_->connection();
+        const ConnectionDataType& data_type = connection ? connection->get().data_type() : ConnectionDataType::undefined();
+
+        min_socket_->set_data_type(data_type);
+        max_socket_->set_data_type(data_type);
+        sum_socket_->set_data_type(data_type);
+        mean_socket_->set_data_type(data_type);
+    }
+
+    template<typename T>
+    void Reduce::reduce(const CompositeDataBuffer& input, DataBuffer& output) const
+    {
+        const ConnectionDataType& data_type = input_socket_->connection()->get().data_type();
+        std::size_t dimensions = data_type.dimensions();
+
+        auto attribute = input.get_attribute_all_raw(*input_socket_, data_type);
+        const T* data = reinterpret_cast<const T*>(std::get<0>(attribute));
+        std::size_t length = std::get<1>(attribute) / data_type.size_full();
+
+        ReducePartial<T> identity;
+        identity.count = 0;
+
+        ReducePartial<T> result = parallel_reduce(length, chunk_size, identity,
+            [data, dimensions](std::size_t begin, std::size_t end) { return reduce_range(data, dimensions, begin, end); },
+            [](const ReducePartial<T>& left, const ReducePartial<T>& right) { return combine(left, right); });
+
+        // An empty attribute reduces to zeros
+        std::vector<T> min(dimensions, static_cast<T>(0));
+        std::vector<T> max(dimensions, static_cast<T>(0));
+        std::vector<T> sum(dimensions, static_cast<T>(0));
+        std::vector<T> mean(dimensions, static_cast<T>(0));
+
+        if(result.count > 0)
+        {
+            min = result.min;
+            max = result.max;
+
+            for(std::size_t component = 0; component < dimensions; component++)
+            {
+                sum[component] = static_cast<T>(result.sum[component]);
+                mean[component] = static_cast<T>(result.sum[component] / static_cast<typename ReducePartial<T>::Accumulator>(result.count));
+            }
+        }
+
+        output.set_uniform_raw(*min_socket_, data_type, reinterpret_cast<const unsigned char*>(min.data()));
+        output.set_uniform_raw(*max_socket_, data_type, reinterpret_cast<const unsigned char*>(max.data()));
+        output.set_uniform_raw(*sum_socket_, data_type, reinterpret_cast<const unsigned char*>(sum.data()));
+        output.set_uniform_raw(*mean_socket_, data_type, reinterpret_cast<const unsigned char*>(mean.data()));
+    }
+
+    void Reduce::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
+    {
+        const ConnectionDataType& data_type = input_socket_->connection()->get().data_type();
+
+        if(data_type.is<int>())
+        {
+            reduce<int>(input, output);
+        }
+        else if(data_type.is<float>())
+        {
+            reduce<float>(input, output);
+        }
+        else if(data_type.is<double>())
+        {
+            reduce<double>(input, output);
+        }
+    }
+
+    void Reduce::execute_attribute_range(const CompositeDataBuffer&, DataBuffer&, DataBuffer::size_type, DataBuffer::size_type) const
+    {
+        // Everything is done in execute_uniforms
+    }
+
+    void Reduce::validate(ValidationResults &results) const
+    {
+        auto connection = input_socket_->connection();
+        if(!connection)
+            return; // Validation will be handled by the global validator
+
+        const ConnectionDataType& data_type = connection->get().data_type();
+
+        if((data_type.is<int>() || data_type.is<float>() || data_type.is<double>()) == false || data_type.dimensions() == 0)
+        {
+            results.add("Reduce only supports int, float or double attributes.");
+        }
+    }
+} }
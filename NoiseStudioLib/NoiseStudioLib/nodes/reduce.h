@@ -0,0 +1,43 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <cstddef>
+
+#include "graph_node.h"
+
+namespace noises {
+namespace nodes
+{
+    // Reduces an attribute to uniforms: the smallest, largest, total and average of each component. E.g. the Min and Max of a
+    // heightmap can normalize it in the same execution.
+    class Reduce : public GraphNode
+    {
+    public:
+        /** Number of attribute values in each partial result. The partial results are calculated in parallel. **/
+        static const std::size_t chunk_size = 16384;
+
+        Reduce();
+
+        std::string node_name() const;
+
+        void recalculate_sockets();
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+
+        void validate(ValidationResults& results) const;
+
+        bool is_pure() const;
+
+    private:
+        template<typename T>
+        void reduce(const CompositeDataBuffer& input, DataBuffer& output) const;
+
+        InputSocket* input_socket_;
+        OutputSocket* min_socket_;
+        OutputSocket* max_socket_;
+        OutputSocket* sum_socket_;
+        OutputSocket* mean_socket_;
+    };
+} }
+
+#endif // REDUCE_H
@@ -0,0 +1,271 @@
+#include "sample.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "composite_data_buffer.h"
+#include "parallel.h"
+#include "whole_grid.h"
+
+namespace
+{
+    using noises::nodes::clamp_index;
+
+    // Each filter reads count x count pixels, starting at floor(position + offset()) + first along each axis, weighted by weights(t)
+    // where t is how far the position is past that floor
+    struct NearestTaps
+    {
+        static const int count = 1;
+        static const int first = 0;
+
+        // Rounds instead of flooring
+        static float offset() { return 0.5f; }
+
+        static void weights(float, float (&w)[1])
+        {
+            w[0] = 1.0f;
+        }
+    };
+
+    struct BilinearTaps
+    {
+        static const int count = 2;
+        static const int first = 0;
+
+        static float offset() { return 0.0f; }
+
+        static void weights(float t, float (&w)[2])
+        {
+            w[0] = 1.0f - t;
+            w[1] = t;
+        }
+    };
+
+    struct BicubicTaps
+    {
+        static const int count = 4;
+        static const int first = -1;
+
+        static float offset() { return 0.0f; }
+
+        // Catmull-Rom
+        static void weights(float t, float (&w)[4])
+        {
+            w[0] = t * (-0.5f + t * (1.0f - 0.5f * t));
+            w[1] = 1.0f + t * t * (-2.5f + 1.5f * t);
+            w[2] = t * (0.5f + t * (2.0f - 1.5f * t));
+            w[3] = t * t * (-0.5f + 0.5f * t);
+        }
+    };
+
+    // Points far outside the grid (or NaN) read the same edge pixels as points just outside it, without overflowing the integer index
+    inline float clamp_position(float position, std::size_t size)
+    {
+        const float low = -2.0f;
+        const float high = static_cast<float>(size) + 1.0f;
+        position = position >= low ? position : low;
+        return position <= high ? position : high;
+    }
+
+    /** Samples {count} points, a block at a time. The positions for a whole block are worked out first in a loop that vectorizes, then
+     *  the pixels are gathered and weighted. {scale} and {offset} turn a point into a pixel position. **/
+    template<typename Taps, unsigned int Channels>
+    void sample_points(const float* grid, std::size_t width, std::size_t height, const float* points, float* out, std::size_t count,
+                       float scale_x, float scale_y, float offset_x, float offset_y)
+    {
+        const std::size_t block_size = 256;
+        int x_base[block_size];
+        int y_base[block_size];
+        float x_fraction[block_size];
+        float y_fraction[block_size];
+
+        for(std::size_t block_begin = 0; block_begin < count; block_begin += block_size)
+        {
+            const std::size_t block = std::min(block_size, count - block_begin);
+            const float* block_points = points + block_begin * 2;
+
+            for(std::size_t i = 0; i < block; i++)
+            {
+                float x = clamp_position(block_points[i * 2] * scale_x + offset_x + Taps::offset(), width);
+                float y = clamp_position(block_points[i * 2 + 1] * scale_y + offset_y + Taps::offset(), height);
+
+                float x_floor = std::floor(x);
+                float y_floor = std::floor(y);
+                x_base[i] = static_cast<int>(x_floor);
+                y_base[i] = static_cast<int>(y_floor);
+                x_fraction[i] = x - x_floor;
+                y_fraction[i] = y - y_floor;
+            }
+
+            for(std::size_t i = 0; i < block; i++)
+            {
+                float x_weights[Taps::count];
+                float y_weights[Taps::count];
+                Taps::weights(x_fraction[i], x_weights);
+                Taps::weights(y_fraction[i], y_weights);
+
+                std::size_t columns[Taps::count];
+                std::size_t rows[Taps::count];
+                for(int tap = 0; tap < Taps::count; tap++)
+                {
+                    columns[tap] = clamp_index(x_base[i] + Taps::first + tap, width);
+                    rows[tap] = clamp_index(y_base[i] + Taps::first + tap, height) * width;
+                }
+
+                float sum[Channels] = { };
+                for(int row = 0; row < Taps::count; row++)
+                {
+                    for(int column = 0; column < Taps::count; column++)
+                    {
+                        const float weight = y_weights[row] * x_weights[column];
+                        const float* pixel = grid + (rows[row] + columns[column]) * Channels;
+
+                        for(unsigned int channel = 0; channel < Channels; channel++)
+                        {
+                            sum[channel] += weight * pixel[channel];
+                        }
+                    }
+                }
+
+                float* result = out + (block_begin + i) * Channels;
+                for(unsigned int channel = 0; channel < Channels; channel++)
+                {
+                    result[channel] = sum[channel];
+                }
+            }
+        }
+    }
+}
+
+namespace noises {
+namespace nodes
+{
+    Sample::Sample() :
+        grid_socket_(nullptr),
+        points_socket_(nullptr),
+        output_socket_(nullptr),
+        filter_property_(nullptr),
+        coordinates_property_(nullptr)
+    {
+        grid_socket_ = &inputs().add("Grid", SocketType::attribute);
+        grid_socket_->set_accepts(ConnectionDataType::value<float, 1>());
+        grid_socket_->set_accepts(ConnectionDataType::value<float, 2>());
+        grid_socket_->set_accepts(ConnectionDataType::value<float, 3>());
+        grid_socket_->set_accepts(ConnectionDataType::value<float, 4>());
+        grid_socket_->set_independent_length(true);
+
+        points_socket_ = &inputs().add("Points", SocketType::attribute);
+        points_socket_->set_accepts(ConnectionDataType::value<float, 2>());
+
+        output_socket_ = &outputs().add("Output", ConnectionDataType::undefined(), SocketType::attribute);
+
+        filter_property_ = &add_property<int, 1>("Filter");
+        int default_filter = static_cast<int>(SampleFilter::bilinear);
+        filter_property_->set_default_value<int, 1>(&default_filter);
+
+        coordinates_property_ = &add_property<int, 1>("Coordinates");
+        int default_coordinates = static_cast<int>(SampleCoordinates::unit_square);
+        coordinates_property_->set_default_value<int, 1>(&default_coordinates);
+    }
+
+    std::string Sample::node_name() const
+    {
+        return "Sample";
+    }
+
+    bool Sample::is_pure() const
+    {
+        return true;
+    }
+
+    void Sample::recalculate_sockets()
+    {
+        if(output_socket_ == nullptr)
+            return; // Still initializing
+
+        auto connection = grid_socket_->connection();
+        output_socket_->set_data_type(connection ? connection->get().data_type() : ConnectionDataType::undefined());
+    }
+
+    void Sample::set_filter(SampleFilter filter)
+    {
+        int value = static_cast<int>(filter);
+        filter_property_->set_value<int, 1>(&value);
+    }
+
+    void Sample::set_coordinates(SampleCoordinates coordinates)
+    {
+        int value = static_cast<int>(coordinates);
+        coordinates_property_->set_value<int, 1>(&value);
+    }
+
+    void Sample::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
+    {
+        // The points can come in chunks, but they can read any pixel of the grid
+        output.set_scratch<WholeGrid>(0, WholeGrid(input.attribute_info(*grid_socket_), "Sample"));
+    }
+
+    void Sample::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        switch(grid_socket_->connection()->get().data_type().dimensions())
+        {
+        case 1:
+            sample<1>(input, output, begin, end);
+            break;
+        case 2:
+            sample<2>(input, output, begin, end);
+            break;
+        case 3:
+            sample<3>(input, output, begin, end);
+            break;
+        case 4:
+            sample<4>(input, output, begin, end);
+            break;
+        }
+    }
+
+    void Sample::execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
+
+    template<unsigned int Channels>
+    void Sample::sample(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        const WholeGrid grid_size = output.get_scratch<WholeGrid>(0);
+        if(grid_size.empty())
+            return;
+
+        const std::size_t width = grid_size.width;
+        const std::size_t height = grid_size.height;
+
+        const ConnectionDataType& grid_type = grid_socket_->connection()->get().data_type();
+        const float* grid = reinterpret_cast<const float*>(std::get<0>(input.get_attribute_all_raw(*grid_socket_, grid_type)));
+        const float* points = reinterpret_cast<const float*>(std::get<0>(input.get_attribute_all_raw(*points_socket_, ConnectionDataType::value<float, 2>())));
+        float* out = reinterpret_cast<float*>(output.get_attribute_all_raw(*output_socket_, grid_type));
+
+        // Pixel x of a grid w wide is at 2x/w - 1 in UnitSquareMapping's space
+        float scale_x = 1.0f, scale_y = 1.0f, offset_x = 0.0f, offset_y = 0.0f;
+        if(static_cast<SampleCoordinates>(coordinates_property_->value_or_default<int, 1>().value()) == SampleCoordinates::unit_square)
+        {
+            scale_x = offset_x = static_cast<float>(width) * 0.5f;
+            scale_y = offset_y = static_cast<float>(height) * 0.5f;
+        }
+
+        SampleFilter filter = static_cast<SampleFilter>(filter_property_->value_or_default<int, 1>().value());
+
+        parallel_for(end - begin, points_per_task, [&](std::size_t range_begin, std::size_t range_end)
+        {
+            const float* range_points = points + (begin + range_begin) * 2;
+            float* range_out = out + (begin + range_begin) * Channels;
+            std::size_t count = range_end - range_begin;
+
+            if(filter == SampleFilter::nearest)
+                sample_points<NearestTaps, Channels>(grid, width, height, range_points, range_out, count, scale_x, scale_y, offset_x, offset_y);
+            else if(filter == SampleFilter::bicubic)
+                sample_points<BicubicTaps, Channels>(grid, width, height, range_points, range_out, count, scale_x, scale_y, offset_x, offset_y);
+            else
+                sample_points<BilinearTaps, Channels>(grid, width, height, range_points, range_out, count, scale_x, scale_y, offset_x, offset_y);
+        });
+    }
+} }
@@ -0,0 +1,64 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <cstddef>
+
+#include "graph_node.h"
+
+namespace noises {
+namespace nodes
+{
+    enum class SampleFilter
+    {
+        nearest,
+        bilinear,
+
+        // Catmull-Rom, which goes through the pixel values and reproduces quadratics exactly
+        bicubic
+    };
+
+    enum class SampleCoordinates
+    {
+        // The space UnitSquareMapping puts a grid in, so a grid of any size lines up with a finer one made the same way
+        unit_square,
+
+        // Pixel positions, with pixel (x, y) at (x, y)
+        pixels
+    };
+
+    // Reads a 2D grid (e.g. from BlankGrid) at arbitrary points, so something can be made on a coarse grid and resampled onto a finer
+    // one. Points past the edges read the edge pixels. The grid doesn't have to be the same length as the points.
+    class Sample : public GraphNode
+    {
+    public:
+        /** Number of points each thread takes at a time. **/
+        static const std::size_t points_per_task = 4096;
+
+        Sample();
+
+        std::string node_name() const;
+
+        void recalculate_sockets();
+        void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+        void execute_attributes(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type index) const;
+
+        bool is_pure() const;
+
+        void set_filter(SampleFilter filter);
+        void set_coordinates(SampleCoordinates coordinates);
+
+    private:
+        template<unsigned int Channels>
+        void sample(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+
+        InputSocket* grid_socket_;
+        InputSocket* points_socket_;
+        OutputSocket* output_socket_;
+
+        Property* filter_property_;
+        Property* coordinates_property_;
+    };
+} }
+
+#endif // SAMPLE_H
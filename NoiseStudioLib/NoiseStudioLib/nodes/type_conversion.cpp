@@ -6,7 +6,8 @@ namespace noises {
 namespace nodes {
 
     template<typename TSource, typename TTarget>
-    void change_type(const CompositeDataBuffer& input, DataBuffer& output, SocketType type, InputSocket& input_socket, OutputSocket& output_socket)
+    void change_type(const CompositeDataBuffer& input, DataBuffer& output, SocketType type, InputSocket& input_socket, OutputSocket& output_socket,
+                     DataBuffer::size_type begin, DataBuffer::size_type end)
     {
         const Connection& connection = *input_socket.connection();
         const ConnectionDataType& input_type = connection.data_type();
@@ -15,31 +16,29 @@ namespace nodes {
         assert(output_socket.data_type().is<TTarget>());
         assert(input_type.dimensions() == output_socket.data_type().dimensions());
 
+        std::size_t dimensions = input_type.dimensions();
+
         if(type == SocketType::attribute)
         {
+            // Converts [begin, end) straight into the output so the node can run a chunk at a time
             std::tuple<const unsigned char*, std::size_t> input_data = input.get_attribute_all_raw(input_socket, input_type);
             const TSource* source = reinterpret_cast<const TSource*>(std::get<0>(input_data));
-            std::size_t source_length = std::get<1>(input_data) / sizeof(TSource);
+            TTarget* target = reinterpret_cast<TTarget*>(output.get_attribute_all_raw(output_socket, output_socket.data_type()));
 
-            std::vector<TTarget> out;
-            out.reserve(sizeof(TTarget) *  source_length);
-            for(std::size_t i = 0; i < source_length; i++)
+            for(std::size_t i = begin * dimensions; i < end * dimensions; i++)
             {
-                out.push_back(static_cast<TTarget>(source[i]));
+                target[i] = static_cast<TTarget>(source[i]);
             }
-
-            output.set_attribute_all_raw(output_socket, output_socket.data_type(), reinterpret_cast<const unsigned char*>(out.data()), out.size() * sizeof(TTarget));
         }
         else //if(type == SocketType::uniform)
         {
             const unsigned char* input_data = input.get_uniform_raw(input_socket, input_socket.connection()->get().data_type());
-            std::size_t source_length = input_type.dimensions();
             const TSource* source = reinterpret_cast<const TSource*>(input_data);
 
             std::vector<TTarget> out;
-            out.reserve(sizeof(TTarget) * input_type.dimensions());
+            out.reserve(dimensions);
 
-            for(std::size_t i = 0; i < source_length; i++)
+            for(std::size_t i = 0; i < dimensions; i++)
             {
                 out.push_back(static_cast<TTarget>(source[i]));
             }
@@ -49,33 +48,34 @@ namespace nodes {
     }
 
     template<typename TSource>
-    void change_type(const CompositeDataBuffer &input, DataBuffer &output, SocketType socket_type, InputSocket &input_socket, OutputSocket &output_socket)
+    void change_type(const CompositeDataBuffer &input, DataBuffer &output, SocketType socket_type, InputSocket &input_socket, OutputSocket &output_socket,
+                     DataBuffer::size_type begin, DataBuffer::size_type end)
     {
         const ConnectionDataType& output_type = output_socket.data_type();
 
         if(output_type.is<int>())
         {
-            change_type<TSource, int>(input, output, socket_type, input_socket, output_socket);
+            change_type<TSource, int>(input, output, socket_type, input_socket, output_socket, begin, end);
         }
         else if(output_type.is<long>())
         {
-            change_type<TSource, long>(input, output, socket_type, input_socket, output_socket);
+            change_type<TSource, long>(input, output, socket_type, input_socket, output_socket, begin, end);
         }
         else if(output_type.is<float>())
         {
-            change_type<TSource, float>(input, output, socket_type, input_socket, output_socket);
+            change_type<TSource, float>(input, output, socket_type, input_socket, output_socket, begin, end);
         }
         else if(output_type.is<double>())
         {
-            change_type<TSource, double>(input, output, socket_type, input_socket, output_socket);
+            change_type<TSource, double>(input, output, socket_type, input_socket, output_socket, begin, end);
         }
         else if(output_type.is<unsigned char>())
         {
-            change_type<TSource, unsigned char>(input, output, socket_type, input_socket, output_socket);
+            change_type<TSource, unsigned char>(input, output, socket_type, input_socket, output_socket, begin, end);
         }
         else if(output_type.is<unsigned int>())
         {
-            change_type<TSource, unsigned int>(input, output, socket_type, input_socket, output_socket);
+            change_type<TSource, unsigned int>(input, output, socket_type, input_socket, output_socket, begin, end);
         }
     }
 
@@ -107,6 +107,32 @@ namespace nodes {
     }
 
     void TypeConversion::execute_uniforms(const CompositeDataBuffer &input, DataBuffer &output) const
+    {
+        if(output_socket_->type() == SocketType::attribute)
+            return; // Handled in execute_attribute_range
+
+        convert(input, output, 0, 1);
+    }
+
+    void TypeConversion::execute_attribute_range(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
+    {
+        if(output_socket_->type() == SocketType::uniform)
+            return; // Handled in execute_uniforms
+
+        convert(input, output, begin, end);
+    }
+
+    void TypeConversion::execute_attributes(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type index) const
+    {
+        execute_attribute_range(input, output, index, index + 1);
+    }
+
+    bool TypeConversion::is_elementwise() const
+    {
+        return true;
+    }
+
+    void TypeConversion::convert(const CompositeDataBuffer &input, DataBuffer &output, DataBuffer::size_type begin, DataBuffer::size_type end) const
     {
         if(!input_socket_->connection())
             throw std::invalid_argument("Missing input connection");
@@ -117,27 +143,27 @@ namespace nodes {
 
         if(input_type.is<int>())
         {
-            change_type<int>(input, output, socket_type, *input_socket_, *output_socket_);
+            change_type<int>(input, output, socket_type, *input_socket_, *output_socket_, begin, end);
         }
         else if(input_type.is<long>())
         {
-            change_type<long>(input, output, socket_type, *input_socket_, *output_socket_);
+            change_type<long>(input, output, socket_type, *input_socket_, *output_socket_, begin, end);
         }
         else if(input_type.is<float>())
         {
-            change_type<float>(input, output, socket_type, *input_socket_, *output_socket_);
+            change_type<float>(input, output, socket_type, *input_socket_, *output_socket_, begin, end);
         }
         else if(input_type.is<double>())
         {
-            change_type<double>(input, output, socket_type, *input_socket_, *output_socket_);
+            change_type<double>(input, output, socket_type, *input_socket_, *output_socket_, begin, end);
         }
         else if(input_type.is<unsigned char>())
         {
-            change_type<unsigned char>(input, output, socket_type, *input_socket_, *output_socket_);
+            change_type<unsigned char>(input, output, socket_type, *input_socket_, *output_socket_, begin, end);
         }
         else if(input_type.is<unsigned int>())
         {
-            change_type<unsigned int>(input, output, socket_type, *input_socket_, *output_socket_);
+            change_type<unsigned int>(input, output, socket_type, *input_socket_, *output_socket_, begin, end);
         }
     }
 
@@ -24,6 +24,9 @@ namespace nodes {
         std::string node_name() const;
 
         void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
+        void execute_attribute_range(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
+        void execute_attributes(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type index) const;
+        bool is_elementwise() const;
         void recalculate_sockets();
 
         void set_type(TypeConversionTargetType type);
@@ -34,6 +37,7 @@ namespace nodes {
         Property* type_property_;
 
         const ConnectionDataType& get_type(TypeConversionTargetType target, int dimensions);
+        void convert(const CompositeDataBuffer& input, DataBuffer& output, DataBuffer::size_type begin, DataBuffer::size_type end) const;
     };
 
 }}
@@ -30,6 +30,11 @@ namespace nodes
         output.set_uniform_raw(*output_, output_->data_type(), input.get_uniform_raw(*input_, input.get_uniform_type(0)));
     }
 
+    bool UniformBuffer::is_pure() const
+    {
+        return true;
+    }
+
     std::string UniformBuffer::node_name() const
     {
         return "Uniform Buffer";
@@ -55,6 +60,19 @@ namespace nodes
         return *output_;
     }
 
+    std::unique_ptr<GraphNode> UniformBuffer::clone() const
+    {
+        // Made by the graph rather than add_node, so there's no factory
+        UniformBuffer* buffer = new UniformBuffer();
+        std::unique_ptr<GraphNode> copy(buffer);
+        copy_to(*copy);
+
+        if(has_manual_output_type_)
+            buffer->set_output_type(output_->data_type());
+
+        return copy;
+    }
+
     void UniformBuffer::set_output_type(const ConnectionDataType &data_type)
     {
         has_manual_output_type_ = true;
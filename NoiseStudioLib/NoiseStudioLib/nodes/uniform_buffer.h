@@ -19,6 +19,9 @@ namespace nodes
 
         void execute_uniforms(const CompositeDataBuffer& input, DataBuffer& output) const;
 
+        /** Graph inputs are marked changed when the graph's input value is set. **/
+        bool is_pure() const;
+
         InputSocket& input();
         OutputSocket& output();
 
@@ -27,6 +30,8 @@ namespace nodes
 
         void set_output_type(const ConnectionDataType& data_type);
 
+        std::unique_ptr<GraphNode> clone() const;
+
     private:
         InputSocket* input_;
         OutputSocket* output_;
@@ -0,0 +1,45 @@
+#ifndef WHOLE_GRID_H
+#define WHOLE_GRID_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "attribute_info.h"
+
+namespace noises {
+namespace nodes
+{
+    /** The size of a 2D grid attribute, for nodes whose output pixels depend on the pixels around them (e.g. Blur) so they work on the
+     *  whole grid at once. They split it across threads rows_per_task() rows at a time, and read past the edges with clamp_index. **/
+    struct WholeGrid
+    {
+        /** Throws std::logic_error, naming {node_name}, unless {info} is a whole 2D grid rather than a chunk of one. **/
+        WholeGrid(const AttributeInfo& info, const std::string& node_name)
+        {
+            if(info.grid().rank() != 2 || !info.grid().covers(info.length()))
+                throw std::logic_error(node_name + " requires a whole 2D grid, e.g. from BlankGrid");
+
+            width = info.grid().extent(0);
+            height = info.grid().extent(1);
+        }
+
+        /** Number of rows each thread takes at a time. **/
+        static constexpr std::size_t rows_per_task() { return 16; }
+
+        bool empty() const { return width == 0 || height == 0; }
+
+        std::size_t width;
+        std::size_t height;
+    };
+
+    /** {index} clamped to [0, size), so pixels past the edge repeat the edge pixel. **/
+    template<typename Index>
+    inline std::size_t clamp_index(Index index, std::size_t size)
+    {
+        return static_cast<std::size_t>(std::min(std::max(index, static_cast<Index>(0)), static_cast<Index>(size) - 1));
+    }
+} }
+
+#endif // WHOLE_GRID_H
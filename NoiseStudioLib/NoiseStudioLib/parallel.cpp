@@ -0,0 +1,217 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace noises
+{
+    namespace
+    {
+        std::atomic<unsigned int> thread_count_override(0);
+
+        // Set on the threads running a parallel_for's ranges
+        thread_local bool in_parallel_for = false;
+
+        // Threads that take tasks off a queue. Tasks still queued when the program exits are run before the threads are joined
+        class BackgroundThreads
+        {
+        public:
+            BackgroundThreads() : stopping_(false)
+            {
+                unsigned int count = std::max(std::thread::hardware_concurrency(), 1u);
+                for(unsigned int i = 0; i < count; i++)
+                {
+                    threads_.emplace_back([this]() { run(); });
+                }
+            }
+
+            ~BackgroundThreads()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stopping_ = true;
+                }
+                task_added_.notify_all();
+
+                for(std::thread& thread : threads_)
+                {
+                    thread.join();
+                }
+            }
+
+            void add(std::function<void()> task)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    tasks_.push_back(std::move(task));
+                }
+                task_added_.notify_one();
+            }
+
+            // Queued ahead of the other tasks, for helping with work that has already started
+            void add_front(std::function<void()> task)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    tasks_.push_front(std::move(task));
+                }
+                task_added_.notify_one();
+            }
+
+        private:
+            void run()
+            {
+                while(true)
+                {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        task_added_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+                        if(tasks_.empty())
+                            return;
+
+                        task = std::move(tasks_.front());
+                        tasks_.pop_front();
+                    }
+
+                    task();
+                }
+            }
+
+            std::mutex mutex_;
+            std::condition_variable task_added_;
+            std::deque<std::function<void()>> tasks_;
+            bool stopping_;
+            std::vector<std::thread> threads_;
+        };
+
+        BackgroundThreads& background_threads()
+        {
+            static BackgroundThreads threads;
+            return threads;
+        }
+
+        // The ranges of one parallel_for. Shared with the background threads helping with it, which can start after it has finished
+        struct ParallelForJob
+        {
+            ParallelForJob(std::size_t count, std::size_t grain_size, std::size_t num_ranges,
+                           const std::function<void(std::size_t, std::size_t)>& body)
+                : count(count), grain_size(grain_size), num_ranges(num_ranges), body(body), next_range(0), finished_ranges(0), failed(false)
+            {
+            }
+
+            // Takes ranges until there are none left. Returns straight away if they've all been taken
+            void work()
+            {
+                bool was_in_parallel_for = in_parallel_for;
+                in_parallel_for = true;
+
+                for(std::size_t range = next_range++; range < num_ranges; range = next_range++)
+                {
+                    // After an error the rest of the ranges are still taken, but skipped
+                    if(!failed)
+                    {
+                        try
+                        {
+                            std::size_t begin = range * grain_size;
+                            body(begin, std::min(begin + grain_size, count));
+                        }
+                        catch(...)
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if(!error)
+                                error = std::current_exception();
+                            failed = true;
+                        }
+                    }
+
+                    if(++finished_ranges == num_ranges)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        all_finished.notify_all();
+                    }
+                }
+
+                in_parallel_for = was_in_parallel_for;
+            }
+
+            void wait()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                all_finished.wait(lock, [this]() { return finished_ranges == num_ranges; });
+            }
+
+            const std::size_t count;
+            const std::size_t grain_size;
+            const std::size_t num_ranges;
+
+            // Only called for ranges taken before the last one finishes, so it's still alive for every call
+            const std::function<void(std::size_t, std::size_t)>& body;
+
+            std::atomic<std::size_t> next_range;
+            std::atomic<std::size_t> finished_ranges;
+            std::atomic<bool> failed;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable all_finished;
+        };
+    }
+
+    unsigned int parallel_thread_count()
+    {
+        unsigned int count = thread_count_override;
+        if(count == 0)
+            count = std::thread::hardware_concurrency();
+
+        return std::max(count, 1u);
+    }
+
+    void set_parallel_thread_count(unsigned int count)
+    {
+        thread_count_override = count;
+    }
+
+    void parallel_for(std::size_t count, std::size_t grain_size, const std::function<void(std::size_t, std::size_t)>& body)
+    {
+        grain_size = std::max<std::size_t>(grain_size, 1);
+        std::size_t num_ranges = (count + grain_size - 1) / grain_size;
+        std::size_t num_threads = std::min<std::size_t>(parallel_thread_count(), num_ranges);
+
+        if(num_threads <= 1 || in_parallel_for)
+        {
+            for(std::size_t begin = 0; begin < count; begin += grain_size)
+            {
+                body(begin, std::min(begin + grain_size, count));
+            }
+            return;
+        }
+
+        // The background threads help with the ranges while the calling thread works through them too, so it never waits on a busy
+        // background thread: helpers that only get to run once every range is taken return straight away
+        std::shared_ptr<ParallelForJob> job = std::make_shared<ParallelForJob>(count, grain_size, num_ranges, body);
+
+        for(std::size_t i = 1; i < num_threads; i++)
+        {
+            background_threads().add_front([job]() { job->work(); });
+        }
+
+        job->work();
+        job->wait();
+
+        if(job->error)
+            std::rethrow_exception(job->error);
+    }
+
+    void run_in_background(std::function<void()> task)
+    {
+        background_threads().add(std::move(task));
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace noises
+{
+    /** Number of threads parallel_for uses. Defaults to std::thread::hardware_concurrency(). **/
+    unsigned int parallel_thread_count();
+
+    /** Sets the number of threads parallel_for uses. 0 restores the default, 1 runs everything on the calling thread. **/
+    void set_parallel_thread_count(unsigned int count);
+
+    /** Calls {body}(begin, end) for consecutive ranges of at most {grain_size} covering [0, count), spread over the calling thread and up
+     *  to parallel_thread_count() - 1 of the background threads, and returns once they're all done. No threads are created for it, so
+     *  several running at once, from execute_async for example, share the background threads rather than multiplying them. The ranges
+     *  are the same whatever the thread count, so anything combined per range in a fixed order gives the same result on every machine.
+     *  The first exception thrown by {body} is rethrown. Called from inside another parallel_for's {body}, it runs on the calling thread,
+     *  so nesting them doesn't multiply the threads. **/
+    void parallel_for(std::size_t count, std::size_t grain_size, const std::function<void(std::size_t, std::size_t)>& body);
+
+    /** Runs {task} on one of the library's background threads and returns straight away. There are hardware_concurrency() of them,
+     *  started the first time they're needed and kept for later tasks, which start in the order they were queued. Tasks can use
+     *  parallel_for. {task} mustn't throw; see GraphExecutor::execute_async for passing results and errors back through a future. **/
+    void run_in_background(std::function<void()> task);
+
+    /** Reduces [0, count) deterministically. {map}(begin, end) makes a partial result for each parallel_for range, then the partial results
+     *  are combined pairwise as a balanced tree, ((0 1) (2 3)) ((4 5) ...), with {combine}(left, right). The ranges and the order they're
+     *  combined in don't depend on the thread count, so floating point sums come out the same every time. Returns {identity} if count is 0. **/
+    template<typename T, typename Map, typename Combine>
+    T parallel_reduce(std::size_t count, std::size_t grain_size, const T& identity, Map map, Combine combine)
+    {
+        grain_size = std::max<std::size_t>(grain_size, 1);
+        std::size_t num_ranges = (count + grain_size - 1) / grain_size;
+
+        if(num_ranges == 0)
+            return identity;
+
+        std::vector<T> partials(num_ranges, identity);
+
+        parallel_for(count, grain_size, [&](std::size_t begin, std::size_t end)
+        {
+            partials[begin / grain_size] = map(begin, end);
+        });
+
+        for(std::size_t stride = 1; stride < num_ranges; stride *= 2)
+        {
+            for(std::size_t i = 0; i + stride < num_ranges; i += stride * 2)
+            {
+                partials[i] = combine(partials[i], partials[i + stride]);
+            }
+        }
+
+        return partials[0];
+    }
+}
+
+#endif // PARALLEL_H
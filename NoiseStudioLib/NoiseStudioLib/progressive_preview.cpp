@@ -0,0 +1,68 @@
+#include "progressive_preview.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "graph.h"
+
+namespace noises
+{
+    ProgressivePreview::ProgressivePreview(const Graph& graph, std::vector<unsigned int> strides) : graph_(graph), snapshot_(graph.snapshot()),
+        executor_(*snapshot_), strides_(std::move(strides))
+    {
+        if(strides_.empty() || std::find(strides_.begin(), strides_.end(), 0u) != strides_.end())
+            throw std::invalid_argument("A progressive preview needs at least one pass, and strides of at least 1.");
+    }
+
+    bool ProgressivePreview::render(const CancellationToken& token, const PassDone& pass_done)
+    {
+        // The executor lets go of the last snapshot before it's freed
+        std::shared_ptr<const Graph> snapshot = graph_.snapshot();
+        executor_.set_graph(*snapshot);
+        snapshot_ = std::move(snapshot);
+
+        executor_.set_cancellation_token(token);
+
+        try
+        {
+            for(unsigned int stride : strides_)
+            {
+                executor_.set_grid_stride(stride);
+                GraphOutputs outputs = executor_.execute();
+
+                // Nothing's shown once a newer render has been asked for
+                if(token.is_cancelled())
+                    break;
+
+                pass_done(stride, outputs);
+            }
+        }
+        catch(const ExecutionCancelled&)
+        {
+        }
+        catch(...)
+        {
+            reset_executor();
+            throw;
+        }
+
+        reset_executor();
+        return !token.is_cancelled();
+    }
+
+    void ProgressivePreview::reset_executor()
+    {
+        executor_.clear_cancellation_token();
+        executor_.set_grid_stride(1);
+    }
+
+    const std::vector<unsigned int>& ProgressivePreview::strides() const
+    {
+        return strides_;
+    }
+
+    GraphExecutor& ProgressivePreview::executor()
+    {
+        return executor_;
+    }
+}
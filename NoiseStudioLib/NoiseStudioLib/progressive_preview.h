@@ -0,0 +1,46 @@
+#ifndef PROGRESSIVE_PREVIEW_H
+#define PROGRESSIVE_PREVIEW_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "graph_executor.h"
+#include "cancellation_token.h"
+
+namespace noises
+{
+    class Graph;
+
+    /** Renders a graph coarse to fine for interactive editing, e.g. at 1/8, 1/4, 1/2 and then full resolution, so there's something to
+     *  show straight away while the finer passes are worked out. Each pass sets the executor's grid stride, so the graph isn't changed
+     *  and every pass covers the same area. Each render executes a fresh Graph::snapshot, so the graph can be edited while one runs.
+     *  The executor moves on to each new snapshot rather than being replaced, so constant folding carries over. **/
+    class ProgressivePreview
+    {
+    public:
+        typedef std::function<void(unsigned int stride, GraphOutputs& outputs)> PassDone;
+
+        /** {graph} has to outlive the preview. Throws NodeNotCopyable if it can't be snapshotted. **/
+        ProgressivePreview(const Graph& graph, std::vector<unsigned int> strides = { 8, 4, 2, 1 });
+
+        /** Takes a snapshot of the graph and runs a pass per stride over it, coarsest first, handing each one's outputs to {pass_done} as
+         *  soon as it's finished. Stops as soon as {token} is cancelled (e.g. by the editor when a property changes again, before it starts
+         *  the next render), part way through a pass or between them. Returns false if it was cancelled. **/
+        bool render(const CancellationToken& token, const PassDone& pass_done);
+
+        const std::vector<unsigned int>& strides() const;
+
+        GraphExecutor& executor();
+
+    private:
+        void reset_executor();
+
+        const Graph& graph_;
+        std::shared_ptr<const Graph> snapshot_;
+        GraphExecutor executor_;
+        std::vector<unsigned int> strides_;
+    };
+}
+
+#endif // PROGRESSIVE_PREVIEW_H
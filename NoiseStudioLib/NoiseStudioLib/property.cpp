@@ -1,20 +1,44 @@
 #include "property.h"
 
+#include <stdexcept>
+
 namespace noises
 {
     Property::Property(const std::string &name, const ConnectionDataType &data_type)
         : name_(name),
           type_size_(data_type.size_full()),
-          data_type_(data_type)
+          data_type_(data_type),
+          has_value_(false),
+          has_default_value_(false),
+          has_min_value_(false),
+          has_max_value_(false)
     {
         buffers_.resize(full_buffer_size());
     }
 
+    void Property::copy_values_from(const Property& other)
+    {
+        if(!(other.data_type_ == data_type_))
+            throw std::invalid_argument("Can't copy " + other.name() + " to a property of a different type.");
+
+        buffers_ = other.buffers_;
+        has_value_ = other.has_value_;
+        has_default_value_ = other.has_default_value_;
+        has_min_value_ = other.has_min_value_;
+        has_max_value_ = other.has_max_value_;
+        trigger_changed();
+    }
+
     const std::string& Property::name() const
     {
         return name_;
     }
 
+    const ConnectionDataType& Property::data_type() const
+    {
+        return data_type_;
+    }
+
     unsigned char* Property::get_buffer(int index) const
     {
         // Bleh...but whatever
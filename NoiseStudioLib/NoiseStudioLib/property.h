@@ -23,6 +23,7 @@ namespace noises
         Property(Property&&) = default;
 
         const std::string& name() const;
+        const ConnectionDataType& data_type() const;
 
         template<typename T, unsigned int Dimensions>
         const ptr_array<T, Dimensions> value_or_default() const
@@ -117,6 +118,9 @@ namespace noises
 
         void listen_changed(std::function<void()> handler);
 
+        /** Copies the value, default, min and max of a property of the same type, e.g. onto a copy of a node. **/
+        void copy_values_from(const Property& other);
+
     private:
         void trigger_changed() const;
 
@@ -6,7 +6,39 @@
 
 namespace noises
 {
-    PropertyCollection::PropertyCollection() { }
+    PropertyCollection::PropertyCollection() : self_(std::make_shared<const PropertyCollection*>(this)) { }
+
+    PropertyCollection::PropertyCollection(PropertyCollection&& other) :
+        properties_(std::move(other.properties_)),
+        listeners_(std::move(other.listeners_)),
+        self_(std::move(other.self_))
+    {
+        *self_ = this;
+        other.self_ = std::make_shared<const PropertyCollection*>(&other);
+    }
+
+    PropertyCollection& PropertyCollection::operator=(PropertyCollection&& other)
+    {
+        properties_ = std::move(other.properties_);
+        listeners_ = std::move(other.listeners_);
+        self_ = std::move(other.self_);
+        *self_ = this;
+        other.self_ = std::make_shared<const PropertyCollection*>(&other);
+        return *this;
+    }
+
+    Property& PropertyCollection::add(const std::string& name, const ConnectionDataType& data_type)
+    {
+        if(has_property(name))
+            throw std::logic_error(name + " has already been taken in the property collection.");
+        std::unique_ptr<Property> property(new Property(name, data_type));
+        Property& ref = *property;
+        properties_.push_back(std::move(property));
+        std::shared_ptr<const PropertyCollection*> self = self_;
+        ref.listen_changed([self, &ref]() { (*self)->trigger_changed(ref); });
+        trigger_changed(ref);
+        return ref;
+    }
 
     void PropertyCollection::remove(const std::string &name)
     {
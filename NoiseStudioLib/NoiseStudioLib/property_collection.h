@@ -14,22 +14,18 @@ namespace noises
         PropertyCollection();
         PropertyCollection(const PropertyCollection&) = delete;
         PropertyCollection& operator=(const PropertyCollection&) = delete;
-        PropertyCollection(PropertyCollection&&) = default;
+        PropertyCollection(PropertyCollection&& other);
+        PropertyCollection& operator=(PropertyCollection&& other);
 
         /** Adds a property to the collection. Throws an exception if the property is not part of the collection. **/
         template<typename T, unsigned int Dimensions>
         Property& add(const std::string& name)
         {
-            if(has_property(name))
-                throw std::logic_error(name + " has already been taken in the property collection.");
-            std::unique_ptr<Property> property(new Property(name, ConnectionDataType::value<T, Dimensions>()));
-            Property& ref = *property;
-            properties_.push_back(std::move(property));
-            ref.listen_changed([this, &ref]() { trigger_changed(ref); });
-            trigger_changed(ref);
-            return ref;
+            return add(name, ConnectionDataType::value<T, Dimensions>());
         }
 
+        Property& add(const std::string& name, const ConnectionDataType& data_type);
+
         /** Removes a property from the collection. Does nothing if the property is not part of the collection. **/
         void remove(const std::string& name);
 
@@ -58,6 +54,9 @@ namespace noises
 
         std::vector<std::unique_ptr<Property>> properties_;
         std::vector<std::function<void(Property&)>> listeners_;
+
+        // The collection the properties' listeners report to, updated when the properties are moved to another collection
+        std::shared_ptr<const PropertyCollection*> self_;
     };
 }
 
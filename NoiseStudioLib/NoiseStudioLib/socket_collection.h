@@ -1,6 +1,7 @@
 #ifndef SOCKET_COLLECTION_H
 #define SOCKET_COLLECTION_H
 
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <boost/optional.hpp>
@@ -125,19 +126,25 @@ namespace noises
     template<typename TSocket>
     void SocketCollection<TSocket>::remove(TSocket& socket)
     {
-        auto& sockets = socket.type() == SocketType::uniform ? uniform_sockets_ :
-                        socket.type() == SocketType::attribute ? attribute_sockets_ :
-                                                                  either_sockets_;
-
         socket.on_removing();
-        sockets.erase(sockets.begin() + socket.index());
 
-        // Update the indexes for all the sockets
-        auto it = sockets.begin();
-        int j = 0;
-        for(; it != sockets.end(); ++it, ++j)
+        // Either sockets live in the uniform or attribute list while they're connected, so find the socket by address
+        for(auto* sockets : { &uniform_sockets_, &attribute_sockets_, &either_sockets_ })
         {
-            (*it)->set_index(j);
+            auto found = std::find_if(sockets->begin(), sockets->end(), [&socket](std::unique_ptr<TSocket>& socket_ptr) { return &socket == socket_ptr.get(); });
+            if(found == sockets->end())
+                continue;
+
+            sockets->erase(found);
+
+            // Update the indexes for all the sockets
+            auto it = sockets->begin();
+            int j = 0;
+            for(; it != sockets->end(); ++it, ++j)
+            {
+                (*it)->set_index(j);
+            }
+            return;
         }
     }
 
@@ -330,9 +337,15 @@ namespace noises
 
         std::unique_ptr<TSocket> new_ptr;
         std::swap(new_ptr, *it);
-        from.erase(it);
+        it = from.erase(it);
         to.push_back(std::move(new_ptr));
         socket.set_index(to.size() - 1);
+
+        // Everything after the moved socket shifts down one
+        for(; it != from.end(); ++it)
+        {
+            (*it)->set_index((*it)->index() - 1);
+        }
     }
 }
 
@@ -1,6 +1,7 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstddef>
 #include <vector>
 #include <functional>
 #include <memory>
@@ -11,6 +12,43 @@ namespace noises
 {
     namespace utils
     {
+        /** Compile time list of indexes, for expanding into array initializers (std::index_sequence is C++14) **/
+        template<std::size_t... Indexes>
+        struct index_sequence { };
+
+        template<typename A, typename B>
+        struct concat_index_sequence;
+
+        template<std::size_t... A, std::size_t... B>
+        struct concat_index_sequence<index_sequence<A...>, index_sequence<B...>>
+        {
+            typedef index_sequence<A..., (sizeof...(A) + B)...> type;
+        };
+
+        // Halves each step so long sequences don't hit the template recursion limit
+        template<std::size_t N>
+        struct make_index_sequence_impl
+        {
+            typedef typename concat_index_sequence<typename make_index_sequence_impl<N / 2>::type,
+                                                   typename make_index_sequence_impl<N - N / 2>::type>::type type;
+        };
+
+        template<>
+        struct make_index_sequence_impl<0>
+        {
+            typedef index_sequence<> type;
+        };
+
+        template<>
+        struct make_index_sequence_impl<1>
+        {
+            typedef index_sequence<0> type;
+        };
+
+        /** index_sequence<0, 1, ..., N - 1> **/
+        template<std::size_t N>
+        using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
         template<typename T>
         void remove_by_pointer(std::vector<std::unique_ptr<T>>& list, const T* ptr)
         {